@@ -1,4 +1,6 @@
 #include "MelodyPlayer.h"
+#include "../HAL/Clock.h"
+#include "../HAL/Speaker.h"
 
 // シングルトンインスタンス
 MelodyPlayer* MelodyPlayer::instance = nullptr;
@@ -31,25 +33,25 @@ void MelodyPlayer::playMelody(const Melody& melody_pgm) {
     
     // 非ブロッキング再生開始
     melody_active = true;
-    melody_start = millis();
+    melody_start = hal::millis();
     melody_note_index = 0;
-    melody_note_start = millis();
+    melody_note_start = hal::millis();
     
     // 最初の音を再生
     if (melody_notes[0] > 0) {
-        M5.Speaker.tone(melody_notes[0], melody_duration);
+        HAL_SPEAKER.tone(melody_notes[0], melody_duration);
     }
 }
 
 void MelodyPlayer::playBeep(int duration_ms, int frequency_hz) {
     // 単音ビープ（シンプル版）
-    M5.Speaker.tone(frequency_hz, duration_ms);
+    HAL_SPEAKER.tone(frequency_hz, duration_ms);
 }
 
 void MelodyPlayer::update() {
     if (!melody_active) return;
     
-    uint32_t now = millis();
+    uint32_t now = hal::millis();
     uint32_t note_elapsed = now - melody_note_start;
     
     // 現在の音符の再生時間終了チェック
@@ -59,12 +61,12 @@ void MelodyPlayer::update() {
         if (melody_note_index >= 8 || melody_notes[melody_note_index] <= 0) {
             // メロディ終了
             melody_active = false;
-            M5.Speaker.stop();
+            HAL_SPEAKER.stop();
             return;
         }
         
         // 次の音符を再生
-        M5.Speaker.tone(melody_notes[melody_note_index], melody_duration);
+        HAL_SPEAKER.tone(melody_notes[melody_note_index], melody_duration);
         melody_note_start = now;
     }
 }
@@ -72,6 +74,6 @@ void MelodyPlayer::update() {
 void MelodyPlayer::stop() {
     if (melody_active) {
         melody_active = false;
-        M5.Speaker.stop();
+        HAL_SPEAKER.stop();
     }
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <M5Unified.h>
+#include "../HAL/Platform.h"
 
 /**
  * セオドア提言：完全非ブロッキングメロディ再生システム
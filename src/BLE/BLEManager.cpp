@@ -1,11 +1,13 @@
 #include "BLEManager.h"
 #include <M5Unified.h>
+#include "../Profiling/TraceRecorder.h"
 
 // シングルトンインスタンス
 BLEManager* BLEManager::instance = nullptr;
 
 // ServerCallbacks実装
 void BLEManager::ServerCallbacks::onConnect(BLEServer* pServer) {
+    manager->negotiatedMtu = DEFAULT_MTU;  // 交換要求が来るまでは既定値
     manager->deviceConnected = true;
     M5_LOGI("BLE Client connected");
     if (manager->onConnectionChange) {
@@ -21,6 +23,29 @@ void BLEManager::ServerCallbacks::onDisconnect(BLEServer* pServer) {
     }
 }
 
+void BLEManager::ServerCallbacks::onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+    manager->negotiatedMtu = param->mtu.mtu;
+    M5_LOGI("BLE MTU negotiated: %u", param->mtu.mtu);
+}
+
+// RX書き込み：コマンドをloop側のキューへ渡すだけ（BLEタスクでは処理しない）
+void BLEManager::RxCallbacks::onWrite(BLECharacteristic* characteristic) {
+    const uint8_t* data = characteristic->getData();
+    size_t length = characteristic->getLength();
+    if (!data || length < 2) return;  // opcode + seq は必須
+
+    Command command;
+    command.opcode = data[0];
+    command.seq = data[1];
+    size_t payload_length = length - 2;
+    command.length = (uint8_t)(payload_length < MAX_COMMAND_PAYLOAD ? payload_length : MAX_COMMAND_PAYLOAD);
+    memcpy(command.payload, data + 2, command.length);
+
+    if (!manager->commandQueue.push(command)) {
+        manager->droppedCommands = manager->droppedCommands + 1;
+    }
+}
+
 BLEManager::BLEManager() {
     // コンストラクタ
 }
@@ -36,6 +61,14 @@ bool BLEManager::begin(const char* deviceName) {
     // BLEデバイス初期化
     BLEDevice::init(deviceName);
     
+    // 受け入れ可能なMTUを拡大（実際の値はクライアントの交換要求で決まる）
+    if (BLEDevice::setMTU(PREFERRED_MTU) != ESP_OK) {
+        M5_LOGW("Failed to set preferred BLE MTU");
+    }
+    
+    // 輻輳通知の受信（送信ペース制御用）
+    BLEDevice::setCustomGattsHandler(gattsEventHandler);
+    
     // サーバー作成
     server = BLEDevice::createServer();
     if (!server) {
@@ -66,6 +99,18 @@ bool BLEManager::begin(const char* deviceName) {
     
     // 通知用ディスクリプタ追加
     txCharacteristic->addDescriptor(new BLE2902());
+    transport.attach(txCharacteristic, &congested);
+    
+    // RX Characteristic作成（コマンド受信）
+    rxCharacteristic = service->createCharacteristic(
+        CHARACTERISTIC_UUID_RX,
+        BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_WRITE_NR
+    );
+    if (!rxCharacteristic) {
+        M5_LOGE("Failed to create RX characteristic");
+        return false;
+    }
+    rxCharacteristic->setCallbacks(new RxCallbacks(this));
     
     // サービス開始
     service->start();
@@ -82,49 +127,320 @@ bool BLEManager::begin(const char* deviceName) {
     return true;
 }
 
-void BLEManager::update() {
-    uint32_t now = millis();
-    
+void BLEManager::poll() {
     // 再接続処理
     handleConnectionChange();
     
+    // 受信コマンド処理（loopスレッドで実行）
+    processCommands();
+    
+    // 送信待ち通知の送出
+    transmitQueue();
+}
+
+void BLEManager::update() {
+    uint32_t now = millis();
+    
     // データ送信処理
-    if (deviceConnected && txCharacteristic) {
-        // 送信間隔チェック
-        if (now - lastDataSend >= DATA_SEND_INTERVAL) {
-            // フルデータかライトデータか判定
-            bool sendFullData = (now - lastFullDataSend >= FULL_DATA_INTERVAL);
-            
-            if (onDataRequest) {
-                // コールバックでJSONデータを構築
-                JsonDocument doc;
-                onDataRequest(doc, sendFullData);
-                
-                // JSON送信
-                if (sendJson(doc)) {
-                    lastDataSend = now;
-                    if (sendFullData) {
-                        lastFullDataSend = now;
-                    }
-                }
-            }
+    if (!deviceConnected || !txCharacteristic) {
+        return;
+    }
+    
+    // 保留中のバッチが古くなったら送出
+    if (batchLength > 0 && now - batchStarted >= MAX_BATCH_DELAY_MS) {
+        flushBatch();
+    }
+    
+    // 判定は最短間隔ごと（現在値の取得もこの頻度に抑える）
+    if (now - lastRateCheck < fastInterval) {
+        return;
+    }
+    lastRateCheck = now;
+    
+    TelemetryProtocol::Snapshot snapshot = {};
+    const TelemetryProtocol::Snapshot* current = nullptr;
+    if (onTelemetryRequest) {
+        onTelemetryRequest(snapshot);
+        current = &snapshot;
+    }
+    
+    // フルデータは固定間隔、ライトデータはスケジューラ判定
+    bool sendFullData = (now - lastFullDataSend >= FULL_DATA_INTERVAL);
+    if (!sendFullData && !shouldSendLite(now, current)) {
+        return;
+    }
+    
+    if (sendTelemetry(sendFullData, current)) {
+        lastDataSend = now;
+        if (sendFullData) {
+            lastFullDataSend = now;
+        }
+        if (current) {
+            hasLastSent = true;
+            lastSentTemp = current->temp;
+            lastSentRor = current->ror;
+            lastSentStage = current->stage;
+            lastSentFlags = current->flags;
         }
     }
 }
 
-bool BLEManager::sendData(const char* data) {
+bool BLEManager::shouldSendLite(uint32_t now, const TelemetryProtocol::Snapshot* snapshot) {
+    uint32_t elapsed = now - lastDataSend;
+    
+    // 現在値が判定できない場合は従来どおり固定間隔
+    if (!snapshot) {
+        return elapsed >= normalInterval;
+    }
+    if (!hasLastSent || elapsed >= keepAliveInterval) {
+        return true;
+    }
+    
+    // ステージ・状態フラグの変化、またはRoRの急変で高速レートへ
+    bool stateChanged = snapshot->stage != lastSentStage || snapshot->flags != lastSentFlags;
+    float rorDelta = isnan(snapshot->ror) || isnan(lastSentRor) ? 0.0f : fabsf(snapshot->ror - lastSentRor);
+    if (stateChanged || rorDelta >= FAST_ROR_DELTA) {
+        fastUntil = now + FAST_HOLD_MS;
+    }
+    fastRate = fastRateHint || (int32_t)(fastUntil - now) > 0;
+    
+    // 状態変化は即時（最短間隔のみ守る）
+    if (stateChanged) {
+        return true;
+    }
+    if (elapsed < (fastRate ? fastInterval : normalInterval)) {
+        return false;
+    }
+    
+    // 不感帯：温度・RoRとも変化が小さければ送らない
+    float tempDelta = isnan(snapshot->temp) || isnan(lastSentTemp) ? 0.0f : fabsf(snapshot->temp - lastSentTemp);
+    if (tempDelta < tempDeadband && rorDelta < rorDeadband) {
+        suppressedFrames++;
+        return false;
+    }
+    return true;
+}
+
+bool BLEManager::sendTelemetry(bool fullData, const TelemetryProtocol::Snapshot* snapshot) {
+    size_t recordLength = 0;
+    if (fullData) {
+        TRACE_MARK(MARK_BLE_FULL, protocol);
+    }
+    
+    if (protocol == TelemetryProtocol::PROTOCOL_BINARY && snapshot) {
+        // バイナリ：バッチバッファへ直接エンコード
+        NotificationQueue::Kind kind = fullData ? NotificationQueue::KIND_FULL : NotificationQueue::KIND_LITE;
+        uint8_t* out = reserveFrame(kind);
+        recordLength = fullData
+            ? TelemetryProtocol::encodeStatus(*snapshot, frameSeq, out)
+            : TelemetryProtocol::encodeLive(*snapshot, frameSeq, out);
+        frameSeq++;
+        batchLength += recordLength;
+
+        // 投入後はフェーズ集計を状態フレームの直後に
+        if (fullData && snapshot->phase != PhaseMetrics::NO_PHASE) {
+            batchLength += TelemetryProtocol::encodePhase(*snapshot, frameSeq++, reserveFrame(kind));
+        }
+    } else if (onDataRequest) {
+        // コールバックでJSONデータを構築
+        JsonDocument doc;
+        onDataRequest(doc, fullData);
+        if (fullData) {
+            doc["proto"] = TelemetryProtocol::VERSION;  // バイナリ対応の告知
+            doc["mtu"] = negotiatedMtu;
+            doc["suppressed"] = suppressedFrames;
+            JsonObject txq = doc["txq"].to<JsonObject>();
+            txq["queued"] = txQueue.getQueuedCount();
+            txq["sent"] = txQueue.getSentCount();
+            txq["dropped"] = txQueue.getDroppedCount();
+            txq["coalesced"] = txQueue.getCoalescedCount();
+            txq["congested"] = congestionCount;
+        }
+        recordLength = appendJson(doc);
+        if (recordLength == 0) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    if (batchCount++ == 0) {
+        batchStarted = millis();
+    }
+    if (fullData) {
+        batchKind = NotificationQueue::KIND_FULL;  // フルデータを含むバッチは捨てない
+    }
+    
+    // 同じ大きさの次のサンプルが1通知に収まらない、上限数に達した、
+    // フルデータ、または高速レート中（遅延を優先）の場合はまとめて送信
+    bool nextFits = batchLength + recordLength <= getMaxPayload();
+    if (fullData || fastRate || !nextFits || batchCount >= MAX_BATCH_SAMPLES) {
+        return flushBatch();
+    }
+    return true;
+}
+
+uint8_t* BLEManager::reserveFrame(NotificationQueue::Kind kind) {
+    // 1通知に収まらなければ保留分を先に送信（キューはmax_payloadで機械的に切るため、
+    // フレームが通知をまたぐとCRC単位で受信できなくなる）
+    size_t limit = getMaxPayload();
+    if (limit > BATCH_BUFFER_SIZE) limit = BATCH_BUFFER_SIZE;
+    if (batchLength + TelemetryProtocol::FRAME_SIZE > limit) {
+        flushBatch();
+    }
+    // 種別は書き込む前に決める：状態フレームの直後のフェーズフレームで途中送信されても
+    // 状態フレームがライト扱い（上書き・破棄の対象）にならないように
+    if (kind == NotificationQueue::KIND_FULL) {
+        batchKind = NotificationQueue::KIND_FULL;
+    }
+    return batchBuffer + batchLength;
+}
+
+size_t BLEManager::appendJson(const JsonDocument& doc) {
+    // 改行を含めて収まらなければ保留分を先に送信
+    size_t length = measureJson(doc);
+    if (length + 1 > BATCH_BUFFER_SIZE) {
+        M5_LOGE("BLE JSON payload too large");
+        return 0;
+    }
+    if (batchLength + length + 1 > BATCH_BUFFER_SIZE) {
+        flushBatch();
+    }
+    
+    // 静的バッファへ直接シリアライズ（String経由の確保を避ける）
+    char* out = (char*)batchBuffer + batchLength;
+    length = serializeJson(doc, out, BATCH_BUFFER_SIZE - batchLength);
+    out[length] = '\n';  // 改行でメッセージ境界を示す（チャンク再構成用）
+    batchLength += length + 1;
+    return length + 1;
+}
+
+bool BLEManager::flushBatch() {
+    if (batchLength == 0) return true;
+    TRACE_MARK(MARK_BLE_FLUSH, batchLength);
+    bool queued = enqueue(batchBuffer, batchLength, batchKind);
+    batchLength = 0;
+    batchCount = 0;
+    batchKind = NotificationQueue::KIND_LITE;
+    return queued;
+}
+
+bool BLEManager::enqueue(const uint8_t* data, size_t length, NotificationQueue::Kind kind) {
     if (!deviceConnected || !txCharacteristic) {
         return false;
     }
     
-    try {
-        txCharacteristic->setValue((uint8_t*)data, strlen(data));
-        txCharacteristic->notify();
-        return true;
-    } catch (...) {
-        M5_LOGE("Failed to send BLE data");
+    // MTUを超える分はキュー側で複数通知に分割（JSONのみ。バイナリはreserveFrame()で1通知以内に収める）
+    size_t maxPayload = getMaxPayload();
+    if (length > maxPayload) {
+        chunkedMessageCount++;
+    }
+    return txQueue.push(data, length, maxPayload, kind);
+}
+
+void BLEManager::transmitQueue() {
+    if (!deviceConnected || !txCharacteristic) {
+        return;
+    }
+    
+    // 輻輳中はスタックのバッファが空くまで待つ（notifyは失敗しても通知されないため）
+    txQueue.drainTo(transport, MAX_NOTIFY_PER_POLL);
+}
+
+void BLEManager::gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param) {
+    // BLEタスクで実行：フラグを更新するだけ
+    if (event == ESP_GATTS_CONGEST_EVT && instance) {
+        instance->congested = param->congest.congested;
+        if (param->congest.congested) {
+            instance->congestionCount = instance->congestionCount + 1;
+        }
+    }
+}
+
+void BLEManager::processCommands() {
+    Command command;
+    while (commandQueue.pop(command)) {
+        // ACKが届かず再送された同一コマンドは再実行せず、前回の結果を返す
+        if (hasLastCommand && command.opcode == lastCommandOpcode && command.seq == lastCommandSeq) {
+            sendAck(command, lastAckStatus);
+            continue;
+        }
+        
+        uint8_t status = executeCommand(command);
+        hasLastCommand = true;
+        lastCommandOpcode = command.opcode;
+        lastCommandSeq = command.seq;
+        lastAckStatus = status;
+        sendAck(command, status);
+    }
+}
+
+uint8_t BLEManager::executeCommand(const Command& command) {
+    if (command.opcode == CMD_SET_PROTOCOL) {
+        if (command.length < 1 || command.payload[0] > TelemetryProtocol::PROTOCOL_BINARY) {
+            return TelemetryProtocol::ACK_BAD_PAYLOAD;
+        }
+        flushBatch();  // 形式の混在を避ける
+        protocol = (TelemetryProtocol::Protocol)command.payload[0];
+        frameSeq = 0;
+        M5_LOGI("BLE protocol set to %s", protocol == TelemetryProtocol::PROTOCOL_BINARY ? "binary" : "json");
+        return TelemetryProtocol::ACK_OK;
+    }
+    
+    if (!onCommand) {
+        return TelemetryProtocol::ACK_UNKNOWN_OPCODE;
+    }
+    return onCommand(command);
+}
+
+bool BLEManager::sendAck(const Command& command, uint8_t status) {
+    if (!deviceConnected || !txCharacteristic) {
+        return false;
+    }
+    
+    // 実行後の状態を添えてイベントとして積む（保留中のバッチより後に届く）
+    TelemetryProtocol::Snapshot snapshot = {};
+    if (onTelemetryRequest) {
+        onTelemetryRequest(snapshot);
+    }
+    
+    if (protocol == TelemetryProtocol::PROTOCOL_BINARY) {
+        flushBatch();
+        uint8_t frame[TelemetryProtocol::FRAME_SIZE];
+        size_t length = TelemetryProtocol::encodeAck(command.opcode, command.seq, status, snapshot, frameSeq, frame);
+        frameSeq++;
+        return sendData(frame, length, NotificationQueue::KIND_EVENT);
+    }
+    
+    JsonDocument doc;
+    doc["type"] = "ack";
+    doc["op"] = command.opcode;
+    doc["seq"] = command.seq;
+    doc["status"] = status;
+    doc["running"] = (snapshot.flags & TelemetryProtocol::FLAG_RUNNING) != 0;
+    doc["stage"] = snapshot.stage;
+    doc["level"] = snapshot.level;
+    return sendJson(doc);
+}
+
+bool BLEManager::sendData(const char* data) {
+    if (!deviceConnected || !txCharacteristic) {
         return false;
     }
+    
+    return enqueue((const uint8_t*)data, strlen(data), NotificationQueue::KIND_EVENT);
+}
+
+size_t BLEManager::getMaxPayload() const {
+    if (!deviceConnected) return TelemetryProtocol::FRAME_SIZE;
+    uint16_t mtu = negotiatedMtu;
+    size_t payload = mtu > 3 ? mtu - 3 : 0;
+    if (payload < TelemetryProtocol::FRAME_SIZE) payload = TelemetryProtocol::FRAME_SIZE;
+    if (payload > TelemetryProtocol::MAX_FRAME_SIZE) payload = TelemetryProtocol::MAX_FRAME_SIZE;
+    return payload;
+}
+
+bool BLEManager::sendData(const uint8_t* data, size_t length, NotificationQueue::Kind kind) {
+    return enqueue(data, length, kind);
 }
 
 bool BLEManager::sendJson(const JsonDocument& doc) {
@@ -132,12 +448,12 @@ bool BLEManager::sendJson(const JsonDocument& doc) {
         return false;
     }
     
-    // JSONをシリアライズ
-    String output;
-    serializeJson(doc, output);
-    
-    // 送信
-    return sendData(output.c_str());
+    // 保留中のサンプルとまとめてイベントとして積む
+    if (appendJson(doc) == 0) {
+        return false;
+    }
+    batchKind = NotificationQueue::KIND_EVENT;
+    return flushBatch();
 }
 
 void BLEManager::handleConnectionChange() {
@@ -149,6 +465,17 @@ void BLEManager::handleConnectionChange() {
         restartTimer = now;
         restartPending = true;
         oldDeviceConnected = deviceConnected;
+        // 次の接続はJSONから開始（従来クライアント互換）
+        protocol = TelemetryProtocol::PROTOCOL_JSON;
+        commandQueue.drain();
+        batchLength = 0;
+        batchCount = 0;
+        batchKind = NotificationQueue::KIND_LITE;
+        txQueue.clear();
+        congested = false;
+        negotiatedMtu = DEFAULT_MTU;
+        hasLastSent = false;
+        hasLastCommand = false;
     }
     
     // 再接続処理
@@ -6,6 +6,10 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 #include <ArduinoJson.h>
+#include "TelemetryProtocol.h"
+#include "NotificationQueue.h"
+#include "../HAL/BleTransport.h"
+#include "../Sensor/SampleQueue.h"
 
 /**
  * Bluetooth Low Energy 通信管理クラス
@@ -13,14 +17,49 @@
  * 機能：
  * - Nordic UART Service実装
  * - JSON形式でのデータ送信
+ * - バイナリテレメトリ（TelemetryProtocol）送信：静的バッファ、ヒープ確保なし
+ * - RXキャラクタリスティックによるコマンド受信（送信プロトコル切り替え、遠隔操作）
+ * - コマンドごとのACK（seqで対応付け、再送された同一コマンドは再実行せずACKのみ）
+ * - MTUネゴシエーション（最大247）と結果の報告
+ * - MTUに余裕があれば複数サンプルを1通知にまとめて送信（無線の稼働率を低減）
+ * - MTUを超えるJSONは改行終端のチャンクに分割（切り捨てなし）
+ * - 送信待ちキュー：スタックの輻輳通知に合わせて送出、ライトデータのみコアレス・破棄
  * - 自動再接続
  * - 差分データ送信による帯域最適化
+ * - 適応送信レート：温度・RoRの不感帯、変化時の高速レート（最大5Hz）、キープアライブ
  */
 class BLEManager {
 public:
     // コールバック関数型定義
     typedef void (*ConnectionCallback)(bool connected);
     typedef void (*DataRequestCallback)(JsonDocument& doc, bool fullData);
+    typedef void (*TelemetryRequestCallback)(TelemetryProtocol::Snapshot& snapshot);
+
+    // RXで受信したコマンド：[opcode][seq][payload...]
+    static constexpr size_t MAX_COMMAND_PAYLOAD = 16;
+    struct Command {
+        uint8_t opcode;
+        uint8_t seq;
+        uint8_t length;     // payloadの有効長
+        uint8_t payload[MAX_COMMAND_PAYLOAD];
+    };
+    // 戻り値はTelemetryProtocol::AckStatus（ACKでクライアントへ返す）
+    typedef uint8_t (*CommandCallback)(const Command& command);
+
+    // コマンド一覧（CMD_SET_PROTOCOL以外はCommandCallbackでアプリ側が処理）
+    enum Opcode : uint8_t {
+        CMD_SET_PROTOCOL = 0x01,    // payload[0]: TelemetryProtocol::Protocol
+        CMD_BACKFILL = 0x02,        // payload[0..3]: 開始サンプル番号（LE）、バイナリ時のみ
+        CMD_START = 0x10,           // 測定開始
+        CMD_STOP = 0x11,            // 測定停止（ガイドも停止）
+        CMD_SET_LEVEL = 0x12,       // payload[0]: RoastGuide::RoastLevel（ガイド停止中のみ）
+        CMD_START_GUIDE = 0x13,     // 焙煎ガイド開始（payload[0]: レベル、省略時は選択中）
+        CMD_CONFIRM_FIRST_CRACK = 0x14,
+        CMD_CLEAR_DATA = 0x15,      // 履歴・統計・ガイドをクリア
+        CMD_SET_DISPLAY_MODE = 0x16,// payload[0]: 表示モード（0xFF = 次へ）
+        CMD_PROFILER = 0x17,        // payload[0]: 0 = 結果送信, 1 = 有効, 2 = 無効, 3 = リセット
+        CMD_REPLAY = 0x18           // payload[0]: 倍率（0 = 最速）、payload[1..4]: 焙煎ID（LE、省略時は最新）
+    };
 
     // Nordic UART Service UUIDs
     static constexpr const char* SERVICE_UUID = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
@@ -31,6 +70,7 @@ private:
     // BLEオブジェクト
     BLEServer* server = nullptr;
     BLECharacteristic* txCharacteristic = nullptr;
+    BLECharacteristic* rxCharacteristic = nullptr;
     
     // 接続状態
     bool deviceConnected = false;
@@ -39,17 +79,77 @@ private:
     // 送信タイミング管理
     uint32_t lastDataSend = 0;
     uint32_t lastFullDataSend = 0;
-    static constexpr uint32_t DATA_SEND_INTERVAL = 1000;  // 1秒
+    uint32_t lastRateCheck = 0;
     static constexpr uint32_t FULL_DATA_INTERVAL = 15000; // 15秒
     
+    // 適応送信レート
+    float tempDeadband = 0.2f;          // °C：これ未満の変化は送らない
+    float rorDeadband = 0.5f;           // °C/min
+    uint32_t fastInterval = 200;        // 変化中の最短間隔（5Hz）
+    uint32_t normalInterval = 1000;     // 通常の最短間隔
+    uint32_t keepAliveInterval = 5000;  // 変化がなくても必ず送る間隔
+    static constexpr float FAST_ROR_DELTA = 2.0f;      // °C/min：この変化で高速レートへ
+    static constexpr uint32_t FAST_HOLD_MS = 10000;    // 高速レートの持続時間
+    bool fastRateHint = false;          // アプリ側からの要求（1ハゼ付近など）
+    uint32_t fastUntil = 0;
+    bool fastRate = false;
+    uint32_t suppressedFrames = 0;
+    
+    // 最後に送った値（不感帯の基準）
+    bool hasLastSent = false;
+    float lastSentTemp = 0.0f;
+    float lastSentRor = 0.0f;
+    uint8_t lastSentStage = 0;
+    uint8_t lastSentFlags = 0;
+    
     // 再接続管理
     bool restartPending = false;
     uint32_t restartTimer = 0;
     static constexpr uint32_t RESTART_DELAY = 300;
     
+    // 送信プロトコル（接続ごとにJSONから開始）
+    TelemetryProtocol::Protocol protocol = TelemetryProtocol::PROTOCOL_JSON;
+    uint8_t frameSeq = 0;
+
+    // MTU（クライアントからの交換要求で決まる）
+    static constexpr uint16_t DEFAULT_MTU = 23;
+    static constexpr uint16_t PREFERRED_MTU = 247;
+    volatile uint16_t negotiatedMtu = DEFAULT_MTU;
+
+    // 送信バッチ：JSON（改行終端）またはバイナリフレームを連結して保持
+    static constexpr size_t BATCH_BUFFER_SIZE = 512;
+    static constexpr uint8_t MAX_BATCH_SAMPLES = 4;       // まとめる最大サンプル数
+    static constexpr uint32_t MAX_BATCH_DELAY_MS = 4000;  // 保留の最大遅延
+    uint8_t batchBuffer[BATCH_BUFFER_SIZE];
+    size_t batchLength = 0;
+    uint8_t batchCount = 0;
+    uint32_t batchStarted = 0;
+    NotificationQueue::Kind batchKind = NotificationQueue::KIND_LITE;
+    uint32_t chunkedMessageCount = 0;
+    
+    // 送信待ちキュー（loopで送出、輻輳中は保留）
+    NotificationQueue txQueue;
+    volatile bool congested = false;        // BLEタスクが更新
+    hal::BleTransport transport;            // txQueueの送信先
+    volatile uint32_t congestionCount = 0;
+    static constexpr uint8_t MAX_NOTIFY_PER_POLL = 4;  // 1回のpoll()で送る最大通知数
+
+    // コマンド受信（BLEタスク → loop）
+    static constexpr uint32_t COMMAND_QUEUE_SIZE = 8;
+    SampleQueue<Command, COMMAND_QUEUE_SIZE> commandQueue;
+    volatile uint32_t droppedCommands = 0;
+    
+    // 直前に実行したコマンド（ACK喪失による再送の検出）
+    bool hasLastCommand = false;
+    uint8_t lastCommandOpcode = 0;
+    uint8_t lastCommandSeq = 0;
+    uint8_t lastAckStatus = 0;
+    
     // コールバック
     ConnectionCallback onConnectionChange = nullptr;
     DataRequestCallback onDataRequest = nullptr;
+    TelemetryRequestCallback onTelemetryRequest = nullptr;
+    CommandCallback onCommand = nullptr;
     
     // シングルトン
     static BLEManager* instance;
@@ -61,8 +161,31 @@ private:
         ServerCallbacks(BLEManager* mgr) : manager(mgr) {}
         void onConnect(BLEServer* pServer);
         void onDisconnect(BLEServer* pServer);
+        void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param);
+    };
+
+    // RXキャラクタリスティックのコールバッククラス（BLEタスクで実行：キューに積むだけ）
+    class RxCallbacks : public BLECharacteristicCallbacks {
+        BLEManager* manager;
+    public:
+        RxCallbacks(BLEManager* mgr) : manager(mgr) {}
+        void onWrite(BLECharacteristic* characteristic);
     };
 
+    void processCommands();
+    uint8_t executeCommand(const Command& command);
+    bool sendAck(const Command& command, uint8_t status);
+    bool shouldSendLite(uint32_t now, const TelemetryProtocol::Snapshot* snapshot);
+    bool sendTelemetry(bool fullData, const TelemetryProtocol::Snapshot* snapshot);
+    size_t appendJson(const JsonDocument& doc);   // 追記したバイト数（失敗時0）
+    uint8_t* reserveFrame(NotificationQueue::Kind kind);    // バイナリ1フレーム分の書き込み位置（通知をまたがない）
+    bool flushBatch();
+    bool enqueue(const uint8_t* data, size_t length, NotificationQueue::Kind kind);
+    void transmitQueue();
+    
+    // GATTSイベント（輻輳通知）
+    static void gattsEventHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
+
 public:
     BLEManager();
     ~BLEManager();
@@ -73,15 +196,45 @@ public:
     // コールバック設定
     void setConnectionCallback(ConnectionCallback cb) { onConnectionChange = cb; }
     void setDataRequestCallback(DataRequestCallback cb) { onDataRequest = cb; }
+    void setTelemetryRequestCallback(TelemetryRequestCallback cb) { onTelemetryRequest = cb; }
+    void setCommandCallback(CommandCallback cb) { onCommand = cb; }
     
     // 接続状態
     bool isConnected() const { return deviceConnected; }
+    TelemetryProtocol::Protocol getProtocol() const { return protocol; }
+    uint32_t getDroppedCommandCount() const { return droppedCommands; }
+    // 1通知で送れる最大バイト数（ネゴシエート済みMTU - 3）
+    size_t getMaxPayload() const;
+    uint16_t getMtu() const { return negotiatedMtu; }
+    uint32_t getChunkedMessageCount() const { return chunkedMessageCount; }
+    
+    // 送信待ちキューの状態
+    const NotificationQueue& getQueue() const { return txQueue; }
+    bool isCongested() const { return congested; }
+    uint32_t getCongestionCount() const { return congestionCount; }
+    bool canQueueBulk() const { return deviceConnected && txQueue.canPushBulk(); }
+    
+    // 適応送信レートの設定
+    void setDeadband(float temp, float ror) { tempDeadband = temp; rorDeadband = ror; }
+    void setSendIntervals(uint32_t fast_ms, uint32_t normal_ms, uint32_t keepalive_ms) {
+        fastInterval = fast_ms;
+        normalInterval = normal_ms;
+        keepAliveInterval = keepalive_ms;
+    }
+    void setFastRateHint(bool fast) { fastRateHint = fast; }
+    bool isFastRate() const { return fastRate; }
+    uint32_t getSuppressedCount() const { return suppressedFrames; }
+    
+    // 接続管理・コマンド処理・キュー送出（待機中も含めloop()から毎回呼ぶ）
+    void poll();
     
-    // データ送信（定期的に呼ぶ）
+    // データ送信（測定中のloop()から毎回呼ぶ：送るかどうかはスケジューラが判定）
     void update();
     
-    // 手動データ送信
+    // 手動データ送信（キューに積む。MTUを超える分はチャンク分割）
     bool sendData(const char* data);
+    bool sendData(const uint8_t* data, size_t length,
+                  NotificationQueue::Kind kind = NotificationQueue::KIND_EVENT);
     bool sendJson(const JsonDocument& doc);
     
     // 接続管理
@@ -0,0 +1,89 @@
+#include "HistoryBackfill.h"
+#include "BLEManager.h"
+#include "../History/TemperatureHistory.h"
+#include <M5Unified.h>
+
+// シングルトンインスタンス
+HistoryBackfill* HistoryBackfill::instance = nullptr;
+
+HistoryBackfill::HistoryBackfill() {
+    // コンストラクタ
+}
+
+HistoryBackfill::~HistoryBackfill() {
+    // デストラクタ
+}
+
+void HistoryBackfill::start(uint32_t from_index) {
+    // 保持していない古い範囲は最古の点から
+    uint32_t oldest = HISTORY->getOldestIndex();
+    cursor = from_index > oldest ? from_index : oldest;
+    end_index = HISTORY->getTotalSamples();
+    seq = 0;
+    chunks_sent = 0;
+    active = true;
+    M5_LOGI("BLE backfill %u..%u", cursor, end_index);
+}
+
+size_t HistoryBackfill::buildChunk(size_t capacity) {
+    TelemetryProtocol::BackfillHeader header;
+    header.header = { TelemetryProtocol::VERSION, TelemetryProtocol::FRAME_BACKFILL, 0, seq };
+    header.first_index = cursor;
+    header.span = 0;
+    header.count = 0;
+    header.first_value = 0;
+
+    constexpr size_t CRC_SIZE = 2;
+    size_t len = sizeof(header);
+    int16_t prev = 0;
+    uint32_t next_cursor = cursor;
+
+    // 同じ解像度の点をcapacityに収まるだけ詰める
+    HISTORY->forEach(cursor, end_index, [&](const TemperatureHistory::Point& p) {
+        if (header.count == 0) {
+            header.first_index = p.index;
+            header.span = (uint8_t)p.span;
+            header.first_value = p.mean;
+        } else {
+            if (p.span != header.span || header.count == UINT8_MAX) return false;
+            size_t n = TelemetryProtocol::putVarint((int32_t)p.mean - prev, buffer + len, capacity - CRC_SIZE - len);
+            if (n == 0) return false;
+            len += n;
+        }
+        prev = p.mean;
+        header.count++;
+        next_cursor = p.index + p.span;
+        return true;
+    });
+
+    memcpy(buffer, &header, sizeof(header));
+    cursor = next_cursor;
+    return TelemetryProtocol::appendCrc(buffer, len);
+}
+
+void HistoryBackfill::service() {
+    if (!active) return;
+    if (!BLE_MGR->isConnected()) {
+        active = false;  // 切断：再接続後にクライアントが再要求する
+        return;
+    }
+    if (BLE_MGR->getProtocol() != TelemetryProtocol::PROTOCOL_BINARY) {
+        active = false;  // JSONへ戻された：チャンクを改行区切りのストリームに混ぜない
+        return;
+    }
+
+    // 送信キューに空きがある時だけ作る（輻輳中はキューが進まないため自然に待つ）
+    if (!BLE_MGR->canQueueBulk()) return;
+
+    // count = 0 のチャンクは終端を示す
+    bool finished = cursor >= end_index;
+    size_t length = buildChunk(BLE_MGR->getMaxPayload());
+    if (BLE_MGR->sendData(buffer, length, NotificationQueue::KIND_BULK)) {
+        seq++;
+        chunks_sent++;
+    }
+    if (finished) {
+        active = false;
+        M5_LOGI("BLE backfill done: %u chunks", chunks_sent);
+    }
+}
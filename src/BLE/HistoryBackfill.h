@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include "TelemetryProtocol.h"
+
+/**
+ * BLE履歴バックフィル
+ *
+ * 機能：
+ * - 「サンプル番号N以降を送れ」要求（RX CMD_BACKFILL）に応答（バイナリプロトコル時のみ）
+ * - TemperatureHistoryの内容をMTUサイズのチャンクへ差分符号化
+ * - 解像度（span）が変わる境界でチャンクを分割
+ * - 送信キューに予約枠を残して空きがある時だけ1チャンクずつ積む（ライブ通知・ACKを妨げない）
+ * - 要求時点までを送り終えたら count = 0 の終端チャンク
+ *
+ * 要求以降の新しいサンプルはライブフレームで届くため、
+ * 途中接続・再接続したクライアントも全曲線を再構築できる
+ */
+class HistoryBackfill {
+private:
+    bool active = false;
+    uint32_t cursor = 0;        // 次に送るサンプル番号
+    uint32_t end_index = 0;     // 要求時点の総サンプル数（ここまで送る）
+    uint8_t seq = 0;
+    uint32_t chunks_sent = 0;
+    uint8_t buffer[TelemetryProtocol::MAX_FRAME_SIZE];
+
+    // シングルトン
+    static HistoryBackfill* instance;
+
+    size_t buildChunk(size_t capacity);
+
+public:
+    HistoryBackfill();
+    ~HistoryBackfill();
+
+    // 要求開始・中止
+    void start(uint32_t from_index);
+    void cancel() { active = false; }
+    bool isActive() const { return active; }
+    uint32_t getChunksSent() const { return chunks_sent; }
+
+    // loop()から毎回呼ぶ：キューに空きがあれば1チャンク積む
+    void service();
+
+    // シングルトンインスタンス取得
+    static HistoryBackfill* getInstance() {
+        if (!instance) {
+            instance = new HistoryBackfill();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define BACKFILL HistoryBackfill::getInstance()
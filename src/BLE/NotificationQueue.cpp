@@ -0,0 +1,85 @@
+#include "NotificationQueue.h"
+
+bool NotificationQueue::push(const uint8_t* data, size_t length, size_t max_payload, Kind kind) {
+    if (length == 0 || max_payload == 0) return false;
+    if (max_payload > TelemetryProtocol::MAX_FRAME_SIZE) max_payload = TelemetryProtocol::MAX_FRAME_SIZE;
+    size_t chunks = (length + max_payload - 1) / max_payload;
+    bool coalescible = (kind == KIND_LITE && chunks == 1);
+
+    // 未送信のライトデータがあれば最新値で置き換える
+    if (coalescible) {
+        for (size_t i = 0; i < count; i++) {
+            Frame& frame = at(i);
+            if (frame.coalescible) {
+                memcpy(frame.data, data, length);
+                frame.length = (uint8_t)length;
+                coalesced++;
+                return true;
+            }
+        }
+    }
+
+    if (kind == KIND_BULK) {
+        if (!canPushBulk(chunks)) return false;  // 呼び出し側が後で再試行
+    } else if (kind != KIND_LITE) {
+        while (available() < chunks && evictLite()) {}
+    }
+    if (chunks > available()) {
+        dropped++;
+        if (kind != KIND_LITE) {
+            M5_LOGW("BLE queue full, %s frame dropped", kind == KIND_FULL ? "full" : "event");
+        }
+        return false;
+    }
+
+    for (size_t offset = 0; offset < length; offset += max_payload) {
+        size_t n = length - offset < max_payload ? length - offset : max_payload;
+        Frame& frame = at(count);
+        memcpy(frame.data, data + offset, n);
+        frame.length = (uint8_t)n;
+        frame.kind = kind;
+        frame.coalescible = coalescible;
+        count++;
+        queued++;
+    }
+    return true;
+}
+
+bool NotificationQueue::evictLite() {
+    for (size_t i = 0; i < count; i++) {
+        if (!at(i).coalescible) continue;
+        // 後続を1つずつ詰める（容量が小さいため単純なコピーで十分）
+        for (size_t j = i; j + 1 < count; j++) {
+            at(j) = at(j + 1);
+        }
+        count--;
+        dropped++;
+        return true;
+    }
+    return false;
+}
+
+void NotificationQueue::pop() {
+    if (count == 0) return;
+    head = (head + 1) % CAPACITY;
+    count--;
+    sent++;
+}
+
+size_t NotificationQueue::drainTo(hal::Transport& transport, size_t max_frames) {
+    size_t n = 0;
+    while (n < max_frames && count > 0 && !transport.isCongested()) {
+        const Frame& frame = frames[head];
+        if (!transport.notify(frame.data, frame.length)) break;
+        pop();
+        n++;
+    }
+    return n;
+}
+
+void NotificationQueue::clear() {
+    // 未送信分は切断で失われる
+    dropped += count;
+    head = 0;
+    count = 0;
+}
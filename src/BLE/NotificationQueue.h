@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "TelemetryProtocol.h"
+#include "../HAL/Transport.h"
+
+/**
+ * BLE送信待ち通知キュー（上限付き、loopスレッド専用）
+ *
+ * 特徴：
+ * - 1メッセージをMTUごとのチャンクに分けて一括で積む（途中までの送信はしない）
+ * - ライトデータ（1通知に収まるもの）は未送信の既存分を最新値で上書き（コアレス）
+ * - 満杯時はライトデータだけを捨てる。フル・イベントはライトデータを追い出して積む
+ * - バルク（履歴バックフィル）は予約枠を残して空きがある時だけ受け付ける（捨てずに呼び出し側が待つ）
+ * - 積んだ・送った・捨てた・上書きした数を計数
+ */
+class NotificationQueue {
+public:
+    static constexpr size_t CAPACITY = 16;
+    static constexpr size_t BULK_RESERVE = 4;   // バルクが使えないフル・イベント用の枠
+
+    // 送信データの種別（捨て方が異なる）
+    enum Kind : uint8_t {
+        KIND_LITE = 0,  // 定期ライトデータ：最新値だけあればよい
+        KIND_FULL,      // 定期フルデータ：捨てない
+        KIND_EVENT,     // ACK等：捨てない
+        KIND_BULK       // バックフィル：空きがある時だけ
+    };
+
+    struct Frame {
+        uint8_t length;
+        uint8_t kind;
+        bool coalescible;   // 単独チャンクのライトデータのみ
+        uint8_t data[TelemetryProtocol::MAX_FRAME_SIZE];
+    };
+
+private:
+    Frame frames[CAPACITY];
+    size_t head = 0;
+    size_t count = 0;
+
+    // 統計
+    uint32_t queued = 0;
+    uint32_t sent = 0;
+    uint32_t dropped = 0;
+    uint32_t coalesced = 0;
+
+    Frame& at(size_t i) { return frames[(head + i) % CAPACITY]; }
+    bool evictLite();
+
+public:
+    // length バイトを max_payload ごとに分割して積む。積めなければ何も積まず false
+    bool push(const uint8_t* data, size_t length, size_t max_payload, Kind kind);
+
+    // 先頭（送信順）
+    const Frame* peek() const { return count > 0 ? &frames[head] : nullptr; }
+    void pop();
+    void clear();
+
+    // 輻輳していない間、先頭から最大 max_frames 件を送信先へ渡す。送った件数を返す
+    size_t drainTo(hal::Transport& transport, size_t max_frames);
+
+    size_t size() const { return count; }
+    size_t available() const { return CAPACITY - count; }
+    bool canPushBulk(size_t chunks = 1) const { return available() >= chunks + BULK_RESERVE; }
+
+    uint32_t getQueuedCount() const { return queued; }
+    uint32_t getSentCount() const { return sent; }
+    uint32_t getDroppedCount() const { return dropped; }
+    uint32_t getCoalescedCount() const { return coalesced; }
+};
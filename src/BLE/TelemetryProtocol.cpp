@@ -0,0 +1,181 @@
+#include "TelemetryProtocol.h"
+#include <string.h>
+
+uint16_t TelemetryProtocol::crc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int16_t TelemetryProtocol::toCenti(float value) {
+    if (isnan(value)) return INT16_MIN;  // 無効値
+    float scaled = value * 100.0f;
+    if (scaled > INT16_MAX) return INT16_MAX;
+    if (scaled < INT16_MIN + 1) return INT16_MIN + 1;
+    return (int16_t)lroundf(scaled);
+}
+
+size_t TelemetryProtocol::encodeLive(const Snapshot& snap, uint8_t seq, uint8_t* out) {
+    LiveFrame frame;
+    frame.header = { VERSION, FRAME_LIVE, snap.flags, seq };
+    frame.sample_index = snap.sample_index;
+    frame.timestamp_ms = snap.timestamp_ms;
+    frame.temp_centi = toCenti(snap.temp);
+    frame.ror_centi = toCenti(snap.ror);
+    frame.stage = snap.stage;
+    frame.fire = snap.fire;
+    frame.crc = crc16((const uint8_t*)&frame, sizeof(frame) - sizeof(frame.crc));
+
+    memcpy(out, &frame, sizeof(frame));
+    return sizeof(frame);
+}
+
+size_t TelemetryProtocol::encodeStatus(const Snapshot& snap, uint8_t seq, uint8_t* out) {
+    StatusFrame frame;
+    frame.header = { VERSION, FRAME_STATUS, snap.flags, seq };
+    frame.ror_smooth_centi = toCenti(snap.ror_smooth);
+    frame.min_centi = toCenti(snap.temp_min);
+    frame.max_centi = toCenti(snap.temp_max);
+    frame.avg_centi = toCenti(snap.temp_avg);
+    frame.elapsed_s = snap.elapsed_s > UINT16_MAX ? UINT16_MAX : (uint16_t)snap.elapsed_s;
+    frame.level = snap.level;
+    frame.smoothing = snap.smoothing;
+    frame.missed = snap.missed > UINT16_MAX ? UINT16_MAX : (uint16_t)snap.missed;
+    frame.crc = crc16((const uint8_t*)&frame, sizeof(frame) - sizeof(frame.crc));
+
+    memcpy(out, &frame, sizeof(frame));
+    return sizeof(frame);
+}
+
+size_t TelemetryProtocol::encodePhase(const Snapshot& snap, uint8_t seq, uint8_t* out) {
+    PhaseFrame frame;
+    frame.header = { VERSION, FRAME_PHASE, snap.flags, seq };
+    for (uint8_t i = 0; i < PhaseMetrics::PHASE_COUNT; i++) {
+        frame.phase_s[i] = snap.phase_s[i] > UINT16_MAX ? UINT16_MAX : (uint16_t)lroundf(snap.phase_s[i]);
+        frame.auc[i] = snap.auc[i] > UINT16_MAX ? UINT16_MAX : (uint16_t)lroundf(snap.auc[i]);
+    }
+    frame.since_tp_s = snap.since_tp_s < 0.0f ? -1
+                     : (snap.since_tp_s > INT16_MAX ? INT16_MAX : (int16_t)lroundf(snap.since_tp_s));
+    frame.crc = crc16((const uint8_t*)&frame, sizeof(frame) - sizeof(frame.crc));
+
+    memcpy(out, &frame, sizeof(frame));
+    return sizeof(frame);
+}
+
+size_t TelemetryProtocol::encodeAck(uint8_t opcode, uint8_t command_seq, uint8_t status,
+                                    const Snapshot& snap, uint8_t seq, uint8_t* out) {
+    AckFrame frame = {};
+    frame.header = { VERSION, FRAME_ACK, snap.flags, seq };
+    frame.opcode = opcode;
+    frame.command_seq = command_seq;
+    frame.status = status;
+    frame.stage = snap.stage;
+    frame.level = snap.level;
+    frame.fire = snap.fire;
+    frame.sample_index = snap.sample_index;
+    frame.crc = crc16((const uint8_t*)&frame, sizeof(frame) - sizeof(frame.crc));
+
+    memcpy(out, &frame, sizeof(frame));
+    return sizeof(frame);
+}
+
+size_t TelemetryProtocol::putVarint(int32_t value, uint8_t* out, size_t capacity) {
+    // zigzag：小さな負の差分も1バイトに収める
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    size_t n = 0;
+    do {
+        if (n >= capacity) return 0;
+        uint8_t byte = zigzag & 0x7F;
+        zigzag >>= 7;
+        out[n++] = zigzag ? (byte | 0x80) : byte;
+    } while (zigzag);
+    return n;
+}
+
+size_t TelemetryProtocol::appendCrc(uint8_t* frame, size_t len) {
+    uint16_t crc = crc16(frame, len);
+    frame[len] = crc & 0xFF;
+    frame[len + 1] = crc >> 8;
+    return len + 2;
+}
+
+float TelemetryProtocol::fromCenti(int16_t centi) {
+    if (centi == INT16_MIN) return NAN;
+    return centi / 100.0f;
+}
+
+bool TelemetryProtocol::verify(const uint8_t* frame, size_t len) {
+    if (len < sizeof(Header) + 2 || len > MAX_FRAME_SIZE) return false;
+    if (frame[0] != VERSION) return false;
+    uint16_t crc = (uint16_t)frame[len - 2] | ((uint16_t)frame[len - 1] << 8);
+    return crc == crc16(frame, len - 2);
+}
+
+bool TelemetryProtocol::decodeFixed(const uint8_t* frame, size_t len, uint8_t type, void* out) {
+    if (len != FRAME_SIZE || !verify(frame, len)) return false;
+    if (frame[1] != type) return false;
+    memcpy(out, frame, FRAME_SIZE);
+    return true;
+}
+
+bool TelemetryProtocol::decodeLive(const uint8_t* frame, size_t len, LiveFrame& out) {
+    return decodeFixed(frame, len, FRAME_LIVE, &out);
+}
+
+bool TelemetryProtocol::decodeStatus(const uint8_t* frame, size_t len, StatusFrame& out) {
+    return decodeFixed(frame, len, FRAME_STATUS, &out);
+}
+
+bool TelemetryProtocol::decodePhase(const uint8_t* frame, size_t len, PhaseFrame& out) {
+    return decodeFixed(frame, len, FRAME_PHASE, &out);
+}
+
+bool TelemetryProtocol::decodeAck(const uint8_t* frame, size_t len, AckFrame& out) {
+    return decodeFixed(frame, len, FRAME_ACK, &out);
+}
+
+size_t TelemetryProtocol::getVarint(const uint8_t* in, size_t len, int32_t* value) {
+    uint32_t zigzag = 0;
+    for (size_t n = 0; n < len && n < 5; n++) {
+        zigzag |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) {
+            *value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+bool TelemetryProtocol::decodeBackfill(const uint8_t* frame, size_t len, BackfillHeader& header,
+                                       int16_t* values, size_t capacity) {
+    if (len < sizeof(BackfillHeader) + 2 || !verify(frame, len)) return false;
+    if (frame[1] != FRAME_BACKFILL) return false;
+    BackfillHeader parsed;
+    memcpy(&parsed, frame, sizeof(parsed));
+    if (parsed.count > capacity) return false;
+
+    // 差分は前の点からの増分
+    size_t pos = sizeof(BackfillHeader);
+    size_t end = len - 2;
+    int32_t value = parsed.first_value;
+    for (uint8_t i = 0; i < parsed.count; i++) {
+        if (i > 0) {
+            int32_t delta;
+            size_t n = getVarint(frame + pos, end - pos, &delta);
+            if (n == 0) return false;
+            pos += n;
+            value += delta;
+            if (value < INT16_MIN || value > INT16_MAX) return false;
+        }
+        values[i] = (int16_t)value;
+    }
+    if (pos != end) return false;
+
+    header = parsed;
+    return true;
+}
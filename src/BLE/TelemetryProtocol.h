@@ -0,0 +1,189 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "../RoastGuide/PhaseMetrics.h"
+
+/**
+ * BLEバイナリテレメトリ・プロトコル定義
+ *
+ * 機能：
+ * - バージョン付き固定長パックフレーム（リトルエンディアン）
+ * - CRC-16/CCITT-FALSE による破損検出
+ * - 静的バッファへの直接エンコード（ヒープ確保なし）
+ * - 1フレーム20バイト：既定MTU（23）の1通知に収まる
+ * - 履歴バックフィル：MTUに合わせた可変長・差分（zigzag varint）符号化
+ * - RXコマンドへの応答（ACK）：コマンドのseqと結果、実行後の状態
+ * - 受信側の検証・デコード（ホストでの往復テスト、クライアント実装の基準）
+ *
+ * フレーム共通ヘッダー：version, type, flags, seq（4バイト）
+ * 末尾2バイトは先頭からのCRC16
+ */
+class TelemetryProtocol {
+public:
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t FRAME_SIZE = 20;
+    static constexpr size_t MAX_FRAME_SIZE = 244;   // MTU 247 - ATTヘッダー3
+
+    // フレーム種別
+    enum FrameType : uint8_t {
+        FRAME_LIVE = 1,     // 毎秒：温度・RoR・ステージ・火力
+        FRAME_STATUS = 2,   // 15秒ごと：統計・経過時間・取得健全性
+        FRAME_BACKFILL = 3, // 要求時：履歴の差分符号化チャンク（count = 0 で終了）
+        FRAME_ACK = 4,      // コマンド応答
+        FRAME_PHASE = 5     // 状態フレームに続けて（投入後のみ）：フェーズ集計
+    };
+
+    // ヘッダーflagsのビット
+    enum Flags : uint8_t {
+        FLAG_RUNNING = 0x01,
+        FLAG_GUIDE_ACTIVE = 0x02,
+        FLAG_SENSOR_ERROR = 0x04
+    };
+
+    // コマンド応答の結果
+    enum AckStatus : uint8_t {
+        ACK_OK = 0,
+        ACK_UNKNOWN_OPCODE = 1, // 未対応のopcode
+        ACK_BAD_PAYLOAD = 2,    // payload長・値が不正
+        ACK_REJECTED = 3        // 現在の状態では実行できない
+    };
+
+    // 送信プロトコル（RXコマンドで切り替え）
+    enum Protocol : uint8_t {
+        PROTOCOL_JSON = 0,
+        PROTOCOL_BINARY = 1
+    };
+
+    // アプリ側から渡す現在値（エンコード前）
+    struct Snapshot {
+        uint32_t sample_index;
+        uint32_t timestamp_ms;
+        float temp;
+        float ror;
+        float ror_smooth;
+        float temp_min;
+        float temp_max;
+        float temp_avg;
+        uint32_t elapsed_s;
+        uint32_t missed;
+        uint8_t flags;
+        uint8_t stage;
+        uint8_t fire;
+        uint8_t level;
+        uint8_t smoothing;
+        // フェーズ集計（phase = PhaseMetrics::NO_PHASE は投入前）
+        uint8_t phase = PhaseMetrics::NO_PHASE;
+        float phase_s[PhaseMetrics::PHASE_COUNT];
+        float since_tp_s;       // 転換点前は負
+        float auc[PhaseMetrics::PHASE_COUNT];
+    };
+
+#pragma pack(push, 1)
+    struct Header {
+        uint8_t version;
+        uint8_t type;
+        uint8_t flags;
+        uint8_t seq;        // フレーム通し番号（欠落検出用、255で一周）
+    };
+
+    struct LiveFrame {
+        Header header;
+        uint32_t sample_index;
+        uint32_t timestamp_ms;
+        int16_t temp_centi;     // 0.01°C
+        int16_t ror_centi;      // 0.01°C/min
+        uint8_t stage;
+        uint8_t fire;
+        uint16_t crc;
+    };
+
+    struct StatusFrame {
+        Header header;
+        int16_t ror_smooth_centi;
+        int16_t min_centi;
+        int16_t max_centi;
+        int16_t avg_centi;
+        uint16_t elapsed_s;
+        uint8_t level;
+        uint8_t smoothing;
+        uint16_t missed;
+        uint16_t crc;
+    };
+
+    // DTR = 発達 / 3フェーズの合計（クライアント側で計算）
+    struct PhaseFrame {
+        Header header;
+        uint16_t phase_s[PhaseMetrics::PHASE_COUNT];    // 乾燥・メイラード・発達の秒
+        int16_t since_tp_s;     // 転換点からの秒（-1 = 転換点前）
+        uint16_t auc[PhaseMetrics::PHASE_COUNT];        // °C·分（100°C基準）
+        uint16_t crc;
+    };
+
+    struct AckFrame {
+        Header header;
+        uint8_t opcode;         // 応答対象のコマンド
+        uint8_t command_seq;    // 応答対象のコマンドseq
+        uint8_t status;         // AckStatus
+        uint8_t stage;          // 実行後の状態
+        uint8_t level;
+        uint8_t fire;
+        uint32_t sample_index;
+        uint8_t reserved[4];
+        uint16_t crc;
+    };
+
+    // バックフィルチャンク：この後に count-1 個の差分（zigzag varint）と CRC が続く
+    struct BackfillHeader {
+        Header header;
+        uint32_t first_index;   // 先頭点のサンプル番号
+        uint8_t span;           // 1点あたりのサンプル数（1, 5, 30）
+        uint8_t count;          // 点数
+        int16_t first_value;    // 先頭点の温度（0.1°C、平均値）
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(LiveFrame) == FRAME_SIZE, "LiveFrame must stay 20 bytes");
+    static_assert(sizeof(StatusFrame) == FRAME_SIZE, "StatusFrame must stay 20 bytes");
+    static_assert(sizeof(PhaseFrame) == FRAME_SIZE, "PhaseFrame must stay 20 bytes");
+    static_assert(sizeof(AckFrame) == FRAME_SIZE, "AckFrame must stay 20 bytes");
+
+    // CRC-16/CCITT-FALSE（poly 0x1021, init 0xFFFF）
+    static uint16_t crc16(const uint8_t* data, size_t len);
+
+    // out に FRAME_SIZE バイトを書き込み、書き込んだ長さを返す
+    static size_t encodeLive(const Snapshot& snap, uint8_t seq, uint8_t* out);
+    static size_t encodeStatus(const Snapshot& snap, uint8_t seq, uint8_t* out);
+    static size_t encodePhase(const Snapshot& snap, uint8_t seq, uint8_t* out);
+    static size_t encodeAck(uint8_t opcode, uint8_t command_seq, uint8_t status,
+                            const Snapshot& snap, uint8_t seq, uint8_t* out);
+
+    // 差分の可変長符号化：書き込んだバイト数（capacity不足なら0）
+    static size_t putVarint(int32_t value, uint8_t* out, size_t capacity);
+    // len バイトの後ろにCRCを付加し、合計長を返す
+    static size_t appendCrc(uint8_t* frame, size_t len);
+
+    // 固定小数点変換（範囲外は飽和）
+    static int16_t toCenti(float value);
+    // 逆変換（無効値 INT16_MIN は NAN）
+    static float fromCenti(int16_t centi);
+
+    // 受信フレームの検証：ヘッダー長・バージョン・末尾CRC
+    static bool verify(const uint8_t* frame, size_t len);
+
+    // 固定長フレームのデコード：検証・種別・長さが合わなければ false（out は変更しない）
+    static bool decodeLive(const uint8_t* frame, size_t len, LiveFrame& out);
+    static bool decodeStatus(const uint8_t* frame, size_t len, StatusFrame& out);
+    static bool decodePhase(const uint8_t* frame, size_t len, PhaseFrame& out);
+    static bool decodeAck(const uint8_t* frame, size_t len, AckFrame& out);
+
+    // バックフィルチャンクのデコード：values[0..count) に 0.1°C の値を復元
+    // 検証失敗・varintの破損・capacity不足・余分なバイトは false
+    static bool decodeBackfill(const uint8_t* frame, size_t len, BackfillHeader& header,
+                               int16_t* values, size_t capacity);
+
+    // putVarint の逆：読んだバイト数（途中で切れている・5バイト超なら0）
+    static size_t getVarint(const uint8_t* in, size_t len, int32_t* value);
+
+private:
+    static bool decodeFixed(const uint8_t* frame, size_t len, uint8_t type, void* out);
+};
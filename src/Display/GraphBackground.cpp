@@ -0,0 +1,131 @@
+#include "GraphBackground.h"
+
+// シングルトンインスタンス
+GraphBackground* GraphBackground::instance = nullptr;
+
+// パレット番号 → RGB565
+static const uint16_t GRAPH_COLORS[GraphBackground::GC_COUNT] = {
+    TFT_BLACK, TFT_CYAN, TFT_OLIVE, TFT_RED, TFT_DARKGREY, TFT_WHITE
+};
+
+GraphBackground::GraphBackground() {
+    // コンストラクタ
+}
+
+GraphBackground::~GraphBackground() {
+    // デストラクタ
+}
+
+void GraphBackground::begin(int16_t width, int16_t height, float temp_min, float temp_max, uint16_t span_sec) {
+    this->width = width > MAX_WIDTH ? MAX_WIDTH : width;
+    this->height = height > MAX_HEIGHT ? MAX_HEIGHT : height;
+    this->temp_min = temp_min;
+    this->temp_max = temp_max;
+    this->span_sec = span_sec > 1 ? span_sec : 2;
+    run_count = 0;
+    invalidate();
+}
+
+bool GraphBackground::createSprite(LGFX_Sprite& sprite, uint8_t depth) {
+    sprite.setColorDepth(depth);
+    if (!sprite.createSprite(width, height)) {
+        if (depth >= 16) return false;
+        // パレット確保に失敗した場合は従来の16bppで動作させる
+        M5_LOGE("Palette sprite (%dbpp) allocation failed, falling back to 16bpp", depth);
+        depth = 16;
+        sprite.setColorDepth(depth);
+        if (!sprite.createSprite(width, height)) return false;
+    }
+    color_depth = depth;
+
+    if (color_depth <= 8) {
+        for (uint8_t i = 0; i < GC_COUNT; i++) {
+            sprite.setPaletteColor(i, M5.Lcd.color16to24(GRAPH_COLORS[i]));
+        }
+    }
+    return true;
+}
+
+uint16_t GraphBackground::ink(GraphColor color) const {
+    return color_depth <= 8 ? (uint16_t)color : GRAPH_COLORS[color];
+}
+
+void GraphBackground::build(int16_t key, float danger_temp, float critical_temp,
+                            const ProfilePoint* profile, size_t len) {
+    buildRuns(danger_temp, critical_temp);
+    buildIdealCurve(profile, len);
+    built_key = key;
+}
+
+// 行ごとの背景色（全面描画とスクロール列で共通）
+GraphBackground::GraphColor GraphBackground::zoneColor(int16_t y, int16_t danger_y, int16_t critical_y) const {
+    // 緊急停止域（Critical〜上限）：4行ごとの縞模様
+    if (y < critical_y) {
+        if (y % 4 != 0) return GC_BLACK;
+        return (y % 8 < 4) ? GC_RED : GC_DARKGREY;
+    }
+    // 注意域（Danger〜Critical）
+    if (y < danger_y) return GC_OLIVE;
+    return GC_BLACK;
+}
+
+void GraphBackground::buildRuns(float danger_temp, float critical_temp) {
+    int16_t danger_y = (int16_t)tempToY(danger_temp);
+    int16_t critical_y = (int16_t)tempToY(critical_temp);
+
+    // 同色の連続行をまとめる
+    run_count = 0;
+    for (int16_t y = 0; y < height; y++) {
+        GraphColor color = zoneColor(y, danger_y, critical_y);
+        if (run_count > 0 && runs[run_count - 1].color == color) {
+            runs[run_count - 1].h++;
+        } else {
+            runs[run_count++] = { y, 1, color };
+        }
+    }
+}
+
+void GraphBackground::buildIdealCurve(const ProfilePoint* profile, size_t len) {
+    for (int16_t x = 0; x < width; x++) {
+        ideal_y[x] = NO_DOT;
+    }
+    if (!profile || len < 2) return;
+
+    for (size_t i = 1; i < len; ++i) {
+        // 区間の２端
+        float t0 = profile[i - 1].sec;
+        float v0 = profile[i - 1].temp;
+        float t1 = profile[i].sec;
+        float v1 = profile[i].temp;
+
+        // 区間を DOT_STEP 秒刻みで線形補間し、列ごとのドット位置を記録
+        for (uint16_t s = profile[i - 1].sec; s <= profile[i].sec; ++s) {
+            if ((s % DOT_STEP) != 0) continue;
+
+            int x = (float)s / (span_sec - 1) * width;
+            float f = (t1 > t0) ? (float)(s - t0) / (t1 - t0) : 0;
+            int y = tempToY(v0 + f * (v1 - v0));
+
+            if (x >= 0 && x < width && y >= 0 && y < height) {
+                ideal_y[x] = y;
+            }
+        }
+    }
+}
+
+void GraphBackground::render(LGFX_Sprite& sprite) const {
+    for (int16_t i = 0; i < run_count; i++) {
+        sprite.fillRect(0, runs[i].y, width, runs[i].h, ink(runs[i].color));
+    }
+    for (int16_t x = 0; x < width; x++) {
+        if (ideal_y[x] != NO_DOT) {
+            sprite.drawPixel(x, ideal_y[x], ink(GC_DARKGREY));
+        }
+    }
+}
+
+void GraphBackground::renderColumn(LGFX_Sprite& sprite, int16_t x) const {
+    for (int16_t i = 0; i < run_count; i++) {
+        sprite.drawFastVLine(x, runs[i].y, runs[i].h, ink(runs[i].color));
+    }
+}
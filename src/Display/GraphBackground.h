@@ -0,0 +1,112 @@
+#pragma once
+
+#include <M5Unified.h>
+
+// 理想プロファイル定義
+struct ProfilePoint {
+    uint16_t sec;  // 経過秒
+    float    temp; // 目標温度 (°C)
+};
+
+/**
+ * 温度グラフの静的背景レイヤー
+ *
+ * 機能：
+ * - 危険域・緊急停止域の帯と理想プロファイル曲線をローストレベルごとに1回だけ事前計算
+ * - 行ごとの背景色をラン（同色の連続行）表に圧縮して保持
+ * - 列ごとの理想曲線ドット位置を保持（浮動小数点補間は構築時のみ）
+ * - 全面再描画は矩形塗りとドット転写、スクロール時は1列のコピーのみ
+ * - グラフ用Spriteの4bitパレットモード（色はパレット番号で指定）
+ *
+ * 背景は縦方向の帯と列ごとのドットだけで構成されるため、
+ * 画面サイズのフレームバッファを持たずに約2KBで同じ内容を再現できる
+ */
+class GraphBackground {
+public:
+    static constexpr int16_t MAX_WIDTH = 320;
+    static constexpr int16_t MAX_HEIGHT = 240;
+    static constexpr int16_t NO_DOT = -1;
+
+    // グラフで使う色（パレット番号）
+    enum GraphColor : uint8_t {
+        GC_BLACK = 0,
+        GC_CYAN,
+        GC_OLIVE,
+        GC_RED,
+        GC_DARKGREY,
+        GC_WHITE,
+        GC_COUNT
+    };
+
+private:
+    // 同色の連続行
+    struct Run {
+        int16_t y;
+        int16_t h;
+        GraphColor color;
+    };
+
+    static constexpr int DOT_STEP = 4;  // 理想曲線のドット間隔（秒）
+
+    // 形状
+    int16_t width = 0;
+    int16_t height = 0;
+    float temp_min = 0.0f;
+    float temp_max = 1.0f;
+    uint16_t span_sec = 1;
+
+    // 事前計算結果
+    Run runs[MAX_HEIGHT];
+    int16_t run_count = 0;
+    int16_t ideal_y[MAX_WIDTH];  // 列ごとの理想曲線Y（NO_DOT = なし）
+    int16_t built_key = -1;      // 構築済みのローストレベル
+    uint8_t color_depth = 16;    // 描画先Spriteの色深度（8以下はパレット）
+
+    // シングルトン
+    static GraphBackground* instance;
+
+    GraphColor zoneColor(int16_t y, int16_t danger_y, int16_t critical_y) const;
+    void buildRuns(float danger_temp, float critical_temp);
+    void buildIdealCurve(const ProfilePoint* profile, size_t len);
+
+public:
+    GraphBackground();
+    ~GraphBackground();
+
+    // 初期化（グラフ領域の形状）
+    void begin(int16_t width, int16_t height, float temp_min, float temp_max, uint16_t span_sec);
+
+    // ローストレベル（key）ごとの事前計算
+    bool isBuiltFor(int16_t key) const { return built_key == key; }
+    void build(int16_t key, float danger_temp, float critical_temp, const ProfilePoint* profile, size_t len);
+    void invalidate() { built_key = -1; }
+
+    // 描画先Spriteの確保（depth <= 8 はパレット付き、失敗時は16bppで再試行）
+    bool createSprite(LGFX_Sprite& sprite, uint8_t depth);
+    uint8_t getColorDepth() const { return color_depth; }
+    size_t getSpriteBytes() const { return (size_t)width * height * color_depth / 8; }
+
+    // 描画色：パレットモードでは番号、16bppではRGB565
+    // LovyanGFXは uint32_t をRGB888と解釈するため、16bit型で返す（パレット番号は変換されない）
+    uint16_t ink(GraphColor color) const;
+
+    // 描画
+    void render(LGFX_Sprite& sprite) const;                     // 背景全体
+    void renderColumn(LGFX_Sprite& sprite, int16_t x) const;    // 帯のみ1列（スクロール用）
+
+    // 温度 → Y座標
+    float tempToY(float temp) const {
+        return height - (temp - temp_min) / (temp_max - temp_min) * height;
+    }
+
+    // シングルトンインスタンス取得
+    static GraphBackground* getInstance() {
+        if (!instance) {
+            instance = new GraphBackground();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define GRAPH_BG GraphBackground::getInstance()
@@ -0,0 +1,61 @@
+#include "TextField.h"
+
+TextField::TextField(const lgfx::IFont* font, uint16_t bg_color)
+    : font(font), bg_color(bg_color) {
+    text[0] = '\0';
+}
+
+bool TextField::printf(int16_t x, int16_t y, uint16_t color, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool drawn = vprintf(x, y, color, format, args);
+    va_end(args);
+    return drawn;
+}
+
+bool TextField::vprintf(int16_t x, int16_t y, uint16_t color, const char* format, va_list args) {
+    char buffer[MAX_TEXT];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+
+    // 文字列・色・位置が前回と同じなら描画不要
+    if (valid && x == this->x && y == this->y && color == this->color && strcmp(buffer, text) == 0) {
+        return false;
+    }
+
+    // 位置が変わった場合は旧領域を消去
+    if (valid && (x != this->x || y != this->y)) {
+        clear();
+    }
+
+    M5.Lcd.setFont(font);
+    M5.Lcd.setTextColor(color, bg_color);  // 背景色付きで上書き
+    M5.Lcd.setCursor(x, y);
+    M5.Lcd.print(buffer);
+
+    // 前回より短くなった分だけ末尾を消去
+    int16_t new_w = M5.Lcd.textWidth(buffer);
+    int16_t new_h = M5.Lcd.fontHeight();
+    if (valid && drawn_w > new_w) {
+        M5.Lcd.fillRect(x + new_w, y, drawn_w - new_w, drawn_h > new_h ? drawn_h : new_h, bg_color);
+    }
+    M5.Lcd.setTextColor(TFT_WHITE);
+
+    strncpy(text, buffer, sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    this->x = x;
+    this->y = y;
+    this->color = color;
+    drawn_w = new_w;
+    drawn_h = new_h;
+    valid = true;
+    return true;
+}
+
+void TextField::clear() {
+    if (valid && drawn_w > 0) {
+        M5.Lcd.fillRect(x, y, drawn_w, drawn_h, bg_color);
+    }
+    text[0] = '\0';
+    drawn_w = 0;
+    valid = true;  // 空文字列として描画済み
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <M5Unified.h>
+#include <stdarg.h>
+
+/**
+ * 差分描画テキストフィールド（保持型ウィジェット）
+ *
+ * 機能：
+ * - 前回描画した文字列・色・位置・幅を保持
+ * - 整形後の文字列が変わった時だけ再描画（変化なしならSPI転送ゼロ）
+ * - 背景色付きで上書きし、短くなった分の末尾だけを消去（全面fillRectによるちらつきなし）
+ * - 画面クリア後は invalidate() で次回の再描画を強制
+ */
+class TextField {
+public:
+    static constexpr size_t MAX_TEXT = 96;
+
+private:
+    const lgfx::IFont* font;
+    uint16_t bg_color;
+
+    // 前回描画した内容
+    char text[MAX_TEXT];
+    uint16_t color = 0;
+    int16_t x = 0;
+    int16_t y = 0;
+    int16_t drawn_w = 0;
+    int16_t drawn_h = 0;
+    bool valid = false;
+
+public:
+    TextField(const lgfx::IFont* font, uint16_t bg_color = TFT_BLACK);
+
+    // 整形して描画（変化がなければ何もしない）。描画した場合 true
+    bool printf(int16_t x, int16_t y, uint16_t color, const char* format, ...);
+    bool vprintf(int16_t x, int16_t y, uint16_t color, const char* format, va_list args);
+
+    // 画面側が消去された：次回必ず再描画
+    void invalidate() { valid = false; drawn_w = 0; }
+
+    // 描画済みの文字列を消去
+    void clear();
+
+    bool isVisible() const { return valid && drawn_w > 0; }
+};
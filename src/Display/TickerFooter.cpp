@@ -3,8 +3,9 @@
 // シングルトンインスタンス
 TickerFooter* TickerFooter::instance = nullptr;
 
-TickerFooter::TickerFooter() {
-    // コンストラクタ
+TickerFooter::TickerFooter()
+    : footer_sprite(&M5.Lcd)   // 転送先はLCD（pushSprite(x, y)の宛先）
+    , text_sprite(&footer_sprite) {
 }
 
 TickerFooter::~TickerFooter() {
@@ -14,15 +15,16 @@ TickerFooter::~TickerFooter() {
 void TickerFooter::begin() {
     enabled = false;
     message_count = 0;
+    next_slot = 0;
     current_index = 0;
-    scroll_offset = 0;
+    rendered_index = -1;
 }
 
 void TickerFooter::setEnabled(bool enable) {
     enabled = enable;
     if (!enable) {
         // 無効化時はフッター領域をクリア
-        M5.Lcd.fillRect(0, Y_POSITION, 320, 20, TFT_BLACK);
+        M5.Lcd.fillRect(0, Y_POSITION, WIDTH, HEIGHT, TFT_BLACK);
     } else {
         // 有効化時は初期メッセージを追加
         clearMessages();
@@ -31,30 +33,77 @@ void TickerFooter::setEnabled(bool enable) {
 }
 
 void TickerFooter::addMessage(const char* format, ...) {
-    if (!enabled) return;
-    
-    char buffer[128];
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    addMessageV(format, args);
     va_end(args);
+}
+
+void TickerFooter::addMessageV(const char* format, va_list args) {
+    if (!enabled) return;
     
+    char buffer[128];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    addText(buffer);
+}
+
+void TickerFooter::addText(const char* text) {
     // 既存メッセージと重複チェック
     for (int i = 0; i < message_count; i++) {
-        if (strcmp(messages[i].text, buffer) == 0) {
+        if (strcmp(messages[i].text, text) == 0) {
             return; // 重複メッセージは追加しない
         }
     }
     
-    // メッセージ追加（リングバッファ形式）
-    int index = message_count % MAX_MESSAGES;
-    strncpy(messages[index].text, buffer, sizeof(messages[index].text) - 1);
+    // メッセージ追加（リングバッファ形式、満杯時は最も古いものを上書き）
+    int index = next_slot;
+    strncpy(messages[index].text, text, sizeof(messages[index].text) - 1);
     messages[index].text[sizeof(messages[index].text) - 1] = '\0'; // null終端を保証
     messages[index].added_time = millis();
+    next_slot = (next_slot + 1) % MAX_MESSAGES;
     
     if (message_count < MAX_MESSAGES) {
         message_count++;
     }
+    
+    // 表示中のメッセージが上書きされた場合は描き直す
+    if (index == current_index) {
+        rendered_index = -1;
+    }
+}
+
+bool TickerFooter::ensureSprites() {
+    if (sprites_ready) return true;
+    
+    // 2色（黒・シアン）のみなので1bitパレットで確保（合計約2.7KB）
+    footer_sprite.setColorDepth(1);
+    text_sprite.setColorDepth(1);
+    if (!footer_sprite.createSprite(WIDTH, HEIGHT) ||
+        !text_sprite.createSprite(MAX_TEXT_WIDTH, TEXT_HEIGHT)) {
+        M5_LOGE("Ticker sprite allocation failed");
+        footer_sprite.deleteSprite();
+        text_sprite.deleteSprite();
+        return false;
+    }
+    footer_sprite.setPaletteColor(1, M5.Lcd.color16to24(TFT_CYAN));
+    text_sprite.setPaletteColor(1, M5.Lcd.color16to24(TFT_CYAN));
+    text_sprite.setFont(&fonts::lgfxJapanGothic_12);
+    text_sprite.setTextWrap(false);
+    sprites_ready = true;
+    return true;
+}
+
+void TickerFooter::renderMessage() {
+    const char* text = messages[current_index].text;
+    text_sprite.fillSprite(0);
+    text_sprite.setTextColor(1);
+    text_sprite.setCursor(0, 0);
+    text_sprite.print(text);
+    
+    text_width = text_sprite.textWidth(text);
+    if (text_width > MAX_TEXT_WIDTH) text_width = MAX_TEXT_WIDTH;
+    rendered_index = current_index;
+    scroll_start = millis();
 }
 
 void TickerFooter::update() {
@@ -65,34 +114,33 @@ void TickerFooter::update() {
     // メッセージ切り替えタイミング
     if (now - message_start > MESSAGE_DURATION) {
         current_index = (current_index + 1) % message_count;
-        scroll_offset = 320; // 右端から開始
+        rendered_index = -1;  // 右端から開始
         message_start = now;
     }
     
-    // スクロール更新
-    if (now - last_scroll > SCROLL_SPEED) {
-        scroll_offset -= 2; // 2ピクセルずつスクロール
-        last_scroll = now;
-        
-        // メッセージが左端を超えたら右端に戻す
-        const char* current_msg = messages[current_index].text;
-        int msg_width = M5.Lcd.textWidth(current_msg);
-        if (scroll_offset < -msg_width) {
-            scroll_offset = 320;
-        }
+    // フレームレート上限
+    if (now - last_frame < FRAME_INTERVAL_MS) return;
+    last_frame = now;
+    
+    if (!ensureSprites()) return;
+    if (rendered_index != current_index) {
+        renderMessage();
     }
     
-    // 描画
-    M5.Lcd.fillRect(0, Y_POSITION, 320, 20, TFT_BLACK);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.setTextColor(TFT_CYAN);
-    M5.Lcd.setCursor(scroll_offset, Y_POSITION + 4);
-    M5.Lcd.printf("%s", messages[current_index].text);
+    // 経過時間から位置を決める（フレーム落ちしても速度は一定）
+    uint32_t travel = (now - scroll_start) * SCROLL_PX_PER_SEC / 1000;
+    int offset = WIDTH - (int)(travel % (uint32_t)(WIDTH + text_width));
+    
+    // 描画済みメッセージをずらしてフッターに合成し、1回で転送
+    footer_sprite.fillSprite(0);
+    text_sprite.pushSprite(&footer_sprite, offset, TEXT_Y);
+    footer_sprite.pushSprite(0, Y_POSITION);
 }
 
 void TickerFooter::clearMessages() {
     message_count = 0;
+    next_slot = 0;
     current_index = 0;
-    scroll_offset = 0;
+    rendered_index = -1;
     message_start = millis();
-}
\ No newline at end of file
+}
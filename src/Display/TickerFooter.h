@@ -11,6 +11,8 @@
  * - システム情報の自動収集
  * - 非ブロッキングスクロール
  * - 重複メッセージの防止
+ * - メッセージは表示開始時に1回だけオフスクリーン（1bitスプライト）へ描画し、
+ *   スクロールはフッター幅のスプライトを上限25fpsで転送するだけ
  */
 class TickerFooter {
 public:
@@ -23,17 +25,35 @@ private:
     // 設定
     static constexpr int MAX_MESSAGES = 10;
     static constexpr uint32_t MESSAGE_DURATION = 5000; // 各メッセージ5秒表示
-    static constexpr uint32_t SCROLL_SPEED = 50; // スクロール速度(ms)
+    static constexpr uint32_t SCROLL_PX_PER_SEC = 40; // スクロール速度（従来の2px/50ms相当）
+    static constexpr uint32_t FRAME_INTERVAL_MS = 40;  // 描画上限 25fps
     static constexpr int Y_POSITION = 220; // フッター位置
+    static constexpr int WIDTH = 320;
+    static constexpr int HEIGHT = 20;
+    static constexpr int TEXT_Y = 4;                 // フッター内の文字位置
+    static constexpr int TEXT_HEIGHT = 16;
+    static constexpr int MAX_TEXT_WIDTH = 960;       // これを超える部分は切り捨て
     
     // メッセージ管理
     Message messages[MAX_MESSAGES];
     int message_count = 0;
+    int next_slot = 0;          // 次に書き込むリング位置
     int current_index = 0;
-    int scroll_offset = 0;
-    uint32_t last_scroll = 0;
     uint32_t message_start = 0;
     bool enabled = false;
+
+    // オフスクリーン描画
+    LGFX_Sprite footer_sprite;  // フッター1枚分（LCDへ転送）
+    LGFX_Sprite text_sprite;    // 現在のメッセージ（表示開始時に1回だけ描画、footer_spriteへ合成）
+    bool sprites_ready = false;
+    int rendered_index = -1;    // text_spriteに描画済みのメッセージ
+    int text_width = 0;
+    uint32_t scroll_start = 0;
+    uint32_t last_frame = 0;
+
+    bool ensureSprites();
+    void renderMessage();
+    void addText(const char* text);
     
     // シングルトン
     static TickerFooter* instance;
@@ -51,6 +71,7 @@ public:
     
     // メッセージ追加（可変長引数対応）
     void addMessage(const char* format, ...);
+    void addMessageV(const char* format, va_list args);
     
     // 更新処理（loop()から呼ぶ）
     void update();
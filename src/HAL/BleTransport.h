@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Transport.h"
+#include <BLECharacteristic.h>
+
+namespace hal {
+
+/**
+ * 実機の送信先：BLE TXキャラクタリスティックへのnotify
+ *
+ * 輻輳フラグはBLEタスク（GATTSイベント）が更新するものを参照する
+ */
+class BleTransport : public Transport {
+private:
+    BLECharacteristic* characteristic = nullptr;
+    const volatile bool* congested = nullptr;
+
+public:
+    void attach(BLECharacteristic* characteristic, const volatile bool* congested) {
+        this->characteristic = characteristic;
+        this->congested = congested;
+    }
+
+    bool notify(const uint8_t* data, size_t length) override {
+        if (!characteristic) return false;
+        characteristic->setValue((uint8_t*)data, length);
+        characteristic->notify();
+        return true;
+    }
+
+    bool isCongested() const override { return congested && *congested; }
+};
+
+}  // namespace hal
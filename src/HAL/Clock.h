@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Platform.h"
+
+/**
+ * 時計HAL
+ *
+ * 機能：
+ * - 実機ではArduinoのmillis()/micros()とesp_timerをインライン転送（オーバーヘッドなし）
+ * - ネイティブビルドではホストの単調時計、または仮想時計
+ * - 仮想時計は advanceClock() でのみ進む（シミュレーターで15分の焙煎を一瞬で再生）
+ * - 処理時間計測用のCPUサイクルカウンタ（仮想時計の影響を受けない実時間）
+ */
+#ifndef NATIVE_BUILD
+#include <esp_timer.h>
+#endif
+
+namespace hal {
+
+#ifdef NATIVE_BUILD
+
+uint32_t millis();
+uint32_t micros();
+int64_t timeUs();       // 64bitマイクロ秒（esp_timer_get_time()相当）
+
+// 仮想時計（有効中はホストの時刻を見ない）
+void useVirtualClock(bool enable);
+void setClockUs(int64_t us);
+void advanceClock(uint32_t ms);
+
+// ホストでは1ナノ秒 = 1サイクルとして扱う
+uint32_t cycleCount();
+inline uint32_t cpuMhz() { return 1000; }
+
+#else
+
+inline uint32_t millis() { return ::millis(); }
+inline uint32_t micros() { return ::micros(); }
+inline int64_t timeUs() { return esp_timer_get_time(); }
+inline uint32_t cycleCount() { return ESP.getCycleCount(); }
+inline uint32_t cpuMhz() { return ESP.getCpuFreqMHz(); }
+
+#endif
+
+}  // namespace hal
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Platform.h"
+
+/**
+ * 表示HAL
+ *
+ * 実機ではM5.Lcd（LovyanGFX）そのもの、ネイティブビルドでは
+ * 同じ呼び出し形の何もしない表示（NullDisplay）を HAL_DISPLAY として使う
+ */
+#ifdef NATIVE_BUILD
+#include "native/NullDisplay.h"
+#define HAL_DISPLAY hal::NullDisplay::get()
+#else
+#define HAL_DISPLAY M5.Lcd
+#endif
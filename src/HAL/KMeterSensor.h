@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ThermoSensor.h"
+#include <M5UnitKmeterISO.h>
+#include <Wire.h>
+
+namespace hal {
+
+/**
+ * 実機の熱電対センサー（M5Unit KMeterISO、I2C）
+ */
+class KMeterSensor : public ThermoSensor {
+private:
+    M5UnitKmeterISO kmeter;
+    TwoWire* wire = nullptr;
+    uint8_t address = 0;
+    int sda_pin = -1;
+    int scl_pin = -1;
+    uint32_t i2c_freq = 0;
+
+public:
+    // begin()前に接続先を設定
+    void configure(TwoWire* wire, uint8_t address, int sda, int scl, uint32_t freq) {
+        this->wire = wire;
+        this->address = address;
+        this->sda_pin = sda;
+        this->scl_pin = scl;
+        this->i2c_freq = freq;
+    }
+
+    bool begin() override { return kmeter.begin(wire, address, sda_pin, scl_pin, i2c_freq); }
+    uint8_t getReadyStatus() override { return kmeter.getReadyStatus(); }
+    int32_t getCelsiusTempValue() override { return kmeter.getCelsiusTempValue(); }
+};
+
+}  // namespace hal
@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+ * プラットフォーム共通ヘッダー（実機 / ホストネイティブ）
+ *
+ * 機能：
+ * - 実機ではArduino.hとM5Unified（ログマクロ）をそのまま読む
+ * - ネイティブビルド（NATIVE_BUILD）では標準ヘッダーと最小限の互換定義
+ *   （PROGMEM、memcpy_P、M5_LOGx）を提供
+ *
+ * 統計・微分・履歴・ガイド・安全などのロジック層は
+ * Arduino.hの代わりにこれを読み、実機依存はHAL経由にする
+ */
+#ifdef NATIVE_BUILD
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <cmath>
+#include <math.h>
+
+using std::abs;     // abs(float) を整数版にしない（Arduinoではマクロ）
+using std::isnan;
+
+// フラッシュ配置はホストでは通常のメモリ
+#define PROGMEM
+#define memcpy_P memcpy
+
+// ログ：エラー・警告のみ標準エラーへ（大量のシナリオ実行で出力を埋めない）
+#define M5_LOGE(fmt, ...) fprintf(stderr, "[E] " fmt "\n", ##__VA_ARGS__)
+#define M5_LOGW(fmt, ...) fprintf(stderr, "[W] " fmt "\n", ##__VA_ARGS__)
+#ifdef HAL_VERBOSE
+#define M5_LOGI(fmt, ...) fprintf(stderr, "[I] " fmt "\n", ##__VA_ARGS__)
+#else
+#define M5_LOGI(fmt, ...) ((void)0)
+#endif
+
+#else
+
+#include <Arduino.h>
+#include <M5Unified.h>
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Platform.h"
+
+/**
+ * スピーカーHAL
+ *
+ * 実機ではM5.Speaker、ネイティブビルドでは鳴らした回数だけを数える
+ * NullSpeaker を HAL_SPEAKER として使う
+ */
+#ifdef NATIVE_BUILD
+#include "native/NullSpeaker.h"
+#define HAL_SPEAKER hal::NullSpeaker::get()
+#else
+#define HAL_SPEAKER M5.Speaker
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Platform.h"
+
+/**
+ * ファイル保存先HAL
+ *
+ * 機能：
+ * - 実機ではLittleFS（内蔵フラッシュのspiffsパーティション）をVFSにマウントし、
+ *   "/littlefs/..." を標準のstdio（fopen/fwrite/fsync）で読み書きする
+ * - ネイティブビルドではホストのディレクトリ（既定 "journal"）を同じパスで使う
+ *   （実機から取り出したファイルをそのまま読める）
+ */
+#ifdef NATIVE_BUILD
+
+namespace hal {
+
+bool mountStorage();                    // ディレクトリがなければ作成
+const char* storageRoot();
+void setStorageRoot(const char* path);  // mountStorage() の前に
+
+}  // namespace hal
+
+#else
+
+#include <LittleFS.h>
+
+namespace hal {
+
+// 初回（未フォーマット）はフォーマットしてからマウント
+inline bool mountStorage() { return LittleFS.begin(true, "/littlefs"); }
+inline const char* storageRoot() { return "/littlefs"; }
+
+}  // namespace hal
+
+#endif
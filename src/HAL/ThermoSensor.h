@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Platform.h"
+
+namespace hal {
+
+/**
+ * 熱電対センサーHAL（I2C温度センサーの抽象）
+ *
+ * M5UnitKmeterISOと同じ呼び出し形・単位：
+ * - getReadyStatus()：0 = 変換完了（それ以外はエラーコード）
+ * - getCelsiusTempValue()：0.01°C単位の整数
+ *
+ * 実機はKMeterSensor、ホストではシミュレーターの偽センサーが実装する
+ */
+class ThermoSensor {
+public:
+    virtual ~ThermoSensor() {}
+
+    virtual bool begin() = 0;
+    virtual uint8_t getReadyStatus() = 0;
+    virtual int32_t getCelsiusTempValue() = 0;
+};
+
+}  // namespace hal
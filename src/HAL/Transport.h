@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Platform.h"
+
+namespace hal {
+
+/**
+ * 通知送信HAL（BLE TXキャラクタリスティックの抽象）
+ *
+ * NotificationQueue はこれに1通知ずつ渡す。
+ * 実機はBleTransport、ホストではCaptureTransportが送信内容を記録する
+ */
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    // 1通知分を送る（length はネゴシエート済みMTU - 3 以下）
+    virtual bool notify(const uint8_t* data, size_t length) = 0;
+
+    // 送信側バッファに空きがない（送ると失われる）
+    virtual bool isCongested() const { return false; }
+};
+
+}  // namespace hal
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../Transport.h"
+#include <vector>
+
+namespace hal {
+
+/**
+ * ネイティブビルド用の送信先：送られた通知をそのまま記録する
+ *
+ * setCongested() で混雑を模擬し、キューの保持・破棄の挙動を確認できる
+ */
+class CaptureTransport : public Transport {
+private:
+    std::vector<std::vector<uint8_t>> frames;
+    size_t bytes = 0;
+    bool congested = false;
+
+public:
+    bool notify(const uint8_t* data, size_t length) override {
+        frames.emplace_back(data, data + length);
+        bytes += length;
+        return true;
+    }
+
+    bool isCongested() const override { return congested; }
+    void setCongested(bool value) { congested = value; }
+
+    const std::vector<std::vector<uint8_t>>& getFrames() const { return frames; }
+    size_t getBytes() const { return bytes; }
+    void clear() { frames.clear(); bytes = 0; }
+};
+
+}  // namespace hal
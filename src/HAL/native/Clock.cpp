@@ -0,0 +1,49 @@
+#include "../Clock.h"
+#include <chrono>
+
+namespace hal {
+
+namespace {
+bool virtual_enabled = false;
+int64_t virtual_us = 0;
+
+int64_t hostUs() {
+    using namespace std::chrono;
+    static const steady_clock::time_point origin = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - origin).count();
+}
+}  // namespace
+
+int64_t timeUs() {
+    return virtual_enabled ? virtual_us : hostUs();
+}
+
+uint32_t millis() {
+    return (uint32_t)(timeUs() / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)timeUs();
+}
+
+uint32_t cycleCount() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void useVirtualClock(bool enable) {
+    if (enable && !virtual_enabled) {
+        virtual_us = hostUs();  // 切り替え時に時刻が戻らないよう引き継ぐ
+    }
+    virtual_enabled = enable;
+}
+
+void setClockUs(int64_t us) {
+    virtual_us = us;
+}
+
+void advanceClock(uint32_t ms) {
+    virtual_us += (int64_t)ms * 1000;
+}
+
+}  // namespace hal
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * ネイティブビルド用の表示（描画は全て捨てる）
+ *
+ * M5.Lcd のうちロジック層が使う呼び出しだけを同じ形で用意する。
+ * ガイド画面・安全ダイアログの描画コードをそのままホストでコンパイルできる
+ */
+
+// 色定義（RGB565、LovyanGFXと同じ値）
+#define TFT_BLACK       0x0000
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKGREY    0x7BEF
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_GREEN       0x07E0
+#define TFT_YELLOW      0xFFE0
+#define TFT_ORANGE      0xFD20
+#define TFT_WHITE       0xFFFF
+
+namespace lgfx {
+struct IFont {};
+}
+
+namespace fonts {
+inline constexpr lgfx::IFont lgfxJapanGothic_12 {};
+inline constexpr lgfx::IFont lgfxJapanGothic_16 {};
+}
+
+namespace hal {
+
+class NullDisplay {
+private:
+    uint32_t draw_calls = 0;
+
+public:
+    void fillRect(int32_t, int32_t, int32_t, int32_t, uint32_t) { draw_calls++; }
+    void drawRect(int32_t, int32_t, int32_t, int32_t, uint32_t) { draw_calls++; }
+    void drawLine(int32_t, int32_t, int32_t, int32_t, uint32_t) { draw_calls++; }
+    void setCursor(int32_t, int32_t) {}
+    void setFont(const lgfx::IFont*) {}
+    void setTextColor(uint32_t) {}
+    void setTextColor(uint32_t, uint32_t) {}
+    int32_t textWidth(const char*) { return 0; }
+    int32_t fontHeight() { return 0; }
+    void print(const char*) { draw_calls++; }
+    template <typename... Args>
+    void printf(const char*, Args...) { draw_calls++; }
+
+    uint32_t getDrawCalls() const { return draw_calls; }
+
+    static NullDisplay& get() {
+        static NullDisplay display;
+        return display;
+    }
+};
+
+}  // namespace hal
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace hal {
+
+/**
+ * ネイティブビルド用のスピーカー（鳴らした回数と最後の周波数だけ記録）
+ */
+class NullSpeaker {
+private:
+    uint32_t tone_count = 0;
+    float last_frequency = 0.0f;
+    bool playing = false;
+
+public:
+    void tone(float frequency, uint32_t) {
+        tone_count++;
+        last_frequency = frequency;
+        playing = true;
+    }
+    void stop() { playing = false; }
+
+    uint32_t getToneCount() const { return tone_count; }
+    float getLastFrequency() const { return last_frequency; }
+    bool isPlaying() const { return playing; }
+
+    static NullSpeaker& get() {
+        static NullSpeaker speaker;
+        return speaker;
+    }
+};
+
+}  // namespace hal
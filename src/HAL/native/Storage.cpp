@@ -0,0 +1,28 @@
+#include "../Storage.h"
+#include <sys/stat.h>
+#include <errno.h>
+#include <string>
+
+namespace hal {
+
+namespace {
+std::string root = "journal";
+}  // namespace
+
+bool mountStorage() {
+    if (mkdir(root.c_str(), 0755) != 0 && errno != EEXIST) {
+        M5_LOGE("Cannot create storage directory %s", root.c_str());
+        return false;
+    }
+    return true;
+}
+
+const char* storageRoot() {
+    return root.c_str();
+}
+
+void setStorageRoot(const char* path) {
+    root = path;
+}
+
+}  // namespace hal
@@ -0,0 +1,107 @@
+#include "TemperatureHistory.h"
+
+// シングルトンインスタンス
+TemperatureHistory* TemperatureHistory::instance = nullptr;
+
+TemperatureHistory::TemperatureHistory() {
+    clear();
+}
+
+TemperatureHistory::~TemperatureHistory() {
+    // デストラクタ
+}
+
+void TemperatureHistory::begin() {
+    clear();
+}
+
+void TemperatureHistory::clear() {
+    total_samples = 0;
+    mid_buckets = 0;
+    coarse_buckets = 0;
+    resetAccumulator(mid_acc);
+    resetAccumulator(coarse_acc);
+}
+
+void TemperatureHistory::resetAccumulator(Accumulator& acc) {
+    acc.min = INT16_MAX;
+    acc.max = INT16_MIN;
+    acc.sum = 0;
+    acc.n = 0;
+}
+
+void TemperatureHistory::accumulate(Accumulator& acc, int16_t value) {
+    if (value < acc.min) acc.min = value;
+    if (value > acc.max) acc.max = value;
+    acc.sum += value;
+    acc.n++;
+}
+
+TemperatureHistory::Bucket TemperatureHistory::finish(const Accumulator& acc) {
+    Bucket bucket;
+    bucket.min = acc.min;
+    bucket.max = acc.max;
+    bucket.mean = (int16_t)(acc.n > 0 ? acc.sum / acc.n : 0);
+    return bucket;
+}
+
+void TemperatureHistory::add(float temp, int64_t timestamp_us) {
+    int16_t value = (int16_t)(temp * 10.0f);  // 0.1°C刻みで格納
+
+    // 1秒解像度段
+    RawEntry& entry = raw[total_samples % RAW_SIZE];
+    entry.temp = value;
+    entry.ror = 0;
+    entry.ts_us = (uint32_t)timestamp_us;
+    total_samples++;
+
+    // 5秒段
+    accumulate(mid_acc, value);
+    if (mid_acc.n >= MID_SPAN) {
+        mid[mid_buckets % MID_SIZE] = finish(mid_acc);
+        mid_buckets++;
+        resetAccumulator(mid_acc);
+    }
+
+    // 30秒段
+    accumulate(coarse_acc, value);
+    if (coarse_acc.n >= COARSE_SPAN) {
+        coarse[coarse_buckets % COARSE_SIZE] = finish(coarse_acc);
+        coarse_buckets++;
+        resetAccumulator(coarse_acc);
+    }
+}
+
+void TemperatureHistory::setLatestRoR(float ror) {
+    if (total_samples == 0) return;
+    float scaled = ror * 10.0f;
+    if (scaled > INT16_MAX) scaled = INT16_MAX;
+    if (scaled < INT16_MIN) scaled = INT16_MIN;
+    raw[(total_samples - 1) % RAW_SIZE].ror = (int16_t)scaled;
+}
+
+uint32_t TemperatureHistory::getOldestIndex() const {
+    uint32_t oldest = rawStart();
+    if (mid_buckets > 0 && midFirstBucket() * MID_SPAN < oldest) {
+        oldest = midFirstBucket() * MID_SPAN;
+    }
+    if (coarse_buckets > 0 && coarseFirstBucket() * COARSE_SPAN < oldest) {
+        oldest = coarseFirstBucket() * COARSE_SPAN;
+    }
+    return oldest;
+}
+
+TemperatureHistory::Point TemperatureHistory::rawPoint(uint32_t index) const {
+    const RawEntry& entry = raw[index % RAW_SIZE];
+    return {index, 1, entry.temp, entry.temp, entry.temp};
+}
+
+TemperatureHistory::Point TemperatureHistory::midPoint(uint32_t bucket) const {
+    const Bucket& b = mid[bucket % MID_SIZE];
+    return {bucket * MID_SPAN, MID_SPAN, b.min, b.max, b.mean};
+}
+
+TemperatureHistory::Point TemperatureHistory::coarsePoint(uint32_t bucket) const {
+    const Bucket& b = coarse[bucket % COARSE_SIZE];
+    return {bucket * COARSE_SPAN, COARSE_SPAN, b.min, b.max, b.mean};
+}
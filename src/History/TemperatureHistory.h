@@ -0,0 +1,158 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+
+/**
+ * 多段解像度の温度履歴ストア
+ *
+ * 機能：
+ * - 直近5分は1秒解像度（温度・RoR・実タイムスタンプ）
+ * - それ以前は5秒／30秒単位のmin/max/mean間引き段で最大60分を保持
+ * - 温度は従来通り int16_t の0.1°C単位で格納
+ * - グラフ・統計・BLEバックフィル共通のクエリAPI（forEach）
+ *
+ * メモリ：300×8 + 240×6 + 120×6 = 4560 バイト
+ * （旧 buf[900] + ror_buf[900] の5400バイト以下）
+ */
+class TemperatureHistory {
+public:
+    // クエリ結果の1点（0.1°C単位）
+    struct Point {
+        uint32_t index;  // 先頭サンプル番号（記録開始からの通し番号）
+        uint16_t span;   // この点がまとめているサンプル数（1, 5, 30）
+        int16_t min;
+        int16_t max;
+        int16_t mean;
+    };
+
+    static constexpr uint16_t RAW_SIZE = 300;      // 1秒解像度：5分
+    static constexpr uint16_t MID_SPAN = 5;        // 5秒バケット
+    static constexpr uint16_t MID_SIZE = 240;      // 20分
+    static constexpr uint16_t COARSE_SPAN = 30;    // 30秒バケット
+    static constexpr uint16_t COARSE_SIZE = 120;   // 60分
+
+private:
+    struct RawEntry {
+        int16_t temp;     // 0.1°C
+        int16_t ror;      // 0.1°C/min
+        uint32_t ts_us;   // 実読み出し時刻（下位32bit）
+    };
+
+    struct Bucket {
+        int16_t min;
+        int16_t max;
+        int16_t mean;
+    };
+
+    // 集約中のバケット
+    struct Accumulator {
+        int16_t min;
+        int16_t max;
+        int32_t sum;
+        uint16_t n;
+    };
+
+    RawEntry raw[RAW_SIZE];
+    Bucket mid[MID_SIZE];
+    Bucket coarse[COARSE_SIZE];
+
+    uint32_t total_samples = 0;   // 追加された総サンプル数
+    uint32_t mid_buckets = 0;     // 確定した5秒バケット総数
+    uint32_t coarse_buckets = 0;  // 確定した30秒バケット総数
+    Accumulator mid_acc;
+    Accumulator coarse_acc;
+
+    // シングルトン
+    static TemperatureHistory* instance;
+
+    static void resetAccumulator(Accumulator& acc);
+    static void accumulate(Accumulator& acc, int16_t value);
+    static Bucket finish(const Accumulator& acc);
+
+    const RawEntry& rawAt(uint16_t ago) const {
+        return raw[(total_samples - 1 - ago) % RAW_SIZE];
+    }
+
+    // 段ごとの保持範囲（サンプル番号）
+    uint32_t rawStart() const { return total_samples - getRawCount(); }
+    uint32_t midFirstBucket() const { return mid_buckets > MID_SIZE ? mid_buckets - MID_SIZE : 0; }
+    uint32_t coarseFirstBucket() const { return coarse_buckets > COARSE_SIZE ? coarse_buckets - COARSE_SIZE : 0; }
+    Point midPoint(uint32_t bucket) const;
+    Point coarsePoint(uint32_t bucket) const;
+    Point rawPoint(uint32_t index) const;
+
+public:
+    TemperatureHistory();
+    ~TemperatureHistory();
+
+    // 初期化
+    void begin();
+    void clear();
+
+    // サンプル追加（1秒ごと）
+    void add(float temp, int64_t timestamp_us);
+    // 直近サンプルのRoRを記録（RoRは追加後に計算されるため）
+    void setLatestRoR(float ror);
+
+    // 件数
+    uint32_t getTotalSamples() const { return total_samples; }
+    uint16_t getRawCount() const { return total_samples < RAW_SIZE ? total_samples : RAW_SIZE; }
+    uint32_t getOldestIndex() const;
+
+    // 1秒解像度段へのアクセス（ago = 0 が最新、ago < getRawCount()）
+    float getTemp(uint16_t ago) const { return rawAt(ago).temp * 0.1f; }
+    float getRoR(uint16_t ago) const { return rawAt(ago).ror * 0.1f; }
+    uint32_t getTimestampUs(uint16_t ago) const { return rawAt(ago).ts_us; }
+    float getElapsedSeconds(uint16_t older_ago, uint16_t newer_ago) const {
+        return (uint32_t)(rawAt(newer_ago).ts_us - rawAt(older_ago).ts_us) / 1000000.0f;
+    }
+
+    /**
+     * [from_index, to_index) の範囲を古い順に訪問する共通クエリ
+     * 各区間で利用可能な最も細かい段を使う（古い側ほど粗い）
+     * fn(const Point&) が false を返すと打ち切り、訪問した点数を返す
+     */
+    template <typename Fn>
+    uint32_t forEach(uint32_t from_index, uint32_t to_index, Fn&& fn) const {
+        if (to_index > total_samples) to_index = total_samples;
+        uint32_t cursor = from_index > getOldestIndex() ? from_index : getOldestIndex();
+        uint32_t visited = 0;
+
+        // 30秒段：5秒段が保持していない区間
+        uint32_t mid_start = midFirstBucket() * MID_SPAN;
+        for (uint32_t b = cursor / COARSE_SPAN;
+             cursor < mid_start && cursor < to_index && b < coarse_buckets; ++b) {
+            visited++;
+            cursor = (b + 1) * COARSE_SPAN;
+            if (!fn(coarsePoint(b))) return visited;
+        }
+
+        // 5秒段：1秒段が保持していない区間
+        uint32_t raw_start = rawStart();
+        uint32_t mid_first = cursor / MID_SPAN > midFirstBucket() ? cursor / MID_SPAN : midFirstBucket();
+        for (uint32_t b = mid_first;
+             cursor < raw_start && cursor < to_index && b < mid_buckets; ++b) {
+            visited++;
+            cursor = (b + 1) * MID_SPAN;
+            if (!fn(midPoint(b))) return visited;
+        }
+
+        // 1秒段
+        for (uint32_t i = cursor > raw_start ? cursor : raw_start; i < to_index; ++i) {
+            visited++;
+            if (!fn(rawPoint(i))) return visited;
+        }
+        return visited;
+    }
+
+    // シングルトンインスタンス取得
+    static TemperatureHistory* getInstance() {
+        if (!instance) {
+            instance = new TemperatureHistory();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define HISTORY TemperatureHistory::getInstance()
@@ -0,0 +1,625 @@
+/**
+ * ホストネイティブ実行エントリ（pio run -e native）
+ *
+ * 使い方：
+ *   program [bench]                         合成カーブで1ティックの処理時間を計測
+ *   program sim [level] [charge] [batch] [ambient]
+ *                                           熱モデルで1回焙煎し、30秒ごとの経過を表示（ジャーナルに記録）
+ *   program sweep [count] [jobs]            シナリオを並列実行して集計
+ *   program trace                           bench の後にイベントトレースを出力（シリアルと同じ形式）
+ *   program trace2chrome < log > trace.json シリアルログのトレースを Chrome トレースJSONへ変換
+ *   program journal [id]                    焙煎ライブラリの一覧、または1焙煎のレコードをCSVで出力
+ *   program raw <file.btr>                  microSDの生データをCSVで出力（集計は標準エラーへ）
+ *   program replay [id]                     保存済みの焙煎（省略時は最新）をロジック層に最速で流し、
+ *                                           1ティックの処理時間と記録時とのステージ・火力の違いを表示
+ *   program detect [id]                     保存済みの焙煎（省略時は全件）で1ハゼ自動検出を評価
+ *                                           （正解は手動の1ハゼ確認）
+ *   program detect sim [count] [jobs]       シナリオ格子で1ハゼ自動検出を評価（正解は熱モデルの1ハゼ）
+ *
+ * ジャーナルの保存先は ./journal（環境変数 JOURNAL_DIR で変更、実機のLittleFSから取り出したものも可）
+ *
+ * bench は合成した15分間の焙煎カーブを仮想時計で1秒ずつ流し、
+ * 実機のloop()と同じ順でロジック層（統計・履歴・微分・ガイド・安全・火力・テレメトリ）を実行する
+ */
+// pio test -e native ではテスト側の main() を使う（ロジック層のソースだけをテストにリンク）
+#ifndef PIO_UNIT_TESTING
+
+#include "../HAL/Clock.h"
+#include "../HAL/native/CaptureTransport.h"
+#include "../Statistics/TemperatureStatistics.h"
+#include "../Statistics/DerivativeEngine.h"
+#include "../History/TemperatureHistory.h"
+#include "../RoastGuide/RoastGuide.h"
+#include "../RoastGuide/SampleProcessor.h"
+#include "../RoastGuide/FirstCrackDetector.h"
+#include "../Safety/SafetySystem.h"
+#include "../BLE/TelemetryProtocol.h"
+#include "../BLE/NotificationQueue.h"
+#include "../Simulator/RoastSimulation.h"
+#include "../Simulator/ScenarioSweep.h"
+#include "TraceConverter.h"
+#include "../Profiling/LoopProfiler.h"
+#include "../Profiling/TraceRecorder.h"
+#include "../Storage/RoastJournal.h"
+#include "../Storage/RawCaptureFormat.h"
+#include "../Storage/RoastReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t ROAST_SECONDS = 15 * 60;
+constexpr uint32_t PERIOD_MS = 1000;
+
+// 豆温度の合成カーブ：投入直後の落ち込み→転換点→RoRが下がり続ける上昇
+float syntheticTemp(uint32_t t, uint32_t& noise_state) {
+    float drop = 120.0f * expf(-(float)t / 25.0f);
+    float rise = 210.0f * (1.0f - expf(-(float)t / 420.0f));
+    noise_state = noise_state * 1664525u + 1013904223u;
+    float noise = ((noise_state >> 8) % 1000) / 1000.0f * 0.4f - 0.2f;
+    return 25.0f + drop + rise + noise;
+}
+
+// 実機の processSample() → sendBLEData() と同じ順のロジック層1ティック分
+// （ロジックは SampleProcessor を共有、画面描画・ビープ以外、bench と replay で共通）
+class LivePipeline {
+private:
+    NotificationQueue queue;
+    hal::CaptureTransport transport;
+    uint8_t frame[TelemetryProtocol::FRAME_SIZE];
+    uint8_t seq = 0;
+
+public:
+    LivePipeline() { SAMPLE_PROCESSOR->reset(); }
+
+    // 実機の startRoastGuide() 相当
+    void startGuide(RoastGuide::RoastLevel level) {
+        SAMPLE_PROCESSOR->startGuide(level, hal::millis());
+    }
+
+    void tick(uint32_t index, float temp) {
+        int64_t now_us = hal::timeUs();
+        PROFILE_TICK(now_us);
+        TRACE_MARK(MARK_SAMPLE, index);
+        SampleProcessor::Tick result;
+        {
+            PROFILE_SCOPE(SEC_SENSOR);
+            result = SAMPLE_PROCESSOR->process(index, temp, now_us);
+        }
+
+        PROFILE_SCOPE(SEC_BLE_SEND);
+        TelemetryProtocol::Snapshot snap = {};
+        snap.sample_index = index;
+        snap.timestamp_ms = hal::millis();
+        snap.temp = temp;
+        snap.ror = result.decision_ror;
+        snap.stage = ROAST_GUIDE->getCurrentStage();
+        snap.fire = SAMPLE_PROCESSOR->getFire();
+        size_t len = TelemetryProtocol::encodeLive(snap, seq++, frame);
+        queue.push(frame, len, TelemetryProtocol::FRAME_SIZE, NotificationQueue::KIND_LITE);
+        queue.drainTo(transport, 4);
+    }
+
+    RoastGuide::FirePower getFire() const { return SAMPLE_PROCESSOR->getFire(); }
+    uint32_t getFireChanges() const { return SAMPLE_PROCESSOR->getFireChanges(); }
+    const hal::CaptureTransport& getTransport() const { return transport; }
+};
+
+void printTickTimes(std::vector<double> tick_us) {
+    if (tick_us.empty()) return;
+    std::sort(tick_us.begin(), tick_us.end());
+    double sum = 0.0;
+    for (double us : tick_us) sum += us;
+    printf("tick time [us]: mean %.2f  p50 %.2f  p99 %.2f  max %.2f\n",
+           sum / tick_us.size(), tick_us[tick_us.size() / 2],
+           tick_us[tick_us.size() * 99 / 100], tick_us.back());
+}
+
+void printProfile() {
+    // 区間別（ループ周期・ジッタは仮想時計ではなく実時間のため参考値）
+    char line[256];
+    for (uint8_t i = 0; i < LoopProfiler::LINE_COUNT; i++) {
+        if (PROFILER->formatLine(i, line, sizeof(line)) > 0) printf("%s\n", line);
+    }
+}
+
+}  // namespace
+
+int runBench(bool dump_trace) {
+    hal::useVirtualClock(true);
+    hal::setClockUs(0);
+
+    TEMP_STATS->begin();
+    HISTORY->begin();
+    DERIVATIVE->begin();
+    ROAST_GUIDE->begin();
+    SAFETY->begin();
+
+    LivePipeline pipeline;
+    pipeline.startGuide(RoastGuide::ROAST_MEDIUM);
+    uint32_t noise_state = 1;
+    std::vector<double> tick_us;
+    tick_us.reserve(ROAST_SECONDS);
+
+    for (uint32_t t = 0; t < ROAST_SECONDS; t++) {
+        hal::advanceClock(PERIOD_MS);
+        float temp = syntheticTemp(t, noise_state);
+
+        auto begin = std::chrono::steady_clock::now();
+        {
+            PROFILE_LOOP_START();
+            PROFILE_SCOPE(SEC_LOOP);
+            pipeline.tick(t, temp);
+        }
+        auto end = std::chrono::steady_clock::now();
+        tick_us.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+    }
+
+    printf("ticks: %zu (virtual %u s)\n", tick_us.size(), hal::millis() / 1000);
+    printTickTimes(tick_us);
+    printf("final: %.1f C  stage %d  stats min %.1f max %.1f avg %.1f\n",
+           HISTORY->getTemp(0), (int)ROAST_GUIDE->getCurrentStage(),
+           TEMP_STATS->getMin(), TEMP_STATS->getMax(), TEMP_STATS->getAverage());
+    printf("fire changes: %u  frames sent: %zu (%zu bytes)  emergency: %s\n",
+           pipeline.getFireChanges(), pipeline.getTransport().getFrames().size(),
+           pipeline.getTransport().getBytes(),
+           SAFETY->getState().emergency_active ? "yes" : "no");
+    printProfile();
+
+    // 実機のシリアル出力と同じ形式（直近 TraceRecorder::CAPACITY イベント）
+    if (dump_trace) {
+        char line[256];
+        TRACE->beginDump();
+        while (TRACE->nextDumpLine(line, sizeof(line))) printf("%s\n", line);
+    }
+    return 0;
+}
+
+namespace {
+
+void printTrace(uint32_t second, const RoasterModel& model, float ror,
+                RoastGuide::RoastStage stage, RoastGuide::FirePower fire, void*) {
+    if (second % 30 != 0) return;
+    printf("%4us  probe %6.1f  bean %6.1f  drum %6.1f  RoR %5.1f  stage %d  fire %d  moisture %4.1f%%\n",
+           second, model.getProbeTemp(), model.getBeanTemp(), model.getDrumTemp(), ror,
+           (int)stage, (int)fire, model.getMoistureRatio() * 100.0f);
+}
+
+void printResult(const RoastSimulation::Result& r) {
+    printf("id %u level %u: %s after %u s, stage %u, drop %.1f C, max %.1f C, 1st crack %.0f s, "
+           "fire changes %u, adherence %.0f\n",
+           r.id, r.level, r.finished ? "finished" : (r.emergency ? "EMERGENCY" : "timeout"),
+           r.seconds, r.final_stage, r.drop_temp, r.max_temp, r.first_crack_s,
+           r.fire_changes, r.adherence);
+    printf("  stage entry [s]:");
+    for (uint8_t i = 0; i < RoastSimulation::STAGE_COUNT; i++) printf(" %d", (int)r.stage_entry_s[i]);
+    printf("\n");
+    printf("  crack detector: %.0f s (guide stage %u), accepted %.0f s, peak confidence %.2f\n",
+           r.crack_detect_s, r.crack_detect_stage, r.crack_accept_s, r.crack_confidence);
+}
+
+int runSingle(int argc, char** argv) {
+    RoastSimulation::Scenario scenario;
+    if (argc > 2) scenario.level = (RoastGuide::RoastLevel)atoi(argv[2]);
+    if (argc > 3) scenario.roaster.charge_temp = (float)atof(argv[3]);
+    if (argc > 4) scenario.roaster.batch_g = (float)atof(argv[4]);
+    if (argc > 5) scenario.roaster.ambient = (float)atof(argv[5]);
+    if (scenario.level >= RoastGuide::ROAST_COUNT) scenario.level = RoastGuide::ROAST_MEDIUM;
+    scenario.auto_first_crack = true;   // 実機と同じ
+    scenario.record_journal = JOURNAL->begin(RoastSimulation::PERIOD_MS);
+
+    RoastSimulation::Result r = RoastSimulation::run(scenario, printTrace, nullptr);
+    printResult(r);
+
+    // ガイドのイベントログ（サンプル番号、停止後も保持）
+    printf("  events:");
+    for (uint8_t i = 0; i < RoastGuide::EVENT_COUNT; i++) {
+        RoastGuide::EventType type = (RoastGuide::EventType)i;
+        if (!ROAST_GUIDE->hasEvent(type)) continue;
+        const RoastGuide::Event& e = ROAST_GUIDE->getEvent(type);
+        printf(" %s@%u(%.1fC)", RoastGuide::getEventName(type), e.sample_index, e.temp);
+    }
+    printf("\n");
+
+    // フェーズ集計（投入〜排出）
+    const PhaseMetrics& phases = ROAST_GUIDE->getPhaseMetrics();
+    printf("  phases:");
+    for (uint8_t i = 0; i < PhaseMetrics::PHASE_COUNT; i++) {
+        PhaseMetrics::Phase p = (PhaseMetrics::Phase)i;
+        printf(" %s %.0fs %.1f%% auc %.0f", PhaseMetrics::getPhaseName(p), phases.getPhaseSeconds(p),
+               phases.getPhasePercent(p), phases.getAUC(p));
+        printf(i + 1 < PhaseMetrics::PHASE_COUNT ? "," : "");
+    }
+    printf("; DTR %.1f%%, %.0f s since turning point\n", phases.getDTR(), phases.getSinceTurningPoint());
+    if (scenario.record_journal) printf("journal: roast %u\n", JOURNAL->getRecent(0)->id);
+    return r.finished ? 0 : 1;
+}
+
+int runJournal(int argc, char** argv) {
+    if (!JOURNAL->begin(RoastSimulation::PERIOD_MS)) return 2;
+
+    if (argc <= 2) {
+        printf("id    state boot   start_s  level dur_s samples max_C  drop_C 1st_crack_s stage "
+               "charge_s dry_s mai_s dev_s dtr_%%\n");
+        for (uint32_t n = 0; n < RoastJournal::MAX_ROASTS; n++) {
+            const RoastJournal::Entry* e = JOURNAL->getRecent(n);
+            if (!e) continue;
+            printf("%-5u %-5u %-6u %-8u %-5d %-5u %-7u %-6.1f %-6.1f %-11d %-5u %-8d %-5u %-5u %-5u %.1f\n",
+                   e->id, e->state, e->boot, e->start_ms / 1000,
+                   e->level == RoastJournal::NO_LEVEL ? -1 : e->level, e->duration_s, e->samples,
+                   e->max_temp_deci / 10.0f, e->drop_temp_deci / 10.0f,
+                   e->first_crack_s == RoastJournal::NO_FIRST_CRACK ? -1 : e->first_crack_s,
+                   e->final_stage, e->charge_s == RoastJournal::NO_CHARGE ? -1 : e->charge_s,
+                   e->phase_s[PhaseMetrics::PHASE_DRYING], e->phase_s[PhaseMetrics::PHASE_MAILLARD],
+                   e->phase_s[PhaseMetrics::PHASE_DEVELOPMENT], e->dtr_deci / 10.0f);
+        }
+        return 0;
+    }
+
+    RoastJournal::Reader reader;
+    if (!reader.open((uint32_t)atol(argv[2]))) {
+        fprintf(stderr, "roast %s not found\n", argv[2]);
+        return 1;
+    }
+    printf("sample,type,value16,value8\n");
+    RoastJournal::Record record;
+    while (reader.next(record)) {
+        printf("%u,%u,%d,%u\n", record.sample_index, record.type, record.value16, record.value8);
+    }
+    return 0;
+}
+
+int runSweep(int argc, char** argv) {
+    size_t count = argc > 2 ? (size_t)atol(argv[2]) : 1000;
+    unsigned jobs = argc > 3 ? (unsigned)atoi(argv[3]) : 0;
+    if (count == 0) return 0;
+
+    std::vector<RoastSimulation::Scenario> scenarios(count);
+    std::vector<RoastSimulation::Result> results(count);
+    ScenarioSweep::buildGrid(scenarios.data(), count, 1);
+
+    auto begin = std::chrono::steady_clock::now();
+    if (!ScenarioSweep::run(scenarios.data(), count, results.data(), jobs)) {
+        fprintf(stderr, "sweep failed\n");
+        return 2;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    // 焙煎度ごとの集計
+    struct Summary {
+        uint32_t runs, finished, emergency, timeout, cracked;
+        double seconds, first_crack, drop;
+    } summary[RoastGuide::ROAST_COUNT] = {};
+    for (const RoastSimulation::Result& r : results) {
+        Summary& s = summary[r.level];
+        s.runs++;
+        if (r.finished) {
+            s.finished++;
+            s.seconds += r.seconds;
+            if (r.first_crack_s >= 0) {   // -1 = 1ハゼ確認なし
+                s.cracked++;
+                s.first_crack += r.first_crack_s;
+            }
+            s.drop += r.drop_temp;
+        } else if (r.emergency) {
+            s.emergency++;
+        } else {
+            s.timeout++;
+        }
+    }
+
+    printf("%zu scenarios in %.2f s (%.0f roasts/s)\n", count, elapsed, count / elapsed);
+    printf("level  runs  finished  emergency  timeout  mean[s]  1st crack[s]  drop[C]\n");
+    for (int level = 0; level < RoastGuide::ROAST_COUNT; level++) {
+        const Summary& s = summary[level];
+        if (s.runs == 0) continue;
+        double n = s.finished ? s.finished : 1;
+        char crack[16] = "-";
+        if (s.cracked) snprintf(crack, sizeof(crack), "%.0f", s.first_crack / s.cracked);
+        printf("%5d %5u %9u %10u %8u %8.0f %13s %8.1f\n", level, s.runs, s.finished,
+               s.emergency, s.timeout, s.seconds / n, crack, s.drop / n);
+    }
+
+    uint32_t failed = 0;
+    for (const Summary& s : summary) failed += s.emergency + s.timeout;
+    return failed ? 1 : 0;
+}
+
+// 1ハゼ自動検出の評価：正解の CRACK_EARLY_S 前〜CRACK_LATE_S 後の検出を正解とする
+constexpr float CRACK_EARLY_S = 30.0f;
+constexpr float CRACK_LATE_S = 60.0f;
+
+struct DetectStats {
+    uint32_t roasts = 0, with_crack = 0, hits = 0, false_alarms = 0, misses = 0;
+    uint32_t unlabeled = 0;     // 正解のない焙煎（記録に手動の1ハゼ確認がない）
+    double latency_sum = 0.0, latency_min = 0.0, latency_max = 0.0;
+
+    // ガイドが受け付けたか（detect sim のみ：実機では受け付けられない検出は何もしない）
+    uint32_t guide_roasts = 0, accepted = 0, late = 0, unaccepted = 0;
+    double accept_delay_sum = 0.0;
+
+    // 時刻は焙煎開始（投入）から、負は「なし」
+    void add(float crack_s, float detect_s) {
+        roasts++;
+        if (crack_s >= 0.0f) with_crack++;
+        if (detect_s < 0.0f) {
+            if (crack_s >= 0.0f) misses++;
+            return;
+        }
+        float latency = detect_s - crack_s;
+        if (crack_s < 0.0f || latency < -CRACK_EARLY_S || latency > CRACK_LATE_S) {
+            false_alarms++;
+            if (crack_s >= 0.0f) misses++;
+            return;
+        }
+        if (hits == 0 || latency < latency_min) latency_min = latency;
+        if (hits == 0 || latency > latency_max) latency_max = latency;
+        hits++;
+        latency_sum += latency;
+    }
+
+    void addGuide(float detect_s, float accept_s, uint8_t detect_stage) {
+        guide_roasts++;
+        if (detect_s < 0.0f) return;
+        if (accept_s >= 0.0f) {
+            accepted++;
+            accept_delay_sum += accept_s - detect_s;
+        } else if (detect_stage > RoastGuide::STAGE_MAILLARD) {
+            late++;         // ガイドは既に1ハゼ以降
+        } else {
+            unaccepted++;   // 保留中にガイドが確認なしで1ハゼへ進んだ、または焙煎が終わった
+        }
+    }
+
+    void print() const {
+        uint32_t detections = hits + false_alarms;
+        printf("%u roasts (%u with 1st crack): %u detected, %u false, %u missed",
+               roasts, with_crack, hits, false_alarms, misses);
+        if (unlabeled) printf(", %u unlabeled skipped", unlabeled);
+        printf("\n");
+        printf("precision %.3f  recall %.3f  latency [s]: mean %.1f  min %.1f  max %.1f\n",
+               detections ? (double)hits / detections : 0.0,
+               with_crack ? (double)hits / with_crack : 0.0,
+               hits ? latency_sum / hits : 0.0, latency_min, latency_max);
+        if (guide_roasts) {
+            printf("guide: %u accepted (mean wait %.1f s), %u after the guide passed Maillard, "
+                   "%u never accepted\n",
+                   accepted, accepted ? accept_delay_sum / accepted : 0.0, late, unaccepted);
+        }
+    }
+};
+
+int runDetectSim(int argc, char** argv) {
+    size_t count = argc > 3 ? (size_t)atol(argv[3]) : 1000;
+    unsigned jobs = argc > 4 ? (unsigned)atoi(argv[4]) : 0;
+    if (count == 0) return 0;
+
+    std::vector<RoastSimulation::Scenario> scenarios(count);
+    std::vector<RoastSimulation::Result> results(count);
+    ScenarioSweep::buildGrid(scenarios.data(), count, 1);
+    for (RoastSimulation::Scenario& s : scenarios) s.auto_first_crack = true;   // 実機と同じ
+    if (!ScenarioSweep::run(scenarios.data(), count, results.data(), jobs)) {
+        fprintf(stderr, "sweep failed\n");
+        return 2;
+    }
+
+    DetectStats total, per_level[RoastGuide::ROAST_COUNT];
+    for (const RoastSimulation::Result& r : results) {
+        total.add(r.first_crack_s, r.crack_detect_s);
+        total.addGuide(r.crack_detect_s, r.crack_accept_s, r.crack_detect_stage);
+        per_level[r.level].add(r.first_crack_s, r.crack_detect_s);
+        per_level[r.level].addGuide(r.crack_detect_s, r.crack_accept_s, r.crack_detect_stage);
+    }
+    for (int level = 0; level < RoastGuide::ROAST_COUNT; level++) {
+        if (per_level[level].roasts == 0) continue;
+        printf("level %d: ", level);
+        per_level[level].print();
+    }
+    printf("total: ");
+    total.print();
+    return 0;
+}
+
+// 記録済みの1焙煎を微分エンジンと検出器だけに流す（ガイドの判断は記録のまま）
+bool detectJournal(uint32_t id, DetectStats& stats) {
+    RoastJournal::Reader reader;
+    if (!reader.open(id)) return false;
+    uint32_t period_ms = reader.getHeader().period_ms ? reader.getHeader().period_ms : 1000;
+
+    DERIVATIVE->reset();
+    bool started = false, has_crack = false, has_detect = false;
+    uint32_t start_index = 0, crack_index = 0, detect_index = 0;
+    RoastJournal::Record r;
+    while (reader.next(r)) {
+        if (r.type == RoastJournal::REC_GUIDE_START && !started) {
+            CRACK_DETECTOR->reset(ROAST_GUIDE->getRoastTarget(RoastGuide::STAGE_FIRST_CRACK,
+                                                              (RoastGuide::RoastLevel)r.value8));
+            started = true;
+            start_index = r.sample_index;
+        } else if (r.type == RoastJournal::REC_FIRST_CRACK && r.value8 == 0 && !has_crack) {
+            has_crack = true;   // 手動の確認のみ（自動検出の記録は正解にしない）
+            crack_index = r.sample_index;
+        } else if (r.type == RoastJournal::REC_SAMPLE && r.value16 != INT16_MIN) {
+            float temp = r.value16 / 10.0f;
+            DERIVATIVE->add(temp, (int64_t)r.sample_index * period_ms * 1000);
+            if (started && CRACK_DETECTOR->update(r.sample_index, temp,
+                                                  DERIVATIVE->getRoR(DerivativeEngine::WINDOW_15S),
+                                                  DERIVATIVE->getRoRofRoR())) {
+                has_detect = true;
+                detect_index = r.sample_index;
+            }
+        }
+    }
+    if (!started) return true;  // ガイドなしの焙煎は評価しない
+
+    float crack_s = has_crack ? (crack_index - start_index) * period_ms / 1000.0f : -1.0f;
+    float detect_s = has_detect ? (detect_index - start_index) * period_ms / 1000.0f : -1.0f;
+    printf("roast %u: 1st crack %.0f s, detected %.0f s, peak confidence %.2f\n",
+           id, crack_s, detect_s, CRACK_DETECTOR->getPeakConfidence());
+    // 確認ボタンが押されていない焙煎は1ハゼがなかったとは限らない：評価から外す
+    if (has_crack) {
+        stats.add(crack_s, detect_s);
+    } else {
+        stats.unlabeled++;
+    }
+    return true;
+}
+
+int runDetect(int argc, char** argv) {
+    if (argc > 2 && strcmp(argv[2], "sim") == 0) return runDetectSim(argc, argv);
+    if (!JOURNAL->begin(RoastSimulation::PERIOD_MS)) return 2;
+
+    DetectStats stats;
+    if (argc > 2) {
+        if (!detectJournal((uint32_t)atol(argv[2]), stats)) {
+            fprintf(stderr, "roast %s not found\n", argv[2]);
+            return 1;
+        }
+    } else {
+        for (uint32_t n = RoastJournal::MAX_ROASTS; n-- > 0;) {
+            const RoastJournal::Entry* e = JOURNAL->getRecent(n);
+            if (e) detectJournal(e->id, stats);
+        }
+    }
+    stats.print();
+    return 0;
+}
+
+int runRaw(int argc, char** argv) {
+    if (argc <= 2) {
+        fprintf(stderr, "usage: program raw <file.btr>\n");
+        return 2;
+    }
+    FILE* f = fopen(argv[2], "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+
+    RawCaptureFormat::Header header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != RawCaptureFormat::MAGIC ||
+        header.version != RawCaptureFormat::VERSION ||
+        header.record_size != sizeof(RawCaptureFormat::Record) ||
+        fseek(f, (long)header.header_size, SEEK_SET) != 0) {
+        fprintf(stderr, "%s is not a raw capture file\n", argv[2]);
+        fclose(f);
+        return 1;
+    }
+
+    uint32_t count = 0, errors = 0, gaps = 0, max_read_us = 0;
+    bool has_last = false;
+    uint32_t last_index = 0;
+    RawCaptureFormat::Record r;
+    printf("index,time_ms,temp_c,status,sampled,read_us\n");
+    while (fread(&r, sizeof(r), 1, f) == 1) {
+        count++;
+        if (r.status != 0) errors++;
+        if (has_last && r.index != last_index + 1) gaps += r.index - last_index - 1;
+        if (r.read_us > max_read_us) max_read_us = r.read_us;
+        has_last = true;
+        last_index = r.index;
+        if (r.temp_centi == RawCaptureFormat::INVALID_TEMP) {
+            printf("%u,%u,,%u,%u,%u\n", r.index, r.time_ms, r.status,
+                   r.flags & RawCaptureFormat::FLAG_SAMPLED, r.read_us);
+        } else {
+            printf("%u,%u,%.2f,%u,%u,%u\n", r.index, r.time_ms, r.temp_centi / 100.0f, r.status,
+                   r.flags & RawCaptureFormat::FLAG_SAMPLED, r.read_us);
+        }
+    }
+    fclose(f);
+    fprintf(stderr, "session %u: %u records at %u ms, %u sensor errors, %u missing, max read %u us\n",
+            header.session_id, count, header.raw_period_ms, errors, gaps, max_read_us);
+    return 0;
+}
+
+int runReplay(int argc, char** argv) {
+    if (!JOURNAL->begin(RoastSimulation::PERIOD_MS)) return 2;
+
+    // 仮想時計：サンプルごとに記録時の時刻へ合わせる（ガイドの経過時間も記録時と同じ）
+    hal::useVirtualClock(true);
+    hal::setClockUs(1000000);
+    TEMP_STATS->reset();
+    HISTORY->clear();
+    DERIVATIVE->reset();
+    SAFETY->begin();
+    ROAST_GUIDE->stop();
+
+    uint32_t id = argc > 2 ? (uint32_t)atol(argv[2]) : 0;
+    if (!REPLAY->start(id, RoastReplay::SPEED_MAX, hal::millis(), hal::timeUs())) {
+        fprintf(stderr, "roast %s not found\n", argc > 2 ? argv[2] : "(latest)");
+        return 1;
+    }
+
+    LivePipeline pipeline;
+    uint32_t sensor_errors = 0;
+    std::vector<double> tick_us;
+    RoastReplay::Item item;
+    while (REPLAY->next(hal::millis(), item)) {
+        if (item.type == RoastReplay::ITEM_GUIDE_START) {
+            pipeline.startGuide((RoastGuide::RoastLevel)item.value);
+            continue;
+        }
+        if (item.type == RoastReplay::ITEM_FIRST_CRACK) {
+            // 手動の確認のみ（自動検出は再生側で判定し直す）
+            if (item.value == 0 && ROAST_GUIDE->isFirstCrackConfirmationNeeded()) ROAST_GUIDE->confirmFirstCrack();
+            continue;
+        }
+        hal::setClockUs(item.timestamp_us);
+        if (item.status != 0) {
+            sensor_errors++;
+            continue;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        {
+            PROFILE_LOOP_START();
+            PROFILE_SCOPE(SEC_LOOP);
+            pipeline.tick(item.index, item.temp);
+        }
+        auto end = std::chrono::steady_clock::now();
+        tick_us.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+        REPLAY->compare(ROAST_GUIDE->getCurrentStage(), pipeline.getFire());
+    }
+
+    const RoastReplay::Summary& s = REPLAY->getSummary();
+    printf("roast %u: %u samples (%u sensor errors), virtual %u s\n",
+           s.roast_id, s.samples, sensor_errors, (hal::millis() - 1000) / 1000);
+    printTickTimes(tick_us);
+    printf("recorded stage changes: %u  stage mismatch: %u samples  fire mismatch: %u samples\n",
+           s.stage_changes, s.stage_mismatch, s.fire_mismatch);
+    printf("final: stage %d  fire changes %u  emergency: %s\n",
+           (int)ROAST_GUIDE->getCurrentStage(), pipeline.getFireChanges(),
+           SAFETY->getState().emergency_active ? "yes" : "no");
+    if (CRACK_DETECTOR->isDetected()) {
+        printf("1st crack detected at sample %u\n", CRACK_DETECTOR->getDetectedIndex());
+    }
+    printProfile();
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* mode = argc > 1 ? argv[1] : "bench";
+    if (const char* dir = getenv("JOURNAL_DIR")) hal::setStorageRoot(dir);
+    if (strcmp(mode, "journal") == 0) return runJournal(argc, argv);
+    if (strcmp(mode, "raw") == 0) return runRaw(argc, argv);
+    if (strcmp(mode, "replay") == 0) return runReplay(argc, argv);
+    if (strcmp(mode, "detect") == 0) return runDetect(argc, argv);
+    if (strcmp(mode, "sim") == 0) return runSingle(argc, argv);
+    if (strcmp(mode, "sweep") == 0) return runSweep(argc, argv);
+    if (strcmp(mode, "trace2chrome") == 0) {
+        long events = TraceConverter::toChromeJson(stdin, stdout);
+        if (events < 0) {
+            fprintf(stderr, "no TRACE BEGIN line in input\n");
+            return 1;
+        }
+        fprintf(stderr, "%ld events\n", events);
+        return 0;
+    }
+    return runBench(strcmp(mode, "trace") == 0);
+}
+
+#endif  // PIO_UNIT_TESTING
@@ -0,0 +1,137 @@
+#include "TraceConverter.h"
+#include "../Profiling/TraceRecorder.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+
+namespace {
+
+constexpr size_t MAX_IDS = 256;
+
+// 1回分の出力（TRACE BEGIN〜TRACE END）の変換状態
+struct Dump {
+    unsigned pid = 0;
+    double cpu_mhz = 240.0;
+    std::string names[MAX_IDS];
+    uint32_t depth[MAX_IDS];    // 区間ごとの開いている数
+    bool has_last = false;
+    uint32_t last_cycles = 0;
+    uint64_t cycles = 0;        // 一周補正済み（先頭イベントからの経過）
+};
+
+void writeEscaped(FILE* out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') fputc('\\', out);
+        if ((unsigned char)c >= 0x20) fputc(c, out);
+    }
+}
+
+const std::string& nameOf(Dump& dump, uint8_t id) {
+    if (dump.names[id].empty()) {
+        // 名前表のない古い出力：IDをそのまま名前に
+        char buf[16];
+        snprintf(buf, sizeof(buf), "id%u", id);
+        dump.names[id] = buf;
+    }
+    return dump.names[id];
+}
+
+// "cccccccc kk ii aaaa"（16進16文字）を1イベント出力。出力したら true
+bool writeEvent(Dump& dump, const char* hex, bool& first, FILE* out) {
+    char field[9];
+    memcpy(field, hex, 8);
+    field[8] = '\0';
+    uint32_t raw = (uint32_t)strtoul(field, nullptr, 16);
+    memcpy(field, hex + 8, 2);
+    field[2] = '\0';
+    char kind = (char)strtoul(field, nullptr, 16);
+    memcpy(field, hex + 10, 2);
+    uint8_t id = (uint8_t)strtoul(field, nullptr, 16);
+    memcpy(field, hex + 12, 4);
+    field[4] = '\0';
+    unsigned arg = (unsigned)strtoul(field, nullptr, 16);
+
+    // 差分は符号なし32bitで取る：一周（240MHzで約17.9秒）を跨いでも正しい
+    if (dump.has_last) dump.cycles += (uint32_t)(raw - dump.last_cycles);
+    dump.last_cycles = raw;
+    dump.has_last = true;
+
+    if (kind == TraceRecorder::KIND_END) {
+        if (dump.depth[id] == 0) return false;  // 開始が上書き済み
+        dump.depth[id]--;
+    } else if (kind == TraceRecorder::KIND_BEGIN) {
+        dump.depth[id]++;
+    } else if (kind != TraceRecorder::KIND_MARK) {
+        return false;
+    }
+
+    fprintf(out, "%s\n{\"name\":\"", first ? "" : ",");
+    writeEscaped(out, nameOf(dump, id));
+    fprintf(out, "\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%u,\"tid\":1",
+            kind == TraceRecorder::KIND_MARK ? "i" : (kind == TraceRecorder::KIND_BEGIN ? "B" : "E"),
+            dump.cycles / dump.cpu_mhz, dump.pid);
+    if (kind == TraceRecorder::KIND_MARK) {
+        fprintf(out, ",\"s\":\"t\",\"args\":{\"arg\":%u}", arg);
+    }
+    fputc('}', out);
+    first = false;
+    return true;
+}
+
+}  // namespace
+
+long TraceConverter::toChromeJson(FILE* in, FILE* out) {
+    Dump* dump = nullptr;
+    unsigned dumps = 0;
+    long events = 0;
+    bool first = true;
+    char line[512];
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    while (fgets(line, sizeof(line), in)) {
+        const char* p = strstr(line, "TRACE ");
+        if (!p) continue;
+        p += 6;
+
+        if (strncmp(p, "BEGIN", 5) == 0) {
+            delete dump;
+            dump = new Dump();
+            memset(dump->depth, 0, sizeof(dump->depth));
+            dump->pid = ++dumps;
+            unsigned mhz = 0, count = 0;
+            unsigned long overwritten = 0;
+            if (sscanf(p + 5, "%u %u %lu", &mhz, &count, &overwritten) >= 1 && mhz > 0) {
+                dump->cpu_mhz = mhz;
+            }
+            fprintf(out, "%s\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,"
+                         "\"args\":{\"name\":\"trace %u (%u events, %lu overwritten)\"}}",
+                    first ? "" : ",", dump->pid, dump->pid, count, overwritten);
+            first = false;
+        } else if (!dump) {
+            continue;   // BEGIN より前の断片
+        } else if (strncmp(p, "NAME", 4) == 0) {
+            unsigned id;
+            char name[64];
+            if (sscanf(p + 4, "%u %63s", &id, name) == 2 && id < MAX_IDS) {
+                dump->names[id] = name;
+            }
+        } else if (strncmp(p, "EV", 2) == 0) {
+            p += 2;
+            while (*p == ' ') {
+                p++;
+                size_t len = strspn(p, "0123456789abcdefABCDEF");
+                if (len != 16) break;   // 途中で切れた行
+                if (writeEvent(*dump, p, first, out)) events++;
+                p += len;
+            }
+        } else if (strncmp(p, "END", 3) == 0) {
+            delete dump;
+            dump = nullptr;
+        }
+    }
+    fprintf(out, "\n]}\n");
+
+    delete dump;
+    return dumps > 0 ? events : -1;
+}
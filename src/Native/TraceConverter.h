@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdio.h>
+
+/**
+ * TraceRecorder のシリアル出力 → Chrome トレースJSON 変換（ホスト専用）
+ *
+ * 機能：
+ * - シリアルログから "TRACE ..." 行だけを拾う（他のログ行・行頭のタイムスタンプは無視）
+ * - 32bitサイクルカウンタの一周を補正して µs に換算（TRACE BEGIN の cpu_mhz）
+ * - 区間は B/E、マーカーは瞬間イベント（arg を args に）として出力
+ * - 開始がリングから溢れた区間の終了イベントは捨てる（Perfettoでの崩れ防止）
+ * - ログ中の複数回の出力はそれぞれ別プロセス（pid）として並べる
+ *
+ * 出力は chrome://tracing / ui.perfetto.dev でそのまま開ける
+ */
+class TraceConverter {
+public:
+    // 変換したイベント数を返す（TRACE BEGIN が1つもなければ -1）
+    static long toChromeJson(FILE* in, FILE* out);
+};
@@ -0,0 +1,186 @@
+#include "LoopProfiler.h"
+#include "TraceRecorder.h"
+
+// シングルトンインスタンス
+LoopProfiler* LoopProfiler::instance = nullptr;
+
+// 区間はトレースにも開始・終了イベントとして残す（同じサイクル値を使用）
+#if TRACE_RECORDER
+LoopProfiler::Scope::Scope(Section section)
+    : section(section), start(0), active(PROFILER->isEnabled() || TRACE->isRecording()) {
+    if (active) {
+        start = hal::cycleCount();
+        TRACE->record(start, TraceRecorder::KIND_BEGIN, section);
+    }
+}
+
+LoopProfiler::Scope::~Scope() {
+    if (active) {
+        uint32_t end = hal::cycleCount();
+        PROFILER->record(section, end - start);
+        TRACE->record(end, TraceRecorder::KIND_END, section);
+    }
+}
+#else
+LoopProfiler::Scope::Scope(Section section)
+    : section(section), start(0), active(PROFILER->isEnabled()) {
+    if (active) start = hal::cycleCount();
+}
+
+LoopProfiler::Scope::~Scope() {
+    if (active) PROFILER->record(section, hal::cycleCount() - start);
+}
+#endif
+
+// コンストラクタ
+LoopProfiler::LoopProfiler() {
+    reset();
+}
+
+void LoopProfiler::clearStats(Stats& stats) {
+    memset(&stats, 0, sizeof(stats));
+    stats.min = UINT32_MAX;
+}
+
+void LoopProfiler::add(Stats& stats, uint32_t value) {
+    stats.count++;
+    stats.sum += value;
+    if (value < stats.min) stats.min = value;
+    if (value > stats.max) stats.max = value;
+    uint8_t bucket = value ? (uint8_t)(31 - __builtin_clz(value)) : 0;
+    stats.hist[bucket]++;
+}
+
+void LoopProfiler::reset() {
+    for (uint8_t i = 0; i < SECTION_COUNT; i++) {
+        clearStats(sections[i]);
+    }
+    clearStats(loop_period);
+    clearStats(tick_jitter);
+    has_last_loop = false;
+    has_last_tick = false;
+    reset_ms = hal::millis();
+}
+
+void LoopProfiler::setEnabled(bool enable) {
+    if (enable && !enabled) {
+        // 無効だった間の空白を周期・ジッタに含めない
+        has_last_loop = false;
+        has_last_tick = false;
+    }
+    enabled = enable;
+}
+
+void LoopProfiler::loopStart() {
+    if (!enabled) return;
+    uint32_t now = hal::cycleCount();
+    if (has_last_loop) {
+        add(loop_period, now - last_loop_start);
+    }
+    last_loop_start = now;
+    has_last_loop = true;
+}
+
+void LoopProfiler::recordTick(int64_t timestamp_us) {
+    if (!enabled) return;
+    if (has_last_tick) {
+        int64_t delta = timestamp_us - last_tick_us - tick_period_us;
+        if (delta < 0) delta = -delta;
+        add(tick_jitter, delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta);
+    }
+    last_tick_us = timestamp_us;
+    has_last_tick = true;
+}
+
+float LoopProfiler::getLoopHz() const {
+    if (loop_period.count == 0 || loop_period.sum == 0) return 0.0f;
+    float mean_cycles = (float)loop_period.sum / loop_period.count;
+    return hal::cpuMhz() * 1000000.0f / mean_cycles;
+}
+
+const char* LoopProfiler::getSectionName(Section section) {
+    switch (section) {
+        case SEC_BUTTONS: return "buttons";
+        case SEC_BEEPS: return "beeps";
+        case SEC_BLE_POLL: return "ble_poll";
+        case SEC_SENSOR: return "sensor";
+        case SEC_SAFETY: return "safety";
+        case SEC_CURRENT_VALUE: return "current_value";
+        case SEC_MODE_DRAW: return "mode_draw";
+        case SEC_BLE_SEND: return "ble_send";
+        case SEC_TICKER: return "ticker";
+        case SEC_JOURNAL: return "journal";
+        case SEC_LOOP: return "loop";
+        default: return "unknown";
+    }
+}
+
+size_t LoopProfiler::clampLength(int written, size_t size) {
+    // snprintfの戻り値（切り詰め前の長さ）を実際に書けた長さへ
+    if (written <= 0) return 0;
+    return (size_t)written < size ? (size_t)written : size - 1;
+}
+
+bool LoopProfiler::histRange(const Stats& stats, uint8_t& first, uint8_t& last) {
+    if (stats.count == 0) return false;
+    first = 0;
+    while (first < HIST_BUCKETS - 1 && stats.hist[first] == 0) first++;
+    last = HIST_BUCKETS - 1;
+    while (last > first && stats.hist[last] == 0) last--;
+    return true;
+}
+
+const LoopProfiler::Stats* LoopProfiler::getLine(uint8_t line, const char** name, bool* in_us) const {
+    *in_us = false;
+    if (line >= 1 && line <= SECTION_COUNT) {
+        *name = getSectionName((Section)(line - 1));
+        return &sections[line - 1];
+    }
+    if (line == SECTION_COUNT + 1) {
+        *name = "loop_period";
+        return &loop_period;
+    }
+    if (line == SECTION_COUNT + 2) {
+        *name = "tick_jitter";
+        *in_us = true;
+        return &tick_jitter;
+    }
+    return nullptr;
+}
+
+size_t LoopProfiler::formatLine(uint8_t line, char* buf, size_t size) const {
+    if (size == 0) return 0;
+    buf[0] = '\0';
+
+    if (line == 0) {
+        int n = snprintf(buf, size, "profile %s: %lu ms, %u MHz, loop %.1f Hz",
+                         enabled ? "on" : "off", (unsigned long)getWindowMs(),
+                         (unsigned)hal::cpuMhz(), getLoopHz());
+        return clampLength(n, size);
+    }
+
+    const char* name;
+    bool in_us;
+    const Stats* stats = getLine(line, &name, &in_us);
+    if (!stats) return 0;
+    float scale = in_us ? 1.0f : 1.0f / hal::cpuMhz();
+
+    if (stats->count == 0) {
+        return clampLength(snprintf(buf, size, "%-14s n=0", name), size);
+    }
+    int n = snprintf(buf, size, "%-14s n=%lu min=%.1fus mean=%.1fus max=%.1fus hist",
+                     name, (unsigned long)stats->count, stats->min * scale,
+                     (float)stats->sum / stats->count * scale, stats->max * scale);
+    size_t len = clampLength(n, size);
+
+    // ヒストグラム：非ゼロ範囲だけ「2^b:回数」で出力
+    uint8_t first, last;
+    if (histRange(*stats, first, last)) {
+        for (uint8_t b = first; b <= last && len + 1 < size; b++) {
+            n = snprintf(buf + len, size - len, " %u:%lu", b, (unsigned long)stats->hist[b]);
+            if (n <= 0) break;
+            len += clampLength(n, size - len);
+        }
+    }
+    return len;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "../HAL/Clock.h"
+
+/**
+ * loop() のサブシステム別プロファイラ
+ *
+ * 機能：
+ * - CPUサイクルカウンタ（ESP.getCycleCount()）で区間ごとの所要時間を計測
+ * - 区間ごとに 回数・最小・平均・最大 と log2ヒストグラム（2^b〜2^(b+1)サイクル）
+ * - loop() の周期（ループ周波数）とセンサーティックのジッタ（周期からのずれ、µs）
+ * - 実行時に有効/無効を切り替え（無効時は区間ごとにフラグ1回の判定のみ）
+ * - LOOP_PROFILER=0 でビルドすると計測マクロは空になる（コードも消える）
+ *
+ * 区間は入れ子にできる（内側の時間は外側にも含まれる）
+ * TraceRecorder が有効なら各区間の開始・終了もトレースに記録する
+ */
+#ifndef LOOP_PROFILER
+#define LOOP_PROFILER 1
+#endif
+
+class LoopProfiler {
+public:
+    // 計測区間
+    enum Section : uint8_t {
+        SEC_BUTTONS = 0,    // handleButtons
+        SEC_BEEPS,          // handleNonBlockingBeeps
+        SEC_BLE_POLL,       // BLE接続管理・コマンド・バックフィル
+        SEC_SENSOR,         // 取得済みサンプルの消費（processSample全体）
+        SEC_SAFETY,         // checkEmergencyConditions（SEC_SENSORの内側）
+        SEC_CURRENT_VALUE,  // drawCurrentValue
+        SEC_MODE_DRAW,      // 表示モード別の描画
+        SEC_BLE_SEND,       // sendBLEData
+        SEC_TICKER,         // updateTickerFooterWrapper
+        SEC_JOURNAL,        // 焙煎ジャーナルのページ書き込み
+        SEC_LOOP,           // loop() 1回分全体
+        SECTION_COUNT
+    };
+
+    static constexpr uint8_t HIST_BUCKETS = 32;
+
+    // 区間・ループ周期はサイクル、ティックジッタはµs単位
+    struct Stats {
+        uint32_t count;
+        uint32_t min;
+        uint32_t max;
+        uint64_t sum;
+        uint32_t hist[HIST_BUCKETS];
+    };
+
+    // 区間の自動計測（スコープ終了で記録、早期returnでも漏れない）
+    class Scope {
+    private:
+        Section section;
+        uint32_t start;
+        bool active;
+    public:
+        explicit Scope(Section section);
+        ~Scope();
+    };
+
+private:
+    bool enabled = true;
+    Stats sections[SECTION_COUNT];
+
+    // ループ周期（サイクル）
+    Stats loop_period;
+    uint32_t last_loop_start = 0;
+    bool has_last_loop = false;
+
+    // センサーティックのジッタ（µs）
+    Stats tick_jitter;
+    uint32_t tick_period_us = 1000000;
+    int64_t last_tick_us = 0;
+    bool has_last_tick = false;
+
+    uint32_t reset_ms = 0;
+
+    // シングルトン
+    static LoopProfiler* instance;
+
+    static void add(Stats& stats, uint32_t value);
+    static void clearStats(Stats& stats);
+    static size_t clampLength(int written, size_t size);
+
+public:
+    LoopProfiler();
+
+    // 有効/無効（無効にしても集計済みの値は保持）
+    void setEnabled(bool enable);
+    bool isEnabled() const { return enabled; }
+    void reset();
+
+    // 計測
+    void record(Section section, uint32_t cycles) {
+        if (enabled) add(sections[section], cycles);
+    }
+    void loopStart();                       // loop() の先頭で呼ぶ
+    void setTickPeriod(uint32_t period_us) { tick_period_us = period_us; }
+    void recordTick(int64_t timestamp_us);  // サンプルの取得時刻
+
+    // 参照
+    const Stats& getStats(Section section) const { return sections[section]; }
+    const Stats& getLoopPeriod() const { return loop_period; }
+    const Stats& getTickJitter() const { return tick_jitter; }
+    static const char* getSectionName(Section section);
+    float getLoopHz() const;                // 平均ループ周期から
+    uint32_t getWindowMs() const { return hal::millis() - reset_ms; }
+
+    // サイクル → µs
+    static float toUs(uint64_t cycles) { return (float)cycles / hal::cpuMhz(); }
+
+    // 出力は行単位：0 = 概要、1..SECTION_COUNT = 区間、続いてループ周期、ティックジッタ
+    static constexpr uint8_t LINE_COUNT = SECTION_COUNT + 3;
+    // 行の統計（概要行・範囲外は nullptr）。in_us：値がµs単位（それ以外はサイクル）
+    const Stats* getLine(uint8_t line, const char** name, bool* in_us) const;
+    // テキスト1行（シリアル用）
+    size_t formatLine(uint8_t line, char* buf, size_t size) const;
+
+    // ヒストグラムの非ゼロ範囲 [first, last]（空なら false）
+    static bool histRange(const Stats& stats, uint8_t& first, uint8_t& last);
+
+    // シングルトンインスタンス取得
+    static LoopProfiler* getInstance() {
+        if (!instance) {
+            instance = new LoopProfiler();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define PROFILER LoopProfiler::getInstance()
+
+#if LOOP_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(section) LoopProfiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(LoopProfiler::section)
+#define PROFILE_LOOP_START() PROFILER->loopStart()
+#define PROFILE_TICK(timestamp_us) PROFILER->recordTick(timestamp_us)
+#else
+#define PROFILE_SCOPE(section) ((void)0)
+#define PROFILE_LOOP_START() ((void)0)
+#define PROFILE_TICK(timestamp_us) ((void)0)
+#endif
@@ -0,0 +1,77 @@
+#include "TraceRecorder.h"
+#include "LoopProfiler.h"
+
+// シングルトンインスタンス
+TraceRecorder* TraceRecorder::instance = nullptr;
+
+void TraceRecorder::clear() {
+    head = 0;
+    count = 0;
+    overwritten = 0;
+}
+
+const char* TraceRecorder::getName(uint8_t id) {
+    if (id < LoopProfiler::SECTION_COUNT) {
+        return LoopProfiler::getSectionName((LoopProfiler::Section)id);
+    }
+    switch (id) {
+        case MARK_SAMPLE: return "sample";
+        case MARK_SENSOR_ERROR: return "sensor_error";
+        case MARK_FULL_REDRAW: return "full_redraw";
+        case MARK_BLE_FULL: return "ble_full";
+        case MARK_BLE_FLUSH: return "ble_flush";
+        case MARK_BEEP: return "beep";
+        case MARK_STAGE_CHANGE: return "stage_change";
+        case MARK_EMERGENCY: return "emergency";
+        default: return nullptr;
+    }
+}
+
+void TraceRecorder::beginDump() {
+    frozen = true;      // 出力し終えるまで内容を固定
+    dumping = true;
+    dump_pos = 0;
+}
+
+bool TraceRecorder::nextDumpLine(char* buf, size_t size) {
+    if (!dumping || size == 0) return false;
+    buf[0] = '\0';
+
+    // 名前表：区間 0..SECTION_COUNT-1 とマーカー 32..MARK_END-1
+    constexpr size_t NAME_COUNT = LoopProfiler::SECTION_COUNT + (MARK_END - MARK_SAMPLE);
+    size_t pos = dump_pos++;
+
+    if (pos == 0) {
+        snprintf(buf, size, "TRACE BEGIN %u %u %lu", (unsigned)hal::cpuMhz(),
+                 (unsigned)count, (unsigned long)overwritten);
+        return true;
+    }
+    pos -= 1;
+
+    if (pos < NAME_COUNT) {
+        uint8_t id = pos < LoopProfiler::SECTION_COUNT
+            ? (uint8_t)pos
+            : (uint8_t)(MARK_SAMPLE + (pos - LoopProfiler::SECTION_COUNT));
+        snprintf(buf, size, "TRACE NAME %u %s", id, getName(id));
+        return true;
+    }
+    pos -= NAME_COUNT;
+
+    size_t first = pos * EVENTS_PER_LINE;
+    if (first < count) {
+        // 1イベント = cycles(8) kind(2) id(2) arg(4) の16進16文字
+        size_t len = (size_t)snprintf(buf, size, "TRACE EV");
+        for (size_t i = first; i < count && i < first + EVENTS_PER_LINE && len + 18 < size; i++) {
+            const Event& e = at(i);
+            len += snprintf(buf + len, size - len, " %08lx%02x%02x%04x",
+                            (unsigned long)e.cycles, e.kind, e.id, e.arg);
+        }
+        return true;
+    }
+
+    snprintf(buf, size, "TRACE END");
+    dumping = false;
+    frozen = false;
+    clear();
+    return true;
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "../HAL/Clock.h"
+
+/**
+ * 固定長のイベントトレース（RAM上のリングバッファ）
+ *
+ * 機能：
+ * - 区間の開始・終了とマーカー（瞬間イベント）をCPUサイクルのタイムスタンプ付きで記録
+ * - 1イベント8バイト、CAPACITY件を超えると古いものから上書き
+ * - LoopProfilerの各区間（PROFILE_SCOPE）は自動で開始・終了を記録
+ * - シリアルへの16進テキスト出力（出力中は記録を止めて内容を固定）
+ *   → ネイティブビルドの program trace2chrome（src/Native/TraceConverter.cpp）で
+ *     Chrome / Perfetto のトレースJSONへ変換
+ *
+ * 集計（LoopProfiler）では見えない個々の遅いフレーム
+ * （全体再描画とBLEフル送信とビープが同じティックに重なる等）を確認するためのもの
+ */
+#ifndef TRACE_RECORDER
+#define TRACE_RECORDER 1
+#endif
+
+class TraceRecorder {
+public:
+    static constexpr size_t CAPACITY = 1024;   // 8KB
+    static constexpr uint8_t EVENTS_PER_LINE = 6;   // 1行 < UART FIFO（128バイト）
+
+    // イベント種別
+    enum Kind : uint8_t {
+        KIND_BEGIN = 'B',
+        KIND_END = 'E',
+        KIND_MARK = 'I'
+    };
+
+    // イベントID：0〜31 は LoopProfiler::Section、32〜 はマーカー
+    enum Mark : uint8_t {
+        MARK_SAMPLE = 32,       // arg：サンプル番号の下位16bit
+        MARK_SENSOR_ERROR,      // arg：ステータス
+        MARK_FULL_REDRAW,       // グラフ全体再描画
+        MARK_BLE_FULL,          // BLEフルデータ送信
+        MARK_BLE_FLUSH,         // arg：キューへ積んだバイト数
+        MARK_BEEP,              // arg：周波数
+        MARK_STAGE_CHANGE,      // arg：新しいステージ
+        MARK_EMERGENCY,
+        MARK_END
+    };
+
+#pragma pack(push, 1)
+    struct Event {
+        uint32_t cycles;
+        uint8_t kind;
+        uint8_t id;
+        uint16_t arg;
+    };
+#pragma pack(pop)
+    static_assert(sizeof(Event) == 8, "Event must stay 8 bytes");
+
+private:
+    Event events[CAPACITY];
+    size_t head = 0;        // 次の書き込み位置
+    size_t count = 0;
+    uint32_t overwritten = 0;
+    bool enabled = true;
+    bool frozen = false;    // 出力中
+
+    // 出力状態
+    size_t dump_pos = 0;    // 0 = ヘッダー行、1.. = 名前行、以降イベント行
+    bool dumping = false;
+
+    // シングルトン
+    static TraceRecorder* instance;
+
+public:
+    // 記録（割り込み・別タスクからは呼ばない：loopスレッド専用）
+    void record(uint32_t cycles, Kind kind, uint8_t id, uint16_t arg = 0) {
+        if (!enabled || frozen) return;
+        Event& e = events[head];
+        e.cycles = cycles;
+        e.kind = kind;
+        e.id = id;
+        e.arg = arg;
+        head = (head + 1) % CAPACITY;
+        if (count < CAPACITY) {
+            count++;
+        } else {
+            overwritten++;
+        }
+    }
+    void mark(Mark id, uint16_t arg = 0) { record(hal::cycleCount(), KIND_MARK, id, arg); }
+
+    void setEnabled(bool enable) { enabled = enable; }
+    bool isEnabled() const { return enabled; }
+    bool isRecording() const { return enabled && !frozen; }  // 出力中は記録しない
+    void clear();
+
+    size_t size() const { return count; }
+    uint32_t getOverwrittenCount() const { return overwritten; }
+    const Event& at(size_t i) const { return events[(head + CAPACITY - count + i) % CAPACITY]; }
+    static const char* getName(uint8_t id);
+
+    // テキスト出力：beginDump() 後、nextDumpLine() が false を返すまで1行ずつ
+    //   TRACE BEGIN <cpu_mhz> <count> <overwritten>
+    //   TRACE NAME <id> <name>
+    //   TRACE EV <16進イベント×最大6>
+    //   TRACE END
+    void beginDump();
+    bool isDumping() const { return dumping; }
+    bool nextDumpLine(char* buf, size_t size);
+
+    // シングルトンインスタンス取得
+    static TraceRecorder* getInstance() {
+        if (!instance) {
+            instance = new TraceRecorder();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define TRACE TraceRecorder::getInstance()
+
+#if TRACE_RECORDER
+#define TRACE_MARK(id, arg) TRACE->mark(TraceRecorder::id, (uint16_t)(arg))
+#else
+#define TRACE_MARK(id, arg) ((void)0)
+#endif
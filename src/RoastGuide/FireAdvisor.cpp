@@ -0,0 +1,116 @@
+#include "FireAdvisor.h"
+
+namespace {
+RoastGuide::FirePower stepDown(RoastGuide::FirePower fire) {
+    return (fire > RoastGuide::FIRE_OFF) ? (RoastGuide::FirePower)(fire - 1) : RoastGuide::FIRE_OFF;
+}
+
+RoastGuide::FirePower stepUp(RoastGuide::FirePower fire, RoastGuide::FirePower limit) {
+    return (fire < limit) ? (RoastGuide::FirePower)(fire + 1) : limit;
+}
+}  // namespace
+
+RoastGuide::FirePower FireAdvisor::recommend(const Inputs& in) {
+    const RoastGuide::RoastTarget& target = in.target;
+    RoastGuide::FirePower base_fire = target.fire;
+    float ror = in.decision_ror;
+    float ror_trend = in.ror_trend;
+
+    // Scott Rao原則：「常に下降するRoR」を維持する火力制御
+    switch (in.stage) {
+        case RoastGuide::STAGE_CHARGE:
+            // 投入段階：RoRピーク後の下降開始をサポート
+            if (ror > 18 && ror_trend > 0) {
+                base_fire = RoastGuide::FIRE_LOW;  // 早めに火力を落とす
+            } else if (ror < 10) {
+                base_fire = RoastGuide::FIRE_MEDIUM;  // 十分な熱を与える
+            }
+            break;
+
+        case RoastGuide::STAGE_DRYING:
+            // 乾燥段階：10-15°C/minを維持しつつ下降
+            if (ror > target.ror_max + 2) {
+                base_fire = stepDown(base_fire);
+            } else if (ror < target.ror_min - 2) {
+                base_fire = stepUp(base_fire, RoastGuide::FIRE_VERY_HIGH);
+            }
+            break;
+
+        case RoastGuide::STAGE_MAILLARD:
+            // メイラード段階：滑らかな下降を最優先
+            if (ror_trend > 0.5f) {  // RoRが上昇傾向
+                base_fire = stepDown(base_fire);
+            } else if (ror > target.ror_max) {
+                base_fire = RoastGuide::FIRE_VERY_LOW;  // 1ハゼ前に火力を十分下げる
+            } else if (ror < target.ror_min && in.temp < 180) {
+                base_fire = stepUp(base_fire, RoastGuide::FIRE_LOW);
+            }
+            break;
+
+        case RoastGuide::STAGE_FIRST_CRACK:
+            // 1ハゼ：クラッシュ防止とフィック回避が最優先
+            base_fire = RoastGuide::FIRE_VERY_LOW;  // 基本は極低火
+            if (ror < -1.0f) {  // 急激なクラッシュ
+                base_fire = RoastGuide::FIRE_LOW;  // 少し火力を戻す
+            } else if (ror_trend > 0.2f) {  // フィックの兆候
+                base_fire = RoastGuide::FIRE_OFF;  // 即座に火を切る
+            }
+            break;
+
+        case RoastGuide::STAGE_DEVELOPMENT:
+            // 発達段階：RoR 0に向けて緩やかに制御
+            if (ror > 3) {
+                base_fire = RoastGuide::FIRE_OFF;  // 火力を大幅削減
+            } else if (ror > 1) {
+                base_fire = RoastGuide::FIRE_VERY_LOW;
+            } else if (ror < 0.5f && in.stage_elapsed_s < target.time_min) {
+                base_fire = RoastGuide::FIRE_VERY_LOW;  // 最低限の熱は維持
+            } else {
+                base_fire = RoastGuide::FIRE_OFF;  // 基本はオフ
+            }
+            break;
+
+        case RoastGuide::STAGE_SECOND_CRACK:
+        case RoastGuide::STAGE_FINISH:
+            // 2ハゼ以降：火力オフが基本
+            base_fire = RoastGuide::FIRE_OFF;
+            break;
+
+        default:
+            // 予熱段階
+            base_fire = RoastGuide::FIRE_HIGH;
+            break;
+    }
+
+    // 温度安全措置（最優先）
+    if (in.temp > in.danger_temp - 5) {
+        base_fire = RoastGuide::FIRE_OFF;  // 危険温度接近時は火力カット
+    } else if (in.temp > target.temp_max + 3) {
+        base_fire = stepDown(base_fire);
+    }
+
+    // ヒステリシス適用（振動防止）
+    if (abs(base_fire - in.last_fire) <= 1) {
+        // 微小な変更は無視
+        if (ror >= target.ror_min - 1 &&
+            ror <= target.ror_max + 1 &&
+            abs(ror_trend) < 0.3f) {
+            return in.last_fire;
+        }
+    }
+
+    return base_fire;
+}
+
+const char* FireAdvisor::adjustmentAdvice(RoastGuide::FirePower current_fire, RoastGuide::FirePower target_fire) {
+    if (current_fire == target_fire) return "火力維持";
+
+    int diff = target_fire - current_fire;
+    switch (diff) {
+        case -2: case -3: return "すぐに弱火に！";
+        case -1: return "少し火を弱める";
+        case 1: return "少し火を強める";
+        case 2: case 3: return "すぐに火を強く！";
+        default: return "火力調整";
+    }
+}
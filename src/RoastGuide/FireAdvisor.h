@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "RoastGuide.h"
+
+/**
+ * 推奨火力の算出（表示・時計・シングルトンに依存しない純粋関数）
+ *
+ * 機能：
+ * - ステージ別ターゲットと判断用RoR・RoR傾向から火力を決定
+ * - 危険温度接近時の火力カット（最優先）
+ * - 前回推奨とのヒステリシス（振動防止）
+ * - 火力変更のアドバイス文言
+ *
+ * 入力は全て呼び出し側が渡すため、ホスト上のシミュレーションでも同じ判断を再現できる
+ */
+class FireAdvisor {
+public:
+    struct Inputs {
+        RoastGuide::RoastStage stage;
+        RoastGuide::RoastTarget target;     // 現在ステージ・レベルのターゲット
+        float temp;                         // 現在温度（°C）
+        float decision_ror;                 // 判断用の平滑化RoR（°C/min）
+        float ror_trend;                    // RoRの傾向（サンプル不足なら0）
+        float stage_elapsed_s;              // ステージ経過時間（秒）
+        float danger_temp;                  // 選択レベルの危険温度
+        RoastGuide::FirePower last_fire;    // 前回の推奨
+    };
+
+    static RoastGuide::FirePower recommend(const Inputs& in);
+
+    // 現在の火力から目標火力へのアドバイス
+    static const char* adjustmentAdvice(RoastGuide::FirePower current_fire, RoastGuide::FirePower target_fire);
+};
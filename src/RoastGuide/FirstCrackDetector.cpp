@@ -0,0 +1,64 @@
+#include "FirstCrackDetector.h"
+
+// シングルトンインスタンス
+FirstCrackDetector* FirstCrackDetector::instance = nullptr;
+
+namespace {
+
+float clamp01(float x) {
+    return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+}  // namespace
+
+void FirstCrackDetector::reset(const RoastGuide::RoastTarget& crack_target) {
+    band_min = crack_target.temp_min;
+    band_max = crack_target.temp_max;
+    armed = false;
+    expired = false;
+    ror_floor = 0.0f;
+    confidence = 0.0f;
+    peak_confidence = 0.0f;
+    detected = false;
+    pending = false;
+    detected_index = 0;
+}
+
+bool FirstCrackDetector::update(uint32_t sample_index, float temp, float ror_short, float ror_slope) {
+    if (detected || expired) return false;
+
+    // 下から帯を通り過ぎたら諦める（予熱中の高温は投入前なので数えない）
+    if (temp > band_max + BAND_LEAD) {
+        if (armed) expired = true;
+        confidence = 0.0f;
+        return false;
+    }
+
+    // 帯の手前からRoRの谷を追う（予熱から投入で下がった分・転換点からの上昇は拾わない）
+    if (temp < band_min - ARM_LEAD) {
+        armed = false;
+        confidence = 0.0f;
+        return false;
+    }
+    if (!armed) {
+        armed = true;
+        ror_floor = ror_short;
+    }
+    if (ror_short < ror_floor) ror_floor = ror_short;
+
+    float band = clamp01((temp - (band_min - BAND_LEAD)) / BAND_LEAD);
+    float rise = clamp01((ror_short - ror_floor) / RISE_FULL);
+    float slope = clamp01(ror_slope / SLOPE_FULL);
+    float score = band * rise * slope;
+
+    confidence += (score - confidence) * SMOOTHING;
+    if (confidence > peak_confidence) peak_confidence = confidence;
+
+    if (confidence >= CONFIRM_THRESHOLD) {
+        detected = true;
+        pending = true;
+        detected_index = sample_index;
+        return true;
+    }
+    return false;
+}
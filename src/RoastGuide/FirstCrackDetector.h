@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "RoastGuide.h"
+
+/**
+ * 1ハゼの自動検出（RoRの形から、サンプルごとにO(1)）
+ *
+ * 機能：
+ * - 1ハゼ直前の発熱反応で、下がり続けていたRoRが谷から跳ね上がる形を検出
+ *   （谷は帯の下限の ARM_LEAD 手前から追う、それより下がれば追い直し）
+ * - サンプルごとに 0〜1 の確からしさを算出：
+ *   温度帯（1ハゼターゲットの下限の BAND_LEAD 手前から）× 谷からのRoR上昇 × RoRの傾き（RoR-of-RoR）
+ * - 確からしさを平滑化し、CONFIRM_THRESHOLD を超えたサンプルで1回だけ検出
+ * - 帯を下から通り過ぎ、上限を BAND_LEAD 以上超えても検出しなければ諦める（2ハゼ域で誤検出しない）
+ * - 検出はガイドが受け付けるまで保留（ガイドのステージ判定が遅れていても捨てない）
+ *
+ * 入力は呼び出し側が渡す（ホストの評価ハーネスでも記録済みの焙煎で同じ判定を再現できる）
+ */
+class FirstCrackDetector {
+public:
+    static constexpr float BAND_LEAD = 8.0f;            // 帯の下限のこれだけ手前から評価（°C）
+    static constexpr float ARM_LEAD = 2 * BAND_LEAD;    // RoRの谷の追跡を始める温度（帯の下限から）
+    static constexpr float RISE_FULL = 4.0f;            // 谷からのRoR上昇（°C/min）で満点
+    static constexpr float SLOPE_FULL = 4.0f;           // RoR-of-RoR（°C/min²）で満点
+    static constexpr float SMOOTHING = 0.4f;            // 確からしさの指数平滑係数
+    static constexpr float CONFIRM_THRESHOLD = 0.75f;
+
+private:
+    float band_min = 195.0f;
+    float band_max = 205.0f;
+    bool armed = false;
+    bool expired = false;
+    float ror_floor = 0.0f;         // 追跡開始後の短窓RoRの最小値（谷）
+    float confidence = 0.0f;
+    float peak_confidence = 0.0f;
+    bool detected = false;
+    bool pending = false;           // 検出済みでガイドが未受理
+    uint32_t detected_index = 0;
+
+    // シングルトン
+    static FirstCrackDetector* instance;
+
+public:
+    FirstCrackDetector() {}
+
+    // 焙煎開始時：1ハゼステージのターゲット（選択レベル）の温度帯で初期化
+    void reset(const RoastGuide::RoastTarget& crack_target);
+
+    // サンプルごと：ror_short は短窓（15秒）RoR、ror_slope はその傾き（°C/min²）
+    // 検出したサンプルでのみ true
+    bool update(uint32_t sample_index, float temp, float ror_short, float ror_slope);
+
+    float getConfidence() const { return confidence; }
+    float getPeakConfidence() const { return peak_confidence; }
+    bool isDetected() const { return detected; }
+    bool isPending() const { return pending; }
+    void clearPending() { pending = false; }    // ガイドが受け付けた、または受け付けられなくなった
+    uint32_t getDetectedIndex() const { return detected_index; }
+
+    // シングルトンインスタンス取得
+    static FirstCrackDetector* getInstance() {
+        if (!instance) {
+            instance = new FirstCrackDetector();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define CRACK_DETECTOR FirstCrackDetector::getInstance()
@@ -0,0 +1,83 @@
+#include "PhaseMetrics.h"
+#include "RoastGuide.h"
+
+void PhaseMetrics::reset() {
+    *this = PhaseMetrics();
+}
+
+void PhaseMetrics::onStage(uint8_t stage, uint32_t ms) {
+    if (dropped) return;
+
+    switch (stage) {
+        case RoastGuide::STAGE_CHARGE:
+            if (isCharged()) return;
+            charge_ms = ms;
+            last_ms = ms;
+            last_temp = NAN;    // 面積は投入から
+            phase = PHASE_DRYING;
+            phase_start_ms[PHASE_DRYING] = ms;
+            break;
+        case RoastGuide::STAGE_MAILLARD:
+            enterPhase(PHASE_MAILLARD, ms);
+            break;
+        case RoastGuide::STAGE_FIRST_CRACK:
+            enterPhase(PHASE_DEVELOPMENT, ms);
+            break;
+        case RoastGuide::STAGE_FINISH:
+            if (!isCharged()) return;
+            if (ms > last_ms) last_ms = ms;
+            phase_ms[phase] = last_ms - phase_start_ms[phase];
+            dropped = true;
+            break;
+        default:
+            break;
+    }
+}
+
+// 飛ばしたフェーズ（乾燥から直接1ハゼなど）は0秒のまま
+void PhaseMetrics::enterPhase(Phase next, uint32_t ms) {
+    if (!isCharged() || next <= phase) return;
+    phase_ms[phase] = ms - phase_start_ms[phase];
+    for (uint8_t p = phase + 1; p <= next; p++) phase_start_ms[p] = ms;
+    phase = next;
+}
+
+void PhaseMetrics::onTurningPoint(uint32_t ms) {
+    if (has_turning_point) return;
+    has_turning_point = true;
+    turning_ms = ms;
+}
+
+void PhaseMetrics::update(uint32_t ms, float temp) {
+    if (!isCharged() || dropped || isnan(temp)) return;
+
+    // 前のサンプルからの区間は今のフェーズに入れる
+    if (!isnan(last_temp) && ms > last_ms) {
+        float a = last_temp > AUC_BASE_TEMP ? last_temp - AUC_BASE_TEMP : 0.0f;
+        float b = temp > AUC_BASE_TEMP ? temp - AUC_BASE_TEMP : 0.0f;
+        auc[phase] += (a + b) * 0.5f * (ms - last_ms) / 60000.0f;
+    }
+    if (ms > last_ms) last_ms = ms;
+    last_temp = temp;
+    phase_ms[phase] = last_ms - phase_start_ms[phase];
+}
+
+float PhaseMetrics::getPhasePercent(Phase p) const {
+    uint32_t total = last_ms - charge_ms;
+    if (!isCharged() || total == 0) return 0.0f;
+    return phase_ms[p] * 100.0f / total;
+}
+
+float PhaseMetrics::getSinceTurningPoint() const {
+    if (!has_turning_point) return -1.0f;
+    return ((int32_t)(last_ms - turning_ms)) / 1000.0f;
+}
+
+const char* PhaseMetrics::getPhaseName(Phase p) {
+    switch (p) {
+        case PHASE_DRYING: return "Drying";
+        case PHASE_MAILLARD: return "Maillard";
+        case PHASE_DEVELOPMENT: return "Development";
+        default: return "Unknown";
+    }
+}
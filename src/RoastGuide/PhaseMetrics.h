@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+
+/**
+ * 焙煎フェーズの集計（乾燥・メイラード・発達、サンプルごとにO(1)）
+ *
+ * 機能：
+ * - ステージ移行をフェーズの区切りとして使う
+ *   （投入 → 乾燥、メイラード入り → メイラード、1ハゼ入り → 発達、排出で確定）
+ * - フェーズごとの時間と投入からの割合、DTR（発達時間比 = 発達 / 投入からの全体）
+ * - 転換点からの経過時間
+ * - フェーズごとの温度曲線の面積（AUC、AUC_BASE_TEMP より上、°C·分、台形則）
+ *
+ * 時刻は呼び出し側の基準のミリ秒（ガイドは開始からの経過、ジャーナルはサンプル番号×周期）
+ */
+class PhaseMetrics {
+public:
+    enum Phase : uint8_t {
+        PHASE_DRYING = 0,
+        PHASE_MAILLARD = 1,
+        PHASE_DEVELOPMENT = 2,
+        PHASE_COUNT = 3
+    };
+
+    static constexpr uint8_t NO_PHASE = 0xFF;           // 投入前
+    static constexpr float AUC_BASE_TEMP = 100.0f;      // AUCの基準温度（°C）
+
+private:
+    uint8_t phase = NO_PHASE;
+    bool dropped = false;
+    bool has_turning_point = false;
+    uint32_t charge_ms = 0;
+    uint32_t turning_ms = 0;
+    uint32_t phase_start_ms[PHASE_COUNT] = {};
+    uint32_t phase_ms[PHASE_COUNT] = {};
+    uint32_t last_ms = 0;               // 最後のサンプル（排出後は排出時刻）
+    float last_temp = NAN;
+    float auc[PHASE_COUNT] = {};        // °C·分
+
+    void enterPhase(Phase next, uint32_t ms);
+
+public:
+    void reset();
+
+    // ステージ移行（stage は RoastGuide::RoastStage）
+    void onStage(uint8_t stage, uint32_t ms);
+    void onTurningPoint(uint32_t ms);
+
+    // サンプルごと：現在のフェーズの時間とAUCを伸ばす（センサーエラーのサンプルは渡さない）
+    void update(uint32_t ms, float temp);
+
+    bool isCharged() const { return phase != NO_PHASE; }
+    bool isDropped() const { return dropped; }
+    uint8_t getPhase() const { return phase; }
+    uint32_t getChargeMs() const { return charge_ms; }
+
+    float getPhaseSeconds(Phase p) const { return phase_ms[p] / 1000.0f; }
+    float getTotalSeconds() const { return isCharged() ? (last_ms - charge_ms) / 1000.0f : 0.0f; }
+    float getPhasePercent(Phase p) const;
+    float getDTR() const { return getPhasePercent(PHASE_DEVELOPMENT); }
+    float getSinceTurningPoint() const;  // 秒、転換点前は負
+    float getAUC(Phase p) const { return auc[p]; }
+
+    static const char* getPhaseName(Phase p);
+};
@@ -1,5 +1,7 @@
 #include "RoastGuide.h"
-#include <Arduino.h>
+#include "../HAL/Clock.h"
+#include "../HAL/Display.h"
+#include "../Profiling/TraceRecorder.h"
 
 // シングルトンインスタンス
 RoastGuide* RoastGuide::instance = nullptr;
@@ -23,6 +25,161 @@ constexpr float CRITICAL_TEMPS[RoastGuide::ROAST_COUNT] = {
   280.0f   // ROAST_FRENCH（深煎り用）
 };
 
+// 転換点：投入時より MIN_DROP 以上下がった最低温度から RISE 上昇したら確定
+constexpr float TURNING_POINT_RISE = 1.0f;
+constexpr float TURNING_POINT_MIN_DROP = 5.0f;
+
+namespace {
+
+/**
+ * ステージ遷移表
+ *
+ * 現在ステージの行を上から評価し、条件（guards）を全て満たした最初の行で移行する
+ * ACT_REQUEST_CONFIRM の行は移行せずに1ハゼ確認を促し、続く行も評価する
+ * ターゲット参照（REF_*）は現在ステージ・焙煎レベルの値（ステージ移行時にキャッシュ済み）
+ */
+enum GuardInput : uint8_t {
+    IN_TEMP,            // 豆温度
+    IN_ROR,             // 判断用RoR
+    IN_STAGE_S,         // ステージ経過秒
+    IN_TOTAL_S,         // ガイド開始からの経過秒（整数）
+    IN_DTR,             // 発達時間比 %（ステージ経過 / ガイド開始から、遷移の判定用で PhaseMetrics の DTR とは別）
+    IN_LEVEL,           // 焙煎レベル
+    IN_CRACK_CONFIRMED  // 1ハゼ確認済み（0 / 1）
+};
+
+enum GuardOp : uint8_t { OP_GE, OP_GT, OP_LE, OP_LT };
+
+enum GuardRef : uint8_t {
+    REF_CONST,          // value
+    REF_TIME_MIN,
+    REF_TIME_MAX,
+    REF_TEMP_MAX,
+    REF_CRITICAL_TEMP
+};
+
+struct Guard {
+    GuardInput input;
+    GuardOp op;
+    GuardRef ref;
+    float value;
+};
+
+enum Action : uint8_t {
+    ACT_ENTER,              // to へ移行
+    ACT_ENTER_CRACK,        // to へ移行し1ハゼ検出済みとする
+    ACT_REQUEST_CONFIRM     // 1ハゼ確認を促す（移行しない）
+};
+
+constexpr uint8_t MAX_GUARDS = 5;
+
+struct Transition {
+    RoastGuide::RoastStage from;
+    RoastGuide::RoastStage to;
+    Action action;
+    uint8_t guard_count;
+    Guard guards[MAX_GUARDS];
+};
+
+constexpr Guard at(GuardInput input, GuardOp op, float value) { return {input, op, REF_CONST, value}; }
+constexpr Guard ref(GuardInput input, GuardOp op, GuardRef r) { return {input, op, r, 0.0f}; }
+
+// Scott Rao氏のガイドラインに基づく段階判定
+constexpr Transition TRANSITIONS[] = {
+    // 予熱完了：温度条件または時間経過で投入段階へ
+    {RoastGuide::STAGE_PREHEAT, RoastGuide::STAGE_CHARGE, ACT_ENTER, 2,
+     {at(IN_TEMP, OP_GE, 180), at(IN_TEMP, OP_LE, 200)}},
+    {RoastGuide::STAGE_PREHEAT, RoastGuide::STAGE_CHARGE, ACT_ENTER, 1,
+     {at(IN_STAGE_S, OP_GT, 300)}},
+
+    // 投入：2分以降RoRが戻れば乾燥へ（3分で強制移行）
+    {RoastGuide::STAGE_CHARGE, RoastGuide::STAGE_DRYING, ACT_ENTER, 2,
+     {at(IN_STAGE_S, OP_GT, 120), at(IN_ROR, OP_GT, 8)}},
+    {RoastGuide::STAGE_CHARGE, RoastGuide::STAGE_DRYING, ACT_ENTER, 1,
+     {at(IN_STAGE_S, OP_GT, 180)}},
+
+    // 乾燥：150°C到達かつ適正時間経過（最低4分は乾燥、SCAガイドライン）、または最大時間超過
+    {RoastGuide::STAGE_DRYING, RoastGuide::STAGE_MAILLARD, ACT_ENTER, 3,
+     {at(IN_TEMP, OP_GE, 150), ref(IN_STAGE_S, OP_GE, REF_TIME_MIN), at(IN_TOTAL_S, OP_GT, 240)}},
+    {RoastGuide::STAGE_DRYING, RoastGuide::STAGE_MAILLARD, ACT_ENTER, 1,
+     {ref(IN_STAGE_S, OP_GT, REF_TIME_MAX)}},
+
+    // メイラード：190°C以上でRoRが下降中なら1ハゼ待ち（195°Cで確認を促す）
+    {RoastGuide::STAGE_MAILLARD, RoastGuide::STAGE_MAILLARD, ACT_REQUEST_CONFIRM, 4,
+     {at(IN_TEMP, OP_GE, 195), at(IN_ROR, OP_LE, 8), ref(IN_STAGE_S, OP_GE, REF_TIME_MIN),
+      at(IN_CRACK_CONFIRMED, OP_LT, 1)}},
+    {RoastGuide::STAGE_MAILLARD, RoastGuide::STAGE_FIRST_CRACK, ACT_ENTER_CRACK, 4,
+     {at(IN_TEMP, OP_GE, 190), at(IN_ROR, OP_LE, 8), ref(IN_STAGE_S, OP_GE, REF_TIME_MIN),
+      at(IN_CRACK_CONFIRMED, OP_GE, 1)}},
+    {RoastGuide::STAGE_MAILLARD, RoastGuide::STAGE_FIRST_CRACK, ACT_ENTER_CRACK, 3,
+     {at(IN_TEMP, OP_GE, 200), at(IN_ROR, OP_LE, 5), ref(IN_STAGE_S, OP_GE, REF_TIME_MIN)}},
+    {RoastGuide::STAGE_MAILLARD, RoastGuide::STAGE_FIRST_CRACK, ACT_ENTER, 1,
+     {ref(IN_STAGE_S, OP_GT, REF_TIME_MAX)}},
+
+    // 1ハゼ：最低時間または2分で発達段階へ
+    {RoastGuide::STAGE_FIRST_CRACK, RoastGuide::STAGE_DEVELOPMENT, ACT_ENTER, 1,
+     {ref(IN_STAGE_S, OP_GE, REF_TIME_MIN)}},
+    {RoastGuide::STAGE_FIRST_CRACK, RoastGuide::STAGE_DEVELOPMENT, ACT_ENTER, 1,
+     {at(IN_STAGE_S, OP_GE, 120)}},
+
+    // 発達：臨界温度で即排出。DTR 15%以上で目標温度、または DTR 25%で
+    // 中深煎り以上かつ220°C以上なら2ハゼへ、それ以外は排出
+    {RoastGuide::STAGE_DEVELOPMENT, RoastGuide::STAGE_FINISH, ACT_ENTER, 1,
+     {ref(IN_TEMP, OP_GE, REF_CRITICAL_TEMP)}},
+    {RoastGuide::STAGE_DEVELOPMENT, RoastGuide::STAGE_SECOND_CRACK, ACT_ENTER, 5,
+     {ref(IN_STAGE_S, OP_GE, REF_TIME_MIN), ref(IN_TEMP, OP_GE, REF_TEMP_MAX), at(IN_DTR, OP_GE, 15),
+      at(IN_LEVEL, OP_GE, RoastGuide::ROAST_MEDIUM_DARK), at(IN_TEMP, OP_GE, 220)}},
+    {RoastGuide::STAGE_DEVELOPMENT, RoastGuide::STAGE_SECOND_CRACK, ACT_ENTER, 3,
+     {at(IN_DTR, OP_GE, 25), at(IN_LEVEL, OP_GE, RoastGuide::ROAST_MEDIUM_DARK), at(IN_TEMP, OP_GE, 220)}},
+    {RoastGuide::STAGE_DEVELOPMENT, RoastGuide::STAGE_FINISH, ACT_ENTER, 3,
+     {ref(IN_STAGE_S, OP_GE, REF_TIME_MIN), ref(IN_TEMP, OP_GE, REF_TEMP_MAX), at(IN_DTR, OP_GE, 15)}},
+    {RoastGuide::STAGE_DEVELOPMENT, RoastGuide::STAGE_FINISH, ACT_ENTER, 1,
+     {at(IN_DTR, OP_GE, 25)}},
+
+    // 2ハゼ：時間と温度の両方、または臨界温度で排出
+    {RoastGuide::STAGE_SECOND_CRACK, RoastGuide::STAGE_FINISH, ACT_ENTER, 2,
+     {ref(IN_STAGE_S, OP_GE, REF_TIME_MIN), ref(IN_TEMP, OP_GE, REF_TEMP_MAX)}},
+    {RoastGuide::STAGE_SECOND_CRACK, RoastGuide::STAGE_FINISH, ACT_ENTER, 1,
+     {ref(IN_TEMP, OP_GE, REF_CRITICAL_TEMP)}},
+
+    // 排出段階は手動でリセット（行なし）
+};
+
+constexpr uint8_t TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+
+// ステージ移行で記録するイベント
+constexpr int8_t STAGE_EVENTS[RoastGuide::STAGE_COUNT] = {
+    -1,                             // STAGE_PREHEAT
+    RoastGuide::EVENT_CHARGE,       // STAGE_CHARGE
+    -1,                             // STAGE_DRYING
+    RoastGuide::EVENT_DRY_END,      // STAGE_MAILLARD
+    RoastGuide::EVENT_FIRST_CRACK,  // STAGE_FIRST_CRACK
+    -1,                             // STAGE_DEVELOPMENT
+    -1,                             // STAGE_SECOND_CRACK
+    RoastGuide::EVENT_DROP          // STAGE_FINISH
+};
+
+bool checkGuard(const Guard& guard, const float* inputs, const RoastGuide::RoastTarget& target,
+                float critical_temp) {
+    float limit;
+    switch (guard.ref) {
+        case REF_TIME_MIN: limit = target.time_min; break;
+        case REF_TIME_MAX: limit = target.time_max; break;
+        case REF_TEMP_MAX: limit = target.temp_max; break;
+        case REF_CRITICAL_TEMP: limit = critical_temp; break;
+        default: limit = guard.value; break;
+    }
+    float value = inputs[guard.input];
+    switch (guard.op) {
+        case OP_GE: return value >= limit;
+        case OP_GT: return value > limit;
+        case OP_LE: return value <= limit;
+        default: return value < limit;
+    }
+}
+
+}  // namespace
+
 // コンストラクタ
 RoastGuide::RoastGuide() {
     active = false;
@@ -39,6 +196,8 @@ RoastGuide::RoastGuide() {
     first_crack_time = 0;
     adherence_score = 100.0f;
     off_target_count = 0;
+    current_target = getRoastTarget(current_stage, selected_level);
+    clearEvents();
 }
 
 // デストラクタ
@@ -51,12 +210,17 @@ void RoastGuide::begin() {
 }
 
 // ガイド開始
-void RoastGuide::start(RoastLevel level) {
+void RoastGuide::start(RoastLevel level, uint32_t now_ms) {
     active = true;
     selected_level = level;
     current_stage = STAGE_PREHEAT;
-    roast_start_time = millis();
-    stage_start_time = millis();
+    current_target = getRoastTarget(current_stage, selected_level);
+    clock_ms = now_ms;
+    roast_start_time = now_ms;
+    stage_start_time = now_ms;
+    roast_started = true;
+    clearEvents();
+    stage_entries[STAGE_PREHEAT].elapsed_ms = 0;
     stall_detected = false;
     first_crack_detected = false;
     first_crack_confirmation_needed = false;
@@ -68,26 +232,37 @@ void RoastGuide::start(RoastLevel level) {
 void RoastGuide::stop() {
     active = false;
     current_stage = STAGE_PREHEAT;
+    current_target = getRoastTarget(current_stage, selected_level);
+}
+
+void RoastGuide::setSelectedLevel(RoastLevel level) {
+    if (level >= ROAST_COUNT) return;
+    selected_level = level;
+    current_target = getRoastTarget(current_stage, selected_level);
 }
 
 // 状態更新
-void RoastGuide::update(float current_temp, float current_ror) {
+void RoastGuide::update(uint32_t sample_index, uint32_t now_ms, float current_temp, float current_ror) {
     if (!active) return;
     
     // ストール検出
-    checkStallCondition(current_temp, current_ror);
+    checkStallCondition(now_ms, current_temp, current_ror);
     
     // ステージ進行更新
-    updateStageProgression(current_temp, current_ror);
+    updateStageProgression(sample_index, current_temp, current_ror);
+    updateTurningPoint(sample_index, current_temp);
+    phases.update(clock_ms - roast_start_time, current_temp);
     
     // 遵守度評価
     evaluateAdherence(current_temp, current_ror);
 }
 
 // ストール検出
-void RoastGuide::checkStallCondition(float current_temp, float current_ror) {
-    uint32_t now = millis();
-    if (!active || (now - last_stall_check) < 5000) {
+void RoastGuide::checkStallCondition(uint32_t now_ms, float current_temp, float current_ror) {
+    if (!active) return;
+    clock_ms = now_ms;
+    uint32_t now = now_ms;
+    if ((now - last_stall_check) < 5000) {
         return; // 5秒ごとにチェック
     }
     
@@ -110,7 +285,55 @@ void RoastGuide::confirmFirstCrack() {
     if (first_crack_confirmation_needed) {
         first_crack_detected = true;
         first_crack_confirmation_needed = false;
-        first_crack_time = millis();
+        first_crack_time = clock_ms;
+    }
+}
+
+bool RoastGuide::autoConfirmFirstCrack() {
+    if (!active || current_stage != STAGE_MAILLARD || first_crack_detected) return false;
+    first_crack_detected = true;
+    first_crack_confirmation_needed = false;
+    first_crack_time = clock_ms;
+    return true;
+}
+
+bool RoastGuide::forceNextStage(uint32_t sample_index, float current_temp) {
+    if (!active || current_stage >= STAGE_FINISH) return false;
+    
+    // 発達の次は2ハゼ（中深煎り以上）か排出
+    RoastStage next = (RoastStage)(current_stage + 1);
+    if (current_stage == STAGE_DEVELOPMENT && selected_level < ROAST_MEDIUM_DARK) {
+        next = STAGE_FINISH;
+    }
+    // 1ハゼへの手動送りは操作者の確認として扱う
+    if (next == STAGE_FIRST_CRACK && !first_crack_detected) {
+        first_crack_detected = true;
+        first_crack_confirmation_needed = false;
+        first_crack_time = clock_ms;
+    }
+    enterStage(next, sample_index, current_temp);
+    return true;
+}
+
+// 経過時間（停止後も最後の焙煎の値）
+uint32_t RoastGuide::getRoastElapsedTime() const {
+    if (!roast_started) return 0;
+    return (clock_ms - roast_start_time) / 1000;  // unsigned減算でオーバーフロー安全
+}
+
+float RoastGuide::getStageElapsedTime() const {
+    if (!roast_started) return 0;
+    return (clock_ms - stage_start_time) / 1000.0f;
+}
+
+const char* RoastGuide::getEventName(EventType type) {
+    switch (type) {
+        case EVENT_CHARGE: return "charge";
+        case EVENT_TURNING_POINT: return "turning point";
+        case EVENT_DRY_END: return "dry end";
+        case EVENT_FIRST_CRACK: return "first crack";
+        case EVENT_DROP: return "drop";
+        default: return "unknown";
     }
 }
 
@@ -214,7 +437,7 @@ float RoastGuide::getCriticalTemp(RoastLevel level) const {
 
 // レベル変更
 void RoastGuide::cycleRoastLevel() {
-    selected_level = (RoastLevel)((selected_level + 1) % ROAST_COUNT);
+    setSelectedLevel((RoastLevel)((selected_level + 1) % ROAST_COUNT));
 }
 
 // ステージ名取得
@@ -260,165 +483,110 @@ uint32_t RoastGuide::getStageColor(RoastStage stage) const {
     }
 }
 
-// ステージ進行更新
-void RoastGuide::updateStageProgression(float current_temp, float current_ror) {
+// ステージ進行更新（遷移表の評価）
+void RoastGuide::updateStageProgression(uint32_t sample_index, float current_temp, float current_ror) {
     if (!active) return;
     
-    uint32_t now = millis();
+    uint32_t now = clock_ms;
     uint32_t total_elapsed = (now - roast_start_time) / 1000;
     float stage_elapsed = (now - stage_start_time) / 1000.0f;
-    RoastStage prev_stage = current_stage;
-    RoastTarget current_target = getRoastTarget(current_stage, selected_level);
     
-    // Scott Rao氏のガイドラインに基づく段階判定ロジック
-    switch(current_stage) {
-        case STAGE_PREHEAT:
-            // 予熱完了：温度条件またはユーザー操作で投入段階へ
-            if ((current_temp >= 180 && current_temp <= 200) || stage_elapsed > 300) {
-                current_stage = STAGE_CHARGE;
-                stage_start_time = now;
-            }
-            break;
-            
-        case STAGE_CHARGE:
-            {
-                // 転換点検出または時間経過で次段階へ
-                bool min_time_met = (stage_elapsed > 90);  // 最低1.5分は投入段階維持
-                bool backup_condition = (stage_elapsed > 120 && current_ror > 8);  // 予備条件
-                
-                if (min_time_met && backup_condition) {
-                    current_stage = STAGE_DRYING;
-                    stage_start_time = now;
-                }
-                // 安全措置：3分経過で強制移行
-                else if (stage_elapsed > 180) {
-                    current_stage = STAGE_DRYING;
-                    stage_start_time = now;
-                }
-            }
-            break;
-            
-        case STAGE_DRYING:
-            {
-                // 乾燥フェーズ：温度150°C到達かつ適正時間経過
-                bool temp_reached = (current_temp >= 150);
-                bool min_time_met = (stage_elapsed >= current_target.time_min);
-                bool max_time_exceeded = (stage_elapsed > current_target.time_max);
-                
-                // 全体時間の30-40%経過も考慮（SCAガイドライン）
-                bool time_ratio_ok = (total_elapsed > 240);  // 最低4分は乾燥
-                
-                if ((temp_reached && min_time_met && time_ratio_ok) || max_time_exceeded) {
-                    current_stage = STAGE_MAILLARD;
-                    stage_start_time = now;
-                }
-            }
-            break;
-            
-        case STAGE_MAILLARD:
-            {
-                // メイラード反応：190-200°C近辺でRoRが5°C/min以下
-                bool temp_threshold = (current_temp >= 190);
-                bool ror_controlled = (current_ror <= 8);  // まだ下降中
-                bool min_time_met = (stage_elapsed >= current_target.time_min);
-                
-                // 1ハゼ検出のための条件
-                if (temp_threshold && ror_controlled && min_time_met) {
-                    if (!first_crack_detected && current_temp >= 195) {
-                        first_crack_confirmation_needed = true;
-                    }
-                    
-                    // 自動移行または手動確認
-                    if (first_crack_detected || (current_temp >= 200 && current_ror <= 5)) {
-                        current_stage = STAGE_FIRST_CRACK;
-                        stage_start_time = now;
-                        first_crack_detected = true;
-                        first_crack_time = now;
-                    }
-                }
-                
-                // 最大時間超過で強制移行
-                if (stage_elapsed > current_target.time_max) {
-                    current_stage = STAGE_FIRST_CRACK;
-                    stage_start_time = now;
-                }
-            }
-            break;
-            
-        case STAGE_FIRST_CRACK:
-            {
-                // 1ハゼ終了判定：RoR谷を超えて回復開始
-                bool min_time_met = (stage_elapsed >= current_target.time_min);
-                bool max_time_reached = (stage_elapsed >= 120);
-                
-                if (min_time_met || max_time_reached) {
-                    current_stage = STAGE_DEVELOPMENT;
-                    stage_start_time = now;
-                }
-            }
-            break;
-            
-        case STAGE_DEVELOPMENT:
-            {
-                RoastTarget dev_target = getRoastTarget(STAGE_DEVELOPMENT, selected_level);
-                
-                // DTR計算（Development Time Ratio）
-                float total_time_so_far = total_elapsed;
-                float dev_time = stage_elapsed;
-                float current_dtr = (dev_time / total_time_so_far) * 100.0f;
-                
-                // 条件判定
-                bool min_time_met = (dev_time >= dev_target.time_min);
-                bool temp_target_reached = (current_temp >= dev_target.temp_max);
-                bool dtr_sufficient = (current_dtr >= 15.0f);  // 最低15%のDTR
-                bool max_dtr_exceeded = (current_dtr >= 25.0f); // 最大25%のDTR
-                
-                // 深煎り判定：2ハゼ域に進むか終了か
-                if ((min_time_met && temp_target_reached && dtr_sufficient) || max_dtr_exceeded) {
-                    if (selected_level >= ROAST_MEDIUM_DARK && current_temp >= 220) {
-                        current_stage = STAGE_SECOND_CRACK;
-                        stage_start_time = now;
-                    } else {
-                        current_stage = STAGE_FINISH;
-                        stage_start_time = now;
-                    }
-                }
-                
-                // 緊急停止条件
-                if (current_temp >= getCriticalTemp(selected_level)) {
-                    current_stage = STAGE_FINISH;
-                    stage_start_time = now;
-                }
-            }
-            break;
-            
-        case STAGE_SECOND_CRACK:
-            {
-                RoastTarget sc_target = getRoastTarget(STAGE_SECOND_CRACK, selected_level);
-                
-                // 2ハゼ：時間と温度の両方で判定
-                bool min_time_met = (stage_elapsed >= sc_target.time_min);
-                bool temp_target_reached = (current_temp >= sc_target.temp_max);
-                bool critical_temp_reached = (current_temp >= getCriticalTemp(selected_level));
-                
-                if ((min_time_met && temp_target_reached) || critical_temp_reached) {
-                    current_stage = STAGE_FINISH;
-                    stage_start_time = now;
-                }
-            }
-            break;
-            
-        case STAGE_FINISH:
-            // 排出段階、手動でリセット
-            break;
+    float inputs[IN_CRACK_CONFIRMED + 1];
+    inputs[IN_TEMP] = current_temp;
+    inputs[IN_ROR] = current_ror;
+    inputs[IN_STAGE_S] = stage_elapsed;
+    inputs[IN_TOTAL_S] = (float)total_elapsed;
+    inputs[IN_DTR] = total_elapsed > 0 ? stage_elapsed / total_elapsed * 100.0f : 0.0f;
+    inputs[IN_LEVEL] = (float)selected_level;
+    inputs[IN_CRACK_CONFIRMED] = first_crack_detected ? 1.0f : 0.0f;
+    float critical_temp = getCriticalTemp(selected_level);
+    
+    for (uint8_t i = 0; i < TRANSITION_COUNT; i++) {
+        const Transition& row = TRANSITIONS[i];
+        if (row.from != current_stage) continue;
+        
+        bool pass = true;
+        for (uint8_t g = 0; g < row.guard_count && pass; g++) {
+            pass = checkGuard(row.guards[g], inputs, current_target, critical_temp);
+        }
+        if (!pass) continue;
+        
+        if (row.action == ACT_REQUEST_CONFIRM) {
+            first_crack_confirmation_needed = true;
+            continue;
+        }
+        if (row.action == ACT_ENTER_CRACK) {
+            first_crack_detected = true;
+            first_crack_time = now;
+        }
+        enterStage(row.to, sample_index, current_temp);
+        return;
+    }
+}
+
+// ステージ移行：ターゲットのキャッシュとイベント記録
+void RoastGuide::enterStage(RoastStage stage, uint32_t sample_index, float current_temp) {
+    current_stage = stage;
+    stage_start_time = clock_ms;
+    current_target = getRoastTarget(current_stage, selected_level);
+    TRACE_MARK(MARK_STAGE_CHANGE, current_stage);
+    
+    Event& entry = stage_entries[stage];
+    entry.sample_index = sample_index;
+    entry.elapsed_ms = stage_start_time - roast_start_time;
+    entry.temp = current_temp;
+    phases.onStage(stage, entry.elapsed_ms);
+    
+    if (stage == STAGE_CHARGE) {
+        charge_temp = current_temp;
+    }
+    if (STAGE_EVENTS[stage] >= 0) {
+        recordEvent((EventType)STAGE_EVENTS[stage], sample_index, current_temp);
     }
 }
 
+void RoastGuide::recordEvent(EventType type, uint32_t sample_index, float current_temp) {
+    if (hasEvent(type)) return;
+    events[type].sample_index = sample_index;
+    events[type].elapsed_ms = clock_ms - roast_start_time;
+    events[type].temp = current_temp;
+    M5_LOGI("Roast event: %s at sample %lu (%.1fC)", getEventName(type),
+            (unsigned long)sample_index, current_temp);
+}
+
+// 転換点：投入後の最低温度を追い、十分に上昇したらその最低点のサンプルを記録
+void RoastGuide::updateTurningPoint(uint32_t sample_index, float current_temp) {
+    if (!hasEvent(EVENT_CHARGE) || hasEvent(EVENT_TURNING_POINT)) return;
+    
+    if (turning_candidate.sample_index == NO_SAMPLE || current_temp < turning_candidate.temp) {
+        turning_candidate.sample_index = sample_index;
+        turning_candidate.elapsed_ms = clock_ms - roast_start_time;
+        turning_candidate.temp = current_temp;
+        return;
+    }
+    if (current_temp >= turning_candidate.temp + TURNING_POINT_RISE &&
+        turning_candidate.temp <= charge_temp - TURNING_POINT_MIN_DROP) {
+        events[EVENT_TURNING_POINT] = turning_candidate;
+        phases.onTurningPoint(turning_candidate.elapsed_ms);
+        M5_LOGI("Roast event: %s at sample %lu (%.1fC)", getEventName(EVENT_TURNING_POINT),
+                (unsigned long)turning_candidate.sample_index, turning_candidate.temp);
+    }
+}
+
+void RoastGuide::clearEvents() {
+    Event none = {NO_SAMPLE, 0, 0.0f};
+    for (uint8_t i = 0; i < EVENT_COUNT; i++) events[i] = none;
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) stage_entries[i] = none;
+    turning_candidate = none;
+    charge_temp = 0;
+    phases.reset();
+}
+
 // 遵守度評価
 void RoastGuide::evaluateAdherence(float current_temp, float current_ror) {
     if (!active || current_stage == STAGE_PREHEAT || current_stage == STAGE_FINISH) return;
     
-    RoastTarget target = getRoastTarget(current_stage, selected_level);
+    const RoastTarget& target = current_target;
     
     // 温度とRoRの目標範囲からの逸脱をチェック
     bool temp_off = (current_temp < target.temp_min || current_temp > target.temp_max);
@@ -457,89 +625,89 @@ void RoastGuide::draw(float current_temp, float current_ror,
 // ステージインジケーター描画
 void RoastGuide::drawStageIndicator(int x, int y, int width, int height) {
     // プログレスバー背景
-    M5.Lcd.fillRect(x, y, width, height, TFT_BLACK);
-    M5.Lcd.drawRect(x, y, width, height, TFT_WHITE);
+    HAL_DISPLAY.fillRect(x, y, width, height, TFT_BLACK);
+    HAL_DISPLAY.drawRect(x, y, width, height, TFT_WHITE);
     
     // 各ステージのセグメント
     int segment_width = width / 8;
     for (int i = 0; i < 8; i++) {
         int seg_x = x + i * segment_width;
         uint32_t color = (i <= current_stage) ? getStageColor((RoastStage)i) : TFT_DARKGREY;
-        M5.Lcd.fillRect(seg_x + 1, y + 1, segment_width - 2, height - 2, color);
+        HAL_DISPLAY.fillRect(seg_x + 1, y + 1, segment_width - 2, height - 2, color);
         
         // ステージ区切り線
         if (i > 0) {
-            M5.Lcd.drawLine(seg_x, y, seg_x, y + height, TFT_WHITE);
+            HAL_DISPLAY.drawLine(seg_x, y, seg_x, y + height, TFT_WHITE);
         }
     }
     
     // 現在のステージ名
-    M5.Lcd.setTextColor(TFT_WHITE);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.setCursor(x + 5, y + height + 5);
-    M5.Lcd.printf("%s - %s", getRoastLevelName(selected_level), getStageName(current_stage));
+    HAL_DISPLAY.setTextColor(TFT_WHITE);
+    HAL_DISPLAY.setFont(&fonts::lgfxJapanGothic_12);
+    HAL_DISPLAY.setCursor(x + 5, y + height + 5);
+    HAL_DISPLAY.printf("%s - %s", getRoastLevelName(selected_level), getStageName(current_stage));
 }
 
 // ターゲット情報描画
 void RoastGuide::drawTargetInfo(float current_temp, float current_ror) {
-    RoastTarget target = getRoastTarget(current_stage, selected_level);
+    const RoastTarget& target = current_target;
     
     int y_pos = 100;
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+    HAL_DISPLAY.setFont(&fonts::lgfxJapanGothic_16);
     
     // 温度ターゲット
-    M5.Lcd.setCursor(10, y_pos);
-    M5.Lcd.setTextColor(TFT_CYAN);
-    M5.Lcd.printf("Target: %.0f-%.0f°C", target.temp_min, target.temp_max);
+    HAL_DISPLAY.setCursor(10, y_pos);
+    HAL_DISPLAY.setTextColor(TFT_CYAN);
+    HAL_DISPLAY.printf("Target: %.0f-%.0f°C", target.temp_min, target.temp_max);
     
     // 現在の温度評価
     if (current_temp >= target.temp_min && current_temp <= target.temp_max) {
-        M5.Lcd.setTextColor(TFT_GREEN);
-        M5.Lcd.printf(" [OK]");
+        HAL_DISPLAY.setTextColor(TFT_GREEN);
+        HAL_DISPLAY.printf(" [OK]");
     } else {
-        M5.Lcd.setTextColor(TFT_RED);
-        M5.Lcd.printf(" [OFF]");
+        HAL_DISPLAY.setTextColor(TFT_RED);
+        HAL_DISPLAY.printf(" [OFF]");
     }
-    M5.Lcd.setTextColor(TFT_WHITE);
+    HAL_DISPLAY.setTextColor(TFT_WHITE);
     
     // RoRターゲット
     y_pos += 20;
-    M5.Lcd.setCursor(10, y_pos);
-    M5.Lcd.printf("RoR: %.1f-%.1f°C/min", target.ror_min, target.ror_max);
+    HAL_DISPLAY.setCursor(10, y_pos);
+    HAL_DISPLAY.printf("RoR: %.1f-%.1f°C/min", target.ror_min, target.ror_max);
     
     // ティップス
     y_pos += 20;
-    M5.Lcd.setCursor(10, y_pos);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.printf("%s", target.tips);
+    HAL_DISPLAY.setCursor(10, y_pos);
+    HAL_DISPLAY.setFont(&fonts::lgfxJapanGothic_12);
+    HAL_DISPLAY.printf("%s", target.tips);
 }
 
 // 火力推奨描画
 void RoastGuide::drawFirePowerRecommendation() {
-    RoastTarget target = getRoastTarget(current_stage, selected_level);
+    const RoastTarget& target = current_target;
     
     int y_pos = 180;
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-    M5.Lcd.setCursor(10, y_pos);
-    M5.Lcd.setTextColor(TFT_ORANGE);
-    M5.Lcd.printf("Fire: %s", getFirePowerName(target.fire));
-    M5.Lcd.setTextColor(TFT_WHITE);
+    HAL_DISPLAY.setFont(&fonts::lgfxJapanGothic_16);
+    HAL_DISPLAY.setCursor(10, y_pos);
+    HAL_DISPLAY.setTextColor(TFT_ORANGE);
+    HAL_DISPLAY.printf("Fire: %s", getFirePowerName(target.fire));
+    HAL_DISPLAY.setTextColor(TFT_WHITE);
     
     // ストール警告
     if (stall_detected) {
         y_pos += 25;
-        M5.Lcd.setCursor(10, y_pos);
-        M5.Lcd.setTextColor(TFT_RED);
-        M5.Lcd.printf("!!! STALL DETECTED !!!");
-        M5.Lcd.setTextColor(TFT_WHITE);
+        HAL_DISPLAY.setCursor(10, y_pos);
+        HAL_DISPLAY.setTextColor(TFT_RED);
+        HAL_DISPLAY.printf("!!! STALL DETECTED !!!");
+        HAL_DISPLAY.setTextColor(TFT_WHITE);
     }
     
     // 1ハゼ確認プロンプト
     if (first_crack_confirmation_needed) {
         y_pos += 25;
-        M5.Lcd.setCursor(10, y_pos);
-        M5.Lcd.setTextColor(TFT_YELLOW);
-        M5.Lcd.printf("1st Crack? Press [B] to confirm");
-        M5.Lcd.setTextColor(TFT_WHITE);
+        HAL_DISPLAY.setCursor(10, y_pos);
+        HAL_DISPLAY.setTextColor(TFT_YELLOW);
+        HAL_DISPLAY.printf("1st Crack? Press [B] to confirm");
+        HAL_DISPLAY.setTextColor(TFT_WHITE);
     }
 }
\ No newline at end of file
@@ -1,14 +1,17 @@
 #pragma once
 
-#include <Arduino.h>
-#include <M5Unified.h>
+#include "../HAL/Platform.h"
+#include "PhaseMetrics.h"
 
 /**
  * 焙煎ガイドシステム
  * 
  * 機能：
  * - 焙煎レベル別の温度・RoRプロファイル管理
- * - ステージ別ターゲット値提供
+ * - ステージ別ターゲット値提供（現在ステージの値はステージ移行時にキャッシュ）
+ * - 遷移表（温度・RoR・経過時間・イベントの条件）によるステージ進行
+ * - 焙煎イベント（投入・転換点・乾燥終了・1ハゼ・排出）をサンプル番号付きで記録
+ * - フェーズ集計（乾燥・メイラード・発達の時間と割合、DTR、AUC）をステージ移行から更新
  * - ストール（停滞）検出
  * - 焙煎ガイド画面描画
  * - プロファイル遵守度評価
@@ -60,13 +63,43 @@ public:
         const char* tips;
     };
 
+    // 焙煎イベント（1焙煎に各1回）
+    enum EventType : uint8_t {
+        EVENT_CHARGE = 0,       // 投入（投入ステージへの移行）
+        EVENT_TURNING_POINT,    // 転換点（投入後の最低温度のサンプル）
+        EVENT_DRY_END,          // 乾燥終了（メイラードへの移行）
+        EVENT_FIRST_CRACK,      // 1ハゼ（1ハゼステージへの移行）
+        EVENT_DROP,             // 排出（排出ステージへの移行）
+        EVENT_COUNT
+    };
+
+    static constexpr uint8_t STAGE_COUNT = STAGE_FINISH + 1;
+    static constexpr uint32_t NO_SAMPLE = 0xFFFFFFFF;
+
+    // イベント・ステージ移行の記録
+    struct Event {
+        uint32_t sample_index;  // NO_SAMPLE = 未発生
+        uint32_t elapsed_ms;    // ガイド開始から
+        float temp;
+    };
+
 private:
     // 状態管理
     bool active = false;
     RoastLevel selected_level = ROAST_MEDIUM;
     RoastStage current_stage = STAGE_PREHEAT;
+    RoastTarget current_target;     // current_stage・selected_level のターゲット（移行時に更新）
+    uint32_t clock_ms = 0;          // ガイドの時計：最後に渡されたサンプルの時刻
     uint32_t stage_start_time = 0;
     uint32_t roast_start_time = 0;
+    bool roast_started = false;     // 一度でも開始した（停止後も経過時間を返す）
+    
+    // イベントログ
+    Event events[EVENT_COUNT];
+    Event stage_entries[STAGE_COUNT];
+    Event turning_candidate;        // 転換点の候補（投入後の最低温度）
+    float charge_temp = 0;
+    PhaseMetrics phases;
     
     // ストール検出
     uint32_t last_stall_check = 0;
@@ -87,7 +120,11 @@ private:
     static RoastGuide* instance;
     
     // プライベートメソッド
-    void updateStageProgression(float current_temp, float current_ror);
+    void updateStageProgression(uint32_t sample_index, float current_temp, float current_ror);
+    void enterStage(RoastStage stage, uint32_t sample_index, float current_temp);
+    void recordEvent(EventType type, uint32_t sample_index, float current_temp);
+    void updateTurningPoint(uint32_t sample_index, float current_temp);
+    void clearEvents();
     void evaluateAdherence(float current_temp, float current_ror);
     const char* getStageName(RoastStage stage) const;
     const char* getFirePowerName(FirePower power) const;
@@ -100,26 +137,42 @@ public:
     // 初期化
     void begin();
     
-    // ガイド制御
-    void start(RoastLevel level);
+    // ガイド制御（時刻はサンプルの時刻：再生中は合成時刻のため倍速でも記録時と同じ判定）
+    void start(RoastLevel level, uint32_t now_ms);
     void stop();
     bool isActive() const { return active; }
     
-    // 状態更新
-    void update(float current_temp, float current_ror);
+    // 状態更新（サンプルごと、sample_index はイベントログに記録）
+    void update(uint32_t sample_index, uint32_t now_ms, float current_temp, float current_ror);
     
     // ストール検出
-    void checkStallCondition(float current_temp, float current_ror);
+    void checkStallCondition(uint32_t now_ms, float current_temp, float current_ror);
     bool isStalled() const { return stall_detected; }
     
     // 1ハゼ確認
     void confirmFirstCrack();
+    bool autoConfirmFirstCrack();   // 自動検出：確認待ちでなくてもメイラード中なら受け付ける
+    // 1ハゼをまだ受け付けられる（メイラード以前で未確認）：偽ならそれまでの自動検出の保留は不要
+    bool canAcceptFirstCrack() const { return active && !first_crack_detected && current_stage <= STAGE_MAILLARD; }
     bool isFirstCrackConfirmationNeeded() const { return first_crack_confirmation_needed; }
     
+    // 手動のステージ送り（B長押し）：遷移表の行き先と同じ次ステージへ。移行したら true
+    bool forceNextStage(uint32_t sample_index, float current_temp);
+    
     // 情報取得
     RoastLevel getSelectedLevel() const { return selected_level; }
     RoastStage getCurrentStage() const { return current_stage; }
+    const RoastTarget& getCurrentTarget() const { return current_target; }
     RoastTarget getRoastTarget(RoastStage stage, RoastLevel level) const;
+    uint32_t getRoastElapsedTime() const;   // 秒（未開始は0、最後のサンプルまで）
+    float getStageElapsedTime() const;      // 秒
+    
+    // イベントログ
+    bool hasEvent(EventType type) const { return events[type].sample_index != NO_SAMPLE; }
+    const Event& getEvent(EventType type) const { return events[type]; }
+    const Event& getStageEntry(RoastStage stage) const { return stage_entries[stage]; }
+    static const char* getEventName(EventType type);
+    const PhaseMetrics& getPhaseMetrics() const { return phases; }
     const char* getRoastLevelName(RoastLevel level) const;
     float getDangerTemp(RoastLevel level) const;
     float getCriticalTemp(RoastLevel level) const;
@@ -127,6 +180,7 @@ public:
     
     // レベル変更
     void cycleRoastLevel();
+    void setSelectedLevel(RoastLevel level);
     
     // 描画
     void draw(float current_temp, float current_ror, 
@@ -0,0 +1,126 @@
+#include "SampleProcessor.h"
+#include "FireAdvisor.h"
+#include "FirstCrackDetector.h"
+#include "../Statistics/TemperatureStatistics.h"
+#include "../Statistics/DerivativeEngine.h"
+#include "../History/TemperatureHistory.h"
+#include "../Safety/SafetySystem.h"
+#include "../Storage/RoastJournal.h"
+#include "../Profiling/LoopProfiler.h"
+
+// シングルトンインスタンス
+SampleProcessor* SampleProcessor::instance = nullptr;
+
+void SampleProcessor::reset() {
+    fire = RoastGuide::FIRE_MEDIUM;
+    fire_changes = 0;
+    resetJournal();
+}
+
+void SampleProcessor::resetJournal() {
+    journal_stage = 0xFF;
+    journal_fire = 0xFF;
+}
+
+void SampleProcessor::startGuide(RoastGuide::RoastLevel level, uint32_t now_ms) {
+    ROAST_GUIDE->start(level, now_ms);
+    CRACK_DETECTOR->reset(ROAST_GUIDE->getRoastTarget(RoastGuide::STAGE_FIRST_CRACK, level));
+    JOURNAL->addEvent(RoastJournal::REC_GUIDE_START, level);
+}
+
+SampleProcessor::Tick SampleProcessor::process(uint32_t index, float temp, int64_t timestamp_us) {
+    Tick tick = {};
+    uint32_t now_ms = (uint32_t)(timestamp_us / 1000);
+
+    // 先に記録：このサンプルで起きたイベントはこのサンプル番号で残る（記録中でなければ何もしない）
+    JOURNAL->addSample(index, temp, 0);
+
+    TEMP_STATS->addTemperature(temp);
+    HISTORY->add(temp, timestamp_us);
+
+    // RoR（60秒・15秒・判断用）- 微分エンジンはO(1)更新
+    DERIVATIVE->add(temp, timestamp_us);
+    tick.ror = DERIVATIVE->getRoR(DerivativeEngine::WINDOW_60S);
+    tick.ror_15s = DERIVATIVE->getRoR(DerivativeEngine::WINDOW_15S);
+    tick.decision_ror = DERIVATIVE->getSmoothedRoR();
+    tick.ror_ready = DERIVATIVE->isReady(DerivativeEngine::WINDOW_60S);
+    if (tick.ror_ready) {
+        HISTORY->setLatestRoR(tick.ror);
+    }
+
+    ROAST_GUIDE->checkStallCondition(now_ms, temp, tick.ror);
+    detectFirstCrack(index, temp, tick.ror_15s, tick);
+
+    {
+        PROFILE_SCOPE(SEC_SAFETY);
+        RoastGuide::RoastLevel level = ROAST_GUIDE->getSelectedLevel();
+        SAFETY->setDangerTemp(ROAST_GUIDE->getDangerTemp(level));
+        SAFETY->setCriticalTemp(ROAST_GUIDE->getCriticalTemp(level));
+        bool guide_active = ROAST_GUIDE->isActive();
+        SAFETY->checkEmergencyConditions(temp, tick.ror, ROAST_GUIDE->getCurrentStage(), guide_active);
+        if (SAFETY->getState().emergency_active && ROAST_GUIDE->isActive()) {
+            ROAST_GUIDE->stop();    // 緊急停止（実機では画面表示もコールバックで行う）
+        }
+    }
+
+    updateFire(temp, tick.decision_ror, tick);
+
+    // ステージ進行（表示モードに関係なく毎サンプル、イベントログにサンプル番号を残す）
+    ROAST_GUIDE->update(index, now_ms, temp, tick.decision_ror);
+
+    recordJournalEvents();
+    return tick;
+}
+
+// 短窓RoRの谷からの跳ね上がりで1ハゼを検出。ガイドがメイラードに入るまでは保留し、既に1ハゼ以降なら捨てる
+void SampleProcessor::detectFirstCrack(uint32_t index, float temp, float ror_15s, Tick& tick) {
+    if (!ROAST_GUIDE->isActive()) return;
+    tick.crack_detected = CRACK_DETECTOR->update(index, temp, ror_15s, DERIVATIVE->getRoRofRoR());
+    if (!auto_first_crack || !CRACK_DETECTOR->isPending()) return;
+
+    if (!ROAST_GUIDE->canAcceptFirstCrack()) {
+        CRACK_DETECTOR->clearPending();
+        return;
+    }
+    if (!ROAST_GUIDE->autoConfirmFirstCrack()) return;
+    CRACK_DETECTOR->clearPending();
+    tick.crack_accepted = true;
+
+    // 受け付けたサンプルではなく検出したサンプルで記録（焙煎一覧の1ハゼ時刻）
+    uint8_t confidence = (uint8_t)lroundf(CRACK_DETECTOR->getConfidence() * 100.0f);
+    if (confidence == 0) confidence = 1;  // 0 は手動確認
+    JOURNAL->addEvent(RoastJournal::REC_FIRST_CRACK, confidence, CRACK_DETECTOR->getDetectedIndex());
+}
+
+void SampleProcessor::updateFire(float temp, float decision_ror, Tick& tick) {
+    if (!ROAST_GUIDE->isActive()) return;
+
+    FireAdvisor::Inputs in;
+    in.stage = ROAST_GUIDE->getCurrentStage();
+    in.target = ROAST_GUIDE->getCurrentTarget();
+    in.temp = temp;
+    in.decision_ror = decision_ror;  // 平滑化した判断用RoR（60秒差分より遅れが小さくノイズも少ない）
+    in.ror_trend = (DERIVATIVE->getSampleCount() >= 3) ? DERIVATIVE->getTempDelta(2) : 0.0f;  // 簡易的な傾向
+    in.stage_elapsed_s = ROAST_GUIDE->getStageElapsedTime();
+    in.danger_temp = ROAST_GUIDE->getDangerTemp(ROAST_GUIDE->getSelectedLevel());
+    in.last_fire = fire;
+    RoastGuide::FirePower next = FireAdvisor::recommend(in);
+    if (next != fire) {
+        fire = next;
+        fire_changes++;
+        tick.fire_changed = true;
+    }
+}
+
+void SampleProcessor::recordJournalEvents() {
+    if (!ROAST_GUIDE->isActive()) return;
+    uint8_t stage = ROAST_GUIDE->getCurrentStage();
+    if (stage != journal_stage) {
+        JOURNAL->addEvent(RoastJournal::REC_STAGE, stage);
+        journal_stage = stage;
+    }
+    if (fire != journal_fire) {
+        JOURNAL->addEvent(RoastJournal::REC_FIRE, fire);
+        journal_fire = fire;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "RoastGuide.h"
+
+/**
+ * 1サンプル分のロジック層処理（実機の processSample()・ホストのベンチと再生・シミュレーションで共通）
+ *
+ * 順序：
+ *   ジャーナル → 統計・履歴・微分 → 停滞判定 → 1ハゼ自動検出（ガイドが受け付けるまで保留）→
+ *   安全チェック（緊急停止でガイド停止）→ 推奨火力 → ステージ進行 → ステージ・火力変化の記録
+ *
+ * 画面・音・BLE送信は含めない（Tick の結果を見て呼び出し側が行う）
+ * ガイド停止中の推奨火力は前回の値のまま
+ */
+class SampleProcessor {
+public:
+    // 1サンプルの処理結果
+    struct Tick {
+        float ror;              // 60秒RoR（安全チェック・停滞判定）
+        float ror_15s;          // 短窓RoR（1ハゼ検出）
+        float decision_ror;     // 判断用の平滑化RoR（ガイド・火力推奨）
+        bool ror_ready;         // 60秒RoRが有効（履歴に格納した）
+        bool crack_detected;    // このサンプルで検出器が1ハゼを検出した
+        bool crack_accepted;    // 保留中の検出をガイドが1ハゼとして受け付けた
+        bool fire_changed;      // 推奨火力が変わった
+    };
+
+private:
+    RoastGuide::FirePower fire = RoastGuide::FIRE_MEDIUM;
+    uint32_t fire_changes = 0;
+    bool auto_first_crack = true;
+
+    // 最後に記録したステージ・火力（変化時のみ記録）
+    uint8_t journal_stage = 0xFF;
+    uint8_t journal_fire = 0xFF;
+
+    // シングルトン
+    static SampleProcessor* instance;
+
+    void detectFirstCrack(uint32_t index, float temp, float ror_15s, Tick& tick);
+    void updateFire(float temp, float decision_ror, Tick& tick);
+    void recordJournalEvents();
+
+public:
+    SampleProcessor() {}
+
+    // 再生・シミュレーションの開始：推奨火力と記録済みの状態を初期化
+    void reset();
+    // ジャーナルの新しい焙煎：次のサンプルで現在のステージ・火力から記録し直す
+    void resetJournal();
+
+    // 1ハゼの自動検出をガイドの確認に使う（false：検出だけ行い、確認は操作者に任せる）
+    void setAutoFirstCrack(bool enable) { auto_first_crack = enable; }
+
+    // ガイド開始：ガイド・1ハゼ検出器を初期化し、ジャーナルに記録
+    void startGuide(RoastGuide::RoastLevel level, uint32_t now_ms);
+
+    // センサー正常時の1サンプル
+    Tick process(uint32_t index, float temp, int64_t timestamp_us);
+
+    RoastGuide::FirePower getFire() const { return fire; }
+    uint32_t getFireChanges() const { return fire_changes; }
+
+    // シングルトンインスタンス取得
+    static SampleProcessor* getInstance() {
+        if (!instance) {
+            instance = new SampleProcessor();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define SAMPLE_PROCESSOR SampleProcessor::getInstance()
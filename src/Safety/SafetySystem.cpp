@@ -1,4 +1,7 @@
 #include "SafetySystem.h"
+#include "../HAL/Clock.h"
+#include "../HAL/Display.h"
+#include "../Profiling/TraceRecorder.h"
 
 // シングルトンインスタンス
 SafetySystem* SafetySystem::instance = nullptr;
@@ -25,8 +28,9 @@ void SafetySystem::checkEmergencyConditions(float current_temp, float current_ro
     // 緊急停止チェック
     if (current_temp >= current_critical_temp && !emergency_active) {
         // 緊急停止発動
+        TRACE_MARK(MARK_EMERGENCY, current_stage);
         emergency_active = true;
-        emergency_beep_start = millis();
+        emergency_beep_start = hal::millis();
         emergency_beep_count = 0;
         roast_guide_active = false;
         
@@ -46,13 +50,13 @@ void SafetySystem::checkEmergencyConditions(float current_temp, float current_ro
 
         if (temp_safe && cooling_active && sufficient_cooldown) {
             auto_recovery_available = true;
-            recovery_dialog_start = millis();
+            recovery_dialog_start = hal::millis();
             recovery_dialog_active = true;
         }
     }
 
     // 復旧ダイアログの30秒タイムアウト
-    if (recovery_dialog_active && (millis() - recovery_dialog_start > 30000)) {
+    if (recovery_dialog_active && (hal::millis() - recovery_dialog_start > 30000)) {
         auto_recovery_available = false;
         recovery_dialog_active = false;
     }
@@ -85,18 +89,18 @@ void SafetySystem::playEmergencyAlert() {
         return;
     }
 
-    emergency_beep_start = millis();
+    emergency_beep_start = hal::millis();
     emergency_beep_count = 0;
 }
 
 void SafetySystem::playCriticalWarning() {
     critical_beep_active = true;
-    critical_beep_start = millis();
+    critical_beep_start = hal::millis();
     critical_beep_count = 0;
 }
 
 void SafetySystem::updateBeeps() {
-    uint32_t now = millis();
+    uint32_t now = hal::millis();
 
     // 緊急ビープ処理
     if (emergency_active && emergency_beep_count < MAX_EMERGENCY_BEEPS) {
@@ -135,38 +139,38 @@ void SafetySystem::drawRecoveryDialog(float current_temp, float current_ror) {
     if (!recovery_dialog_active) return;
 
     // 詳細な復旧ダイアログ描画
-    M5.Lcd.fillRect(25, 105, 270, 125, TFT_DARKGREEN);
-    M5.Lcd.drawRect(25, 105, 270, 125, TFT_GREEN);
-    M5.Lcd.setTextColor(TFT_WHITE, TFT_DARKGREEN);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
+    HAL_DISPLAY.fillRect(25, 105, 270, 125, TFT_DARKGREEN);
+    HAL_DISPLAY.drawRect(25, 105, 270, 125, TFT_GREEN);
+    HAL_DISPLAY.setTextColor(TFT_WHITE, TFT_DARKGREEN);
+    HAL_DISPLAY.setFont(&fonts::lgfxJapanGothic_12);
     
-    M5.Lcd.setCursor(35, 115);
-    M5.Lcd.printf("INTELLIGENT RECOVERY READY:");
+    HAL_DISPLAY.setCursor(35, 115);
+    HAL_DISPLAY.printf("INTELLIGENT RECOVERY READY:");
     
-    M5.Lcd.setCursor(35, 130);
-    M5.Lcd.printf("Temp: %.1f°C (Safe: <%.0f°C)", current_temp, current_danger_temp - 10);
+    HAL_DISPLAY.setCursor(35, 130);
+    HAL_DISPLAY.printf("Temp: %.1f°C (Safe: <%.0f°C)", current_temp, current_danger_temp - 10);
     
-    M5.Lcd.setCursor(35, 145);
-    M5.Lcd.printf("RoR: %.1f°C/min (Cooling)", current_ror);
+    HAL_DISPLAY.setCursor(35, 145);
+    HAL_DISPLAY.printf("RoR: %.1f°C/min (Cooling)", current_ror);
     
-    M5.Lcd.setCursor(35, 160);
-    M5.Lcd.printf("%s", (abs(current_ror) < 5.0f) ? "Temperature Stable" : "Cool Down Active");
+    HAL_DISPLAY.setCursor(35, 160);
+    HAL_DISPLAY.printf("%s", (abs(current_ror) < 5.0f) ? "Temperature Stable" : "Cool Down Active");
     
-    M5.Lcd.setCursor(35, 180);
-    M5.Lcd.printf("System Ready for Safe Recovery");
+    HAL_DISPLAY.setCursor(35, 180);
+    HAL_DISPLAY.printf("System Ready for Safe Recovery");
     
-    M5.Lcd.setCursor(35, 205);
-    M5.Lcd.printf("[A] Auto Reset [C] Manual Control");
+    HAL_DISPLAY.setCursor(35, 205);
+    HAL_DISPLAY.printf("[A] Auto Reset [C] Manual Control");
     
-    M5.Lcd.setTextColor(TFT_WHITE, TFT_BLACK);
+    HAL_DISPLAY.setTextColor(TFT_WHITE, TFT_BLACK);
 
     // 30秒タイムアウト警告
-    uint32_t remaining = 30 - ((millis() - recovery_dialog_start) / 1000);
+    uint32_t remaining = 30 - ((hal::millis() - recovery_dialog_start) / 1000);
     if (remaining < 10) {
-        M5.Lcd.setTextColor(TFT_YELLOW, TFT_BLACK);
-        M5.Lcd.setCursor(100, 90);
-        M5.Lcd.printf("Timeout in %d sec", remaining);
-        M5.Lcd.setTextColor(TFT_WHITE, TFT_BLACK);
+        HAL_DISPLAY.setTextColor(TFT_YELLOW, TFT_BLACK);
+        HAL_DISPLAY.setCursor(100, 90);
+        HAL_DISPLAY.printf("Timeout in %d sec", remaining);
+        HAL_DISPLAY.setTextColor(TFT_WHITE, TFT_BLACK);
     }
 }
 
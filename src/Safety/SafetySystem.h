@@ -1,7 +1,6 @@
 #pragma once
 
-#include <Arduino.h>
-#include <M5Unified.h>
+#include "../HAL/Platform.h"
 
 /**
  * コーヒー焙煎安全管理システム
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * シングルプロデューサ／シングルコンシューマのロックフリーリングバッファ
+ *
+ * 特徴：
+ * - 書き込み側（取得タスク, core 0）と読み出し側（loop, core 1）が
+ *   それぞれ自分のインデックスだけを更新するためロック不要
+ * - 容量は2のべき乗（インデックスはマスクで折り返し）
+ * - 満杯時はpush()がfalseを返し、呼び出し側が欠落として数える
+ */
+template <typename T, uint32_t N>
+class SampleQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SampleQueue capacity must be a power of two");
+
+private:
+    T items[N];
+    std::atomic<uint32_t> write_pos{0};  // プロデューサのみ更新
+    std::atomic<uint32_t> read_pos{0};   // コンシューマのみ更新
+
+public:
+    // プロデューサ側：満杯ならfalse
+    bool push(const T& item) {
+        uint32_t w = write_pos.load(std::memory_order_relaxed);
+        if (w - read_pos.load(std::memory_order_acquire) >= N) {
+            return false;
+        }
+        items[w & (N - 1)] = item;
+        write_pos.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // コンシューマ側：空ならfalse
+    bool pop(T& out) {
+        uint32_t r = read_pos.load(std::memory_order_relaxed);
+        if (r == write_pos.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = items[r & (N - 1)];
+        read_pos.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    // コンシューマ側：溜まっている要素を全て捨てる
+    void drain() {
+        read_pos.store(write_pos.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t size() const {
+        return write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    static constexpr uint32_t capacity() { return N; }
+};
@@ -0,0 +1,130 @@
+#include "SensorAcquisition.h"
+#include <M5Unified.h>
+
+// シングルトンインスタンス
+SensorAcquisition* SensorAcquisition::instance = nullptr;
+
+SensorAcquisition::SensorAcquisition() {
+    // コンストラクタ
+}
+
+SensorAcquisition::~SensorAcquisition() {
+    // デストラクタ
+    if (timer) {
+        esp_timer_stop(timer);
+    }
+    if (task_handle) {
+        vTaskDelete(task_handle);
+    }
+}
+
+bool SensorAcquisition::begin(TwoWire* wire, uint8_t address, int sda, int scl, uint32_t freq, uint32_t period_ms) {
+    if (task_handle) return true;  // 既に起動済み
+
+    kmeter.configure(wire, address, sda, scl, freq);
+    this->period_ms = period_ms;
+    if (raw_period_ms == 0 || raw_period_ms > period_ms || period_ms % raw_period_ms != 0) {
+        if (raw_callback) M5_LOGW("Raw period %u ms does not divide %u ms, raw capture disabled",
+                                  raw_period_ms, period_ms);
+        raw_period_ms = 0;
+        raw_callback = nullptr;
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "sensor_acq", TASK_STACK, this,
+                                                TASK_PRIORITY, &task_handle, TASK_CORE);
+    if (result != pdPASS) {
+        M5_LOGE("Failed to create sensor acquisition task");
+        task_handle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SensorAcquisition::taskEntry(void* arg) {
+    static_cast<SensorAcquisition*>(arg)->taskLoop();
+}
+
+// esp_timerタスクから呼ばれる：発火時刻を記録して取得タスクを起こすだけ
+void SensorAcquisition::timerCallback(void* arg) {
+    SensorAcquisition* self = static_cast<SensorAcquisition*>(arg);
+    self->last_tick_us = (uint32_t)esp_timer_get_time();
+    xTaskNotifyGive(self->task_handle);
+}
+
+bool SensorAcquisition::initSensor() {
+    if (sensor->begin()) {
+        M5_LOGI("KMeterISO initialization successful!");
+        return true;
+    }
+    M5_LOGE("KMeterISO not found…再試行中");
+    return false;
+}
+
+void SensorAcquisition::taskLoop() {
+    // センサーが見つかるまで非ブロッキングで再試行（他タスクは動き続ける）
+    while (!initSensor()) {
+        vTaskDelay(pdMS_TO_TICKS(INIT_RETRY_MS));
+    }
+    sensor_ready = true;
+
+    // esp_timerで周期を刻む（loop()の負荷や読み出し時間で周期がずれない）
+    // 生データ取得時は短い周期で刻み、decimation 回に1回を処理系のサンプルにする
+    const uint32_t tick_ms = getRawPeriodMs();
+    const uint32_t decimation = period_ms / tick_ms;
+    esp_timer_create_args_t timer_args = {};
+    timer_args.callback = timerCallback;
+    timer_args.arg = this;
+    timer_args.dispatch_method = ESP_TIMER_TASK;
+    timer_args.name = "sensor_tick";
+    if (esp_timer_create(&timer_args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, (uint64_t)tick_ms * 1000ULL) != ESP_OK) {
+        M5_LOGE("Failed to start sampling timer");
+        vTaskDelete(nullptr);
+        return;
+    }
+
+    const uint32_t late_threshold_us = tick_ms * 1000 * LATE_THRESHOLD_PCT / 100;
+    uint32_t raw_index = 0;
+    bool has_sample = false;
+    for (;;) {
+        // 前回の読み出し中に複数回発火していれば、その分は欠落
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (ticks == 0) continue;
+        raw_index += ticks - 1;
+        uint32_t index = raw_index++;
+
+        RawReading raw;
+        raw.index = index;
+        raw.timestamp_us = esp_timer_get_time();
+        if ((uint32_t)raw.timestamp_us - last_tick_us > late_threshold_us) {
+            late_count = late_count + 1;
+        }
+        raw.status = sensor->getReadyStatus();
+        raw.temp_centi = (raw.status == 0) ? sensor->getCelsiusTempValue() : 0;
+        int64_t read_us = esp_timer_get_time() - raw.timestamp_us;
+        raw.read_us = read_us > UINT16_MAX ? UINT16_MAX : (uint16_t)read_us;
+
+        // 処理系へは周期ごとに最初の読み出しを渡す（境界の読み出しが欠けても次の読み出しで埋める）
+        uint32_t period_index = index / decimation;
+        raw.sampled = !has_sample || period_index != sample_index - 1;
+        if (raw.sampled) {
+            if (has_sample && period_index > sample_index) {
+                missed_count = missed_count + (period_index - sample_index);
+            }
+            has_sample = true;
+            sample_index = period_index + 1;
+
+            Sample sample;
+            sample.index = period_index;
+            sample.timestamp_us = raw.timestamp_us;
+            sample.status = raw.status;
+            sample.temp = (raw.status == 0) ? raw.temp_centi / 100.0f : NAN;
+            if (!queue.push(sample)) {
+                // コンシューマが追いついていない：最新を優先せず欠落として数える
+                dropped_count = dropped_count + 1;
+            }
+        }
+
+        if (raw_callback) raw_callback(raw);
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <esp_timer.h>
+#include "SampleQueue.h"
+#include "../HAL/KMeterSensor.h"
+
+/**
+ * 温度センサー取得タスク
+ *
+ * 機能：
+ * - esp_timer周期コールバックでサンプリング時刻を刻む
+ * - KMeterISOの読み出しをcore 0に固定したFreeRTOSタスクで実行
+ * - センサーはHAL（hal::ThermoSensor）経由：begin()前に差し替え可能
+ * - タイムスタンプ付きサンプルをロックフリーリングへ投入
+ * - センサー未検出時の非ブロッキング再初期化
+ * - 描画やBLE送信の負荷がサンプリング周期に影響しない
+ * - 欠落（読めなかった周期）・遅延サンプルの明示的な計数
+ * - 生データ取得（任意）：周期より短い間隔（例 100ms）で読み、全読み出しをコールバックへ渡す
+ *   処理系へは各周期の最初の読み出しだけをサンプルとして渡す（1秒周期はそのまま）
+ */
+class SensorAcquisition {
+public:
+    // 取得サンプル
+    struct Sample {
+        uint32_t index;         // タイマー周期の通し番号（欠落時は番号が飛ぶ）
+        int64_t timestamp_us;   // 実際の読み出し時刻（esp_timer_get_time）
+        float temp;             // 温度（°C）、status != 0 の場合は無効
+        uint8_t status;         // getReadyStatus() の結果（0 = 正常）
+    };
+
+    // 生データ（取得タスクから呼ばれる：ブロックしないこと）
+    struct RawReading {
+        uint32_t index;         // 生データの通し番号（欠落時は番号が飛ぶ）
+        int64_t timestamp_us;
+        int32_t temp_centi;     // getCelsiusTempValue() の値（0.01°C）、status != 0 の場合は無効
+        uint8_t status;
+        bool sampled;           // 処理系へのサンプルとしても使った読み出し
+        uint16_t read_us;       // I2C読み出しにかかった時間
+    };
+    typedef void (*RawCallback)(const RawReading& reading);
+
+    static constexpr uint32_t QUEUE_SIZE = 16;  // 約16秒分の余裕
+
+private:
+    // タスク設定
+    static constexpr uint32_t TASK_STACK = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 3;
+    static constexpr BaseType_t TASK_CORE = 0;
+    static constexpr uint32_t INIT_RETRY_MS = 500;
+    static constexpr uint32_t LATE_THRESHOLD_PCT = 20;  // 周期の20%以上遅れたら遅延扱い
+
+    // センサー（既定は実機のKMeterISO）
+    hal::KMeterSensor kmeter;
+    hal::ThermoSensor* sensor = &kmeter;
+    volatile bool sensor_ready = false;
+
+    // サンプリング
+    uint32_t period_ms = 1000;
+    uint32_t sample_index = 0;
+    uint32_t raw_period_ms = 0;     // 0 = 生データ取得なし（周期ごとに1回読む）
+    RawCallback raw_callback = nullptr;
+    SampleQueue<Sample, QUEUE_SIZE> queue;
+    TaskHandle_t task_handle = nullptr;
+    esp_timer_handle_t timer = nullptr;
+    volatile uint32_t last_tick_us = 0;  // 直近のタイマー発火時刻（下位32bit、アトミックに読める幅）
+
+    // 計数（取得タスクのみ書き込み）
+    volatile uint32_t dropped_count = 0;  // リング満杯で捨てた数
+    volatile uint32_t missed_count = 0;   // 読み出しが間に合わなかった周期数
+    volatile uint32_t late_count = 0;     // 発火から読み出しまでが閾値を超えた数
+
+    // シングルトン
+    static SensorAcquisition* instance;
+
+    static void taskEntry(void* arg);
+    static void timerCallback(void* arg);
+    void taskLoop();
+    bool initSensor();
+
+public:
+    SensorAcquisition();
+    ~SensorAcquisition();
+
+    // センサーの差し替え（begin()前のみ有効）
+    void setSensor(hal::ThermoSensor* sensor) {
+        if (!task_handle && sensor) this->sensor = sensor;
+    }
+
+    // 生データ取得（begin()前のみ有効）。period_ms は raw_period_ms の整数倍であること
+    void setRawCallback(RawCallback callback, uint32_t raw_period_ms) {
+        if (task_handle) return;
+        raw_callback = callback;
+        this->raw_period_ms = callback ? raw_period_ms : 0;
+    }
+    uint32_t getRawPeriodMs() const { return raw_period_ms ? raw_period_ms : period_ms; }
+
+    // 初期化（タスク起動）。I2C設定は既定のKMeterISOに適用
+    bool begin(TwoWire* wire, uint8_t address, int sda, int scl, uint32_t freq, uint32_t period_ms);
+
+    // コンシューマ側（loop）
+    bool popSample(Sample& out) { return queue.pop(out); }
+    void discardPending() { queue.drain(); }
+    uint32_t getPendingCount() const { return queue.size(); }
+
+    // 状態取得
+    bool isSensorReady() const { return sensor_ready; }
+    uint32_t getDroppedCount() const { return dropped_count; }
+    uint32_t getMissedCount() const { return missed_count; }
+    uint32_t getLateCount() const { return late_count; }
+    uint32_t getPeriodMs() const { return period_ms; }
+
+    // シングルトンインスタンス取得
+    static SensorAcquisition* getInstance() {
+        if (!instance) {
+            instance = new SensorAcquisition();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define SENSOR_ACQ SensorAcquisition::getInstance()
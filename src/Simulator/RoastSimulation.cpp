@@ -0,0 +1,145 @@
+#include "RoastSimulation.h"
+#include "SimThermoSensor.h"
+#include "../HAL/Clock.h"
+#include "../Statistics/TemperatureStatistics.h"
+#include "../Statistics/DerivativeEngine.h"
+#include "../History/TemperatureHistory.h"
+#include "../RoastGuide/FirstCrackDetector.h"
+#include "../RoastGuide/SampleProcessor.h"
+#include "../Safety/SafetySystem.h"
+#include "../Storage/RoastJournal.h"
+
+namespace {
+constexpr uint32_t PREHEAT_HOLD_S = 30;     // 予熱を見せてから投入するまで
+}
+
+RoastSimulation::Result RoastSimulation::run(const Scenario& scenario, TraceCallback trace, void* arg) {
+    Result result = {};
+    result.id = scenario.id;
+    result.level = scenario.level;
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) result.stage_entry_s[i] = -1;
+    result.first_crack_s = -1.0f;
+    result.crack_detect_s = -1.0f;
+    result.crack_accept_s = -1.0f;
+    result.crack_detect_stage = RoastGuide::STAGE_PREHEAT;
+
+    // 仮想時計（0は「未開始」扱いのコードがあるため1秒から）
+    hal::useVirtualClock(true);
+    hal::setClockUs(1000000);
+
+    RoasterModel model;
+    model.reset(scenario.roaster);
+    SimThermoSensor sensor(&model);
+    sensor.setErrorInjection(scenario.sensor_error_every);
+    sensor.begin();
+
+    // ロジック層を初期状態へ
+    TEMP_STATS->reset();
+    HISTORY->clear();
+    DERIVATIVE->reset();
+    SAFETY->begin();
+    SAMPLE_PROCESSOR->reset();
+    SAMPLE_PROCESSOR->setAutoFirstCrack(scenario.auto_first_crack);
+    // 記録しない場合もジャーナルへの追記は何もしない（記録中の焙煎がない）
+    bool journal = scenario.record_journal && JOURNAL->startRoast();
+    SAMPLE_PROCESSOR->startGuide(scenario.level, hal::millis());
+
+    RoastGuide::RoastStage stage = ROAST_GUIDE->getCurrentStage();
+    RoastGuide::FirePower recommended = SAMPLE_PROCESSOR->getFire();
+    RoastGuide::FirePower applied = RoastGuide::FIRE_HIGH;
+    uint32_t recommended_at = 0;
+    bool crack_heard = false;       // 自動検出後の操作者の確認（記録のみ）
+    float decision_ror = 0.0f;
+    float max_temp = -1000.0f;
+
+    for (uint32_t t = 0; t < scenario.max_seconds; t++) {
+        // 操作者：予熱を見せた後に投入、推奨火力は反応遅れの後に反映
+        if (!model.isCharged() && t >= PREHEAT_HOLD_S) {
+            model.charge();
+        }
+        if (applied != recommended && t - recommended_at >= scenario.reaction_s) {
+            applied = recommended;
+            result.fire_changes++;
+        }
+        model.setFire(applied);
+
+        model.advance(PERIOD_MS / 1000.0f);
+        hal::advanceClock(PERIOD_MS);
+
+        // 偽KMeterISO経由の読み出し（SensorAcquisitionと同じ変換）
+        uint8_t status = sensor.getReadyStatus();
+        if (status != 0) {
+            result.sensor_errors++;
+            if (journal) JOURNAL->addSample(t, NAN, status);
+            continue;
+        }
+        float temp = sensor.getCelsiusTempValue() / 100.0f;
+        if (temp > max_temp) max_temp = temp;
+
+        // 実機の processSample() と同じ処理（ジャーナル・統計・検出・安全・火力推奨・ステージ進行）
+        SampleProcessor::Tick tick = SAMPLE_PROCESSOR->process(t, temp, hal::timeUs());
+        decision_ror = tick.decision_ror;
+        float charged_s = model.isCharged() ? model.getElapsed() - model.getChargeTime() : 0.0f;
+        if (tick.crack_detected) {
+            result.crack_detect_s = charged_s;
+            result.crack_detect_stage = ROAST_GUIDE->getCurrentStage();
+        }
+        if (tick.crack_accepted) {
+            result.crack_accept_s = charged_s;
+        }
+        if (SAFETY->getState().emergency_active) {
+            result.emergency = true;
+            result.seconds = (uint32_t)(model.getElapsed() - PREHEAT_HOLD_S);
+            break;
+        }
+        if (SAMPLE_PROCESSOR->getFire() != recommended) {
+            recommended = SAMPLE_PROCESSOR->getFire();
+            recommended_at = t;
+        }
+
+        // 操作者は1ハゼの音を聞いてから確認ボタンを押す（自動検出の後も聞いた時刻を記録する）
+        if (ROAST_GUIDE->isFirstCrackConfirmationNeeded() && model.getFirstCrackTime() >= 0.0f) {
+            ROAST_GUIDE->confirmFirstCrack();
+            if (journal) JOURNAL->addEvent(RoastJournal::REC_FIRST_CRACK, 0);
+        } else if (scenario.auto_first_crack && !crack_heard && CRACK_DETECTOR->isDetected() &&
+                   model.getFirstCrackTime() >= 0.0f && stage < RoastGuide::STAGE_FINISH) {
+            crack_heard = true;
+            if (journal) JOURNAL->addEvent(RoastJournal::REC_FIRST_CRACK, 0);
+        }
+
+        RoastGuide::RoastStage now_stage = ROAST_GUIDE->getCurrentStage();
+        if (now_stage != stage) {
+            stage = now_stage;
+            if (result.stage_entry_s[stage] < 0) {
+                float since_charge = model.getElapsed() - PREHEAT_HOLD_S;  // 投入前の移行は0秒扱い
+                result.stage_entry_s[stage] = since_charge > 0.0f ? (int32_t)since_charge : 0;
+            }
+        }
+
+        if (journal) JOURNAL->service();
+
+        if (trace) trace(t, model, decision_ror, stage, applied, arg);
+
+        if (stage == RoastGuide::STAGE_FINISH) {
+            result.finished = true;
+            result.seconds = (uint32_t)(model.getElapsed() - PREHEAT_HOLD_S);
+            break;
+        }
+    }
+
+    if (!result.finished && !result.emergency) {
+        result.seconds = (uint32_t)(model.getElapsed() - PREHEAT_HOLD_S);
+    }
+    result.final_stage = stage;     // 緊急停止でガイドが止まる前の段階
+    if (model.getFirstCrackTime() >= 0.0f) {
+        result.first_crack_s = model.getFirstCrackTime() - model.getChargeTime();
+    }
+    result.drop_temp = model.getBeanTemp();
+    result.max_temp = max_temp;
+    result.adherence = ROAST_GUIDE->getAdherenceScore();
+    result.crack_confidence = CRACK_DETECTOR->getPeakConfidence();
+
+    ROAST_GUIDE->stop();
+    if (journal) JOURNAL->finishRoast();
+    return result;
+}
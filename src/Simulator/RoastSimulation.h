@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "../RoastGuide/RoastGuide.h"
+#include "RoasterModel.h"
+
+/**
+ * 閉ループ焙煎シミュレーション（ホスト専用）
+ *
+ * 機能：
+ * - 仮想時計で1秒ごとに 熱モデル → 偽KMeterISO → 統計・履歴・微分 →
+ *   ガイド・安全・火力推奨 → 火力を熱モデルへ戻す、を実行
+ * - 操作者モデル：推奨火力に（反応遅れ付きで）従い、ガイドが求めたら1ハゼを確認し、
+ *   排出（STAGE_FINISH）または緊急停止で終了
+ * - 1ハゼ自動検出器は常に動かし、検出時刻を結果に残す（auto_first_crack で実機と同じく確認にも使う）
+ * - ロジック層のシングルトンと仮想時計を使うため、1プロセスで同時に1本だけ実行する
+ *   （並列実行は ScenarioSweep がプロセス単位で行う）
+ * - 実機と同じ形式で焙煎ジャーナルに記録できる（再生・検出器の評価データ）
+ */
+class RoastSimulation {
+public:
+    static constexpr uint32_t PERIOD_MS = 1000;
+    static constexpr uint8_t STAGE_COUNT = RoastGuide::STAGE_FINISH + 1;
+
+    struct Scenario {
+        uint32_t id = 0;
+        RoastGuide::RoastLevel level = RoastGuide::ROAST_MEDIUM;
+        RoasterModel::Params roaster;
+        uint32_t max_seconds = 1500;        // 打ち切り
+        uint32_t reaction_s = 5;            // 推奨火力を操作に反映するまで
+        uint32_t sensor_error_every = 0;    // 偽センサーのエラー注入
+        bool record_journal = false;        // RoastJournal へ記録（事前に JOURNAL->begin()）
+        bool auto_first_crack = false;      // 1ハゼ自動検出で確認する（実機と同じ）
+    };
+
+    // 結果（プロセス間でそのまま受け渡すためPOD）
+    struct Result {
+        uint32_t id;
+        uint8_t level;
+        uint8_t final_stage;
+        bool finished;                      // STAGE_FINISHに到達
+        bool emergency;                     // 緊急停止が発動
+        uint32_t seconds;                   // 投入から終了まで
+        int32_t stage_entry_s[STAGE_COUNT]; // 投入からの各ステージ開始時刻（未到達は-1）
+        float first_crack_s;                // 熱モデル上の1ハゼ（投入から、未到達は負）
+        float crack_detect_s;               // 自動検出器の検出（投入から、未検出は負）
+        float crack_accept_s;               // ガイドが自動検出を1ハゼとして受け付けた（投入から、なしは負）
+        uint8_t crack_detect_stage;         // 検出時のガイドのステージ
+        float crack_confidence;             // 検出器の確からしさの最大値
+        float drop_temp;                    // 終了時の豆温度
+        float max_temp;                     // プローブ最高温度
+        float adherence;                    // ガイド遵守度
+        uint16_t fire_changes;
+        uint16_t sensor_errors;
+    };
+
+    // トレース出力（1秒ごと、nullなら出力しない）
+    typedef void (*TraceCallback)(uint32_t second, const RoasterModel& model, float ror,
+                                  RoastGuide::RoastStage stage, RoastGuide::FirePower fire, void* arg);
+
+    static Result run(const Scenario& scenario, TraceCallback trace = nullptr, void* arg = nullptr);
+};
@@ -0,0 +1,91 @@
+#include "RoasterModel.h"
+
+void RoasterModel::reset(const Params& params) {
+    this->params = params;
+    drum_temp = params.charge_temp;
+    bean_temp = params.ambient;
+    probe_temp = params.charge_temp;   // 予熱中はドラム内の空気温度
+    water_g = params.batch_g * params.moisture;
+    exotherm_left_j = params.batch_g * EXOTHERM_J_PER_G;
+    burner_level = 4.0f;
+    fire = 4;
+    charged = false;
+    elapsed_s = 0.0f;
+    charge_time_s = -1.0f;
+    first_crack_s = -1.0f;
+    second_crack_s = -1.0f;
+    rng = params.seed ? params.seed : 1;
+}
+
+void RoasterModel::charge() {
+    if (charged) return;
+    charged = true;
+    charge_time_s = elapsed_s;
+    bean_temp = params.ambient;
+}
+
+void RoasterModel::advance(float seconds) {
+    while (seconds > 1e-6f) {
+        float dt = seconds < STEP_S ? seconds : STEP_S;
+        integrate(dt);
+        seconds -= dt;
+    }
+}
+
+void RoasterModel::integrate(float dt) {
+    // バーナーは数秒かけて目標の火力に近づく
+    burner_level += (fire - burner_level) * (dt / 3.0f);
+
+    if (!charged) {
+        // 予熱：ドラムは投入温度で保持（操作者が火力で合わせる前提）
+        drum_temp = params.charge_temp;
+        probe_temp += (drum_temp - probe_temp) * (dt / PROBE_TAU_S);
+        elapsed_s += dt;
+        return;
+    }
+
+    float burner_w = BURNER_MAX_W * burner_level / 5.0f;
+    float loss_w = DRUM_LOSS_W_PER_K * (drum_temp - params.ambient);
+    float transfer_w = BEAN_TRANSFER_W_PER_KG * (params.batch_g / 1000.0f) * (drum_temp - bean_temp);
+
+    // 水分蒸発：100°C超で温度に比例して進む（残量に比例して遅くなる）
+    float evap_w = 0.0f;
+    if (bean_temp > 100.0f && water_g > 0.0f) {
+        float rate_g_s = water_g * 0.0025f * (bean_temp - 100.0f) / 50.0f;
+        float evaporated = rate_g_s * dt;
+        if (evaporated > water_g) evaporated = water_g;
+        water_g -= evaporated;
+        evap_w = evaporated * LATENT_HEAT / dt;
+    }
+
+    // 1ハゼ域の発熱反応
+    float exo_w = 0.0f;
+    if (bean_temp >= FIRST_CRACK_TEMP - 4.0f && exotherm_left_j > 0.0f) {
+        float released = params.batch_g * EXOTHERM_W_PER_G * dt;
+        if (released > exotherm_left_j) released = exotherm_left_j;
+        exotherm_left_j -= released;
+        exo_w = released / dt;
+    }
+
+    float bean_capacity = params.batch_g * BEAN_SPECIFIC_HEAT + water_g * 4.18f;
+    drum_temp += (burner_w - loss_w - transfer_w) * dt / DRUM_HEAT_CAPACITY;
+    bean_temp += (transfer_w - evap_w + exo_w) * dt / bean_capacity;
+    probe_temp += (bean_temp - probe_temp) * (dt / PROBE_TAU_S);
+    elapsed_s += dt;
+
+    if (first_crack_s < 0.0f && bean_temp >= FIRST_CRACK_TEMP) first_crack_s = elapsed_s;
+    if (second_crack_s < 0.0f && bean_temp >= SECOND_CRACK_TEMP) second_crack_s = elapsed_s;
+}
+
+float RoasterModel::nextNoise() {
+    rng = rng * 1664525u + 1013904223u;
+    return ((rng >> 8) & 0xFFFF) / 65535.0f * 2.0f - 1.0f;
+}
+
+float RoasterModel::readProbe() {
+    return probe_temp + nextNoise() * params.noise;
+}
+
+float RoasterModel::getMoistureRatio() const {
+    return params.batch_g > 0.0f ? water_g / params.batch_g : 0.0f;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+
+/**
+ * 焙煎機の熱モデル（ホストシミュレーター用、決定的）
+ *
+ * 機能：
+ * - 3ノードの集中定数モデル：ドラム（空気含む）・豆・熱電対プローブ
+ * - 6段階の火力（RoastGuide::FirePower 0-5）に応じたバーナー入熱
+ * - 乾燥中の水分蒸発による吸熱、1ハゼ域の発熱反応
+ * - 豆量・投入温度・外気温で挙動が変わる
+ * - 同じ seed なら同じ結果（プローブノイズは内部の線形合同法）
+ *
+ * 予熱中はプローブがドラム温度を読み、charge() で常温の豆が入ると
+ * プローブは豆温度へ一次遅れで追従する（実機の転換点と同じ形）
+ */
+class RoasterModel {
+public:
+    struct Params {
+        float batch_g = 250.0f;         // 豆量（生豆）
+        float charge_temp = 200.0f;     // 投入時のドラム温度
+        float ambient = 25.0f;          // 外気温・生豆温度
+        float moisture = 0.11f;         // 生豆の含水率
+        float noise = 0.1f;             // プローブノイズ（±°C）
+        uint32_t seed = 1;
+    };
+
+    // 物理定数（家庭用ガス火＋手回し/小型ドラムを想定して調整）
+    static constexpr float BURNER_MAX_W = 3500.0f;      // 火力5の実効入熱
+    static constexpr float DRUM_HEAT_CAPACITY = 6000.0f; // J/K
+    static constexpr float DRUM_LOSS_W_PER_K = 4.0f;    // ドラム→外気
+    static constexpr float BEAN_SPECIFIC_HEAT = 1.6f;   // J/(g·K)
+    static constexpr float BEAN_TRANSFER_W_PER_KG = 12.0f; // ドラム→豆（W/K、豆1kgあたり）
+    static constexpr float LATENT_HEAT = 2260.0f;       // J/g
+    static constexpr float EXOTHERM_J_PER_G = 15.0f;    // 1ハゼ域の発熱量
+    static constexpr float EXOTHERM_W_PER_G = 0.2f;     // 発熱の速さ
+    static constexpr float FIRST_CRACK_TEMP = 196.0f;   // 豆温度
+    static constexpr float SECOND_CRACK_TEMP = 224.0f;
+    static constexpr float PROBE_TAU_S = 4.0f;          // プローブの時定数
+    static constexpr float STEP_S = 0.1f;               // 積分刻み
+
+private:
+    Params params;
+    float drum_temp = 0.0f;
+    float bean_temp = 0.0f;
+    float probe_temp = 0.0f;
+    float water_g = 0.0f;
+    float exotherm_left_j = 0.0f;
+    float burner_level = 0.0f;      // 実際の入熱段（0-5、バーナーの応答遅れあり）
+    uint8_t fire = 0;
+    bool charged = false;
+    float elapsed_s = 0.0f;
+    float charge_time_s = -1.0f;
+    float first_crack_s = -1.0f;
+    float second_crack_s = -1.0f;
+    uint32_t rng = 1;
+
+    void integrate(float dt);
+    float nextNoise();
+
+public:
+    void reset(const Params& params);
+
+    // 操作
+    void setFire(uint8_t level) { fire = level > 5 ? 5 : level; }
+    void charge();                  // 豆投入
+
+    // 1秒など任意の時間だけ進める
+    void advance(float seconds);
+
+    // 状態（プローブ値はノイズ込み）
+    float readProbe();
+    float getProbeTemp() const { return probe_temp; }
+    float getBeanTemp() const { return bean_temp; }
+    float getDrumTemp() const { return drum_temp; }
+    float getMoistureRatio() const;
+    uint8_t getFire() const { return fire; }
+    bool isCharged() const { return charged; }
+    float getElapsed() const { return elapsed_s; }
+    float getChargeTime() const { return charge_time_s; }
+    float getFirstCrackTime() const { return first_crack_s; }   // 未到達は負
+    float getSecondCrackTime() const { return second_crack_s; }
+    const Params& getParams() const { return params; }
+};
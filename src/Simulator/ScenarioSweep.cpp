@@ -0,0 +1,123 @@
+#include "ScenarioSweep.h"
+#include <errno.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+bool writeAll(int fd, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool readAll(int fd, void* data, size_t len) {
+    uint8_t* p = (uint8_t*)data;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+}  // namespace
+
+size_t ScenarioSweep::buildGrid(RoastSimulation::Scenario* out, size_t count, uint32_t seed) {
+    static const float CHARGE_TEMPS[] = { 180.0f, 190.0f, 200.0f, 210.0f };
+    static const float BATCHES[] = { 150.0f, 200.0f, 250.0f, 300.0f, 350.0f };
+    static const float AMBIENTS[] = { 5.0f, 15.0f, 25.0f, 35.0f };
+    constexpr size_t NC = sizeof(CHARGE_TEMPS) / sizeof(CHARGE_TEMPS[0]);
+    constexpr size_t NB = sizeof(BATCHES) / sizeof(BATCHES[0]);
+    constexpr size_t NA = sizeof(AMBIENTS) / sizeof(AMBIENTS[0]);
+    constexpr size_t NL = RoastGuide::ROAST_COUNT;
+
+    // 格子を一周したら seed だけ変えて（ノイズ違いで）繰り返す
+    for (size_t i = 0; i < count; i++) {
+        size_t k = i;
+        RoastSimulation::Scenario& s = out[i];
+        s = RoastSimulation::Scenario();
+        s.id = (uint32_t)i;
+        s.level = (RoastGuide::RoastLevel)(k % NL); k /= NL;
+        s.roaster.charge_temp = CHARGE_TEMPS[k % NC]; k /= NC;
+        s.roaster.batch_g = BATCHES[k % NB]; k /= NB;
+        s.roaster.ambient = AMBIENTS[k % NA]; k /= NA;
+        s.roaster.seed = seed + (uint32_t)i * 2654435761u;
+    }
+    return count;
+}
+
+bool ScenarioSweep::run(const RoastSimulation::Scenario* scenarios, size_t count,
+                        RoastSimulation::Result* results, unsigned jobs) {
+    if (count == 0) return true;
+    if (jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (unsigned)cpus : 1;
+    }
+    if (jobs > count) jobs = (unsigned)count;
+
+    // 1ワーカーなら自プロセスで実行
+    if (jobs == 1) {
+        for (size_t i = 0; i < count; i++) results[i] = RoastSimulation::run(scenarios[i]);
+        return true;
+    }
+
+    // ワーカー k はインデックス i % jobs == k を担当し、順に結果を書き出す
+    pid_t pids[256];
+    int fds[256];
+    if (jobs > 256) jobs = 256;
+    fflush(stdout);
+    fflush(stderr);
+
+    unsigned started = 0;
+    for (; started < jobs; started++) {
+        int pipefd[2];
+        if (pipe(pipefd) != 0) break;
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            break;
+        }
+        if (pid == 0) {
+            close(pipefd[0]);
+            for (size_t i = started; i < count; i += jobs) {
+                RoastSimulation::Result r = RoastSimulation::run(scenarios[i]);
+                if (!writeAll(pipefd[1], &r, sizeof(r))) _exit(1);
+            }
+            close(pipefd[1]);
+            _exit(0);
+        }
+        close(pipefd[1]);
+        pids[started] = pid;
+        fds[started] = pipefd[0];
+    }
+
+    bool ok = started == jobs;
+    if (!ok) M5_LOGE("ScenarioSweep: only %u of %u workers started", started, jobs);
+
+    // パイプが詰まらないよう、ワーカーの順に交互に読む
+    for (size_t i = 0; ok && i < count; i++) {
+        unsigned k = (unsigned)(i % jobs);
+        if (!readAll(fds[k], &results[i], sizeof(results[i]))) {
+            M5_LOGE("ScenarioSweep: worker %u failed at scenario %zu", k, i);
+            ok = false;
+        }
+    }
+
+    for (unsigned k = 0; k < started; k++) {
+        close(fds[k]);
+        int status = 0;
+        waitpid(pids[k], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    return ok;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "RoastSimulation.h"
+
+/**
+ * シナリオの並列一括実行（ホスト専用、回帰テスト用）
+ *
+ * ロジック層はシングルトンと仮想時計を共有するため、スレッドではなく
+ * fork() したワーカープロセスごとにシナリオを分担し、結果（POD）をパイプで集める。
+ * ワーカー数は既定でオンラインCPU数。結果は入力と同じ順に並ぶ
+ */
+class ScenarioSweep {
+public:
+    // 投入温度・豆量・外気温・焙煎度の格子からシナリオを生成（count個まで）
+    static size_t buildGrid(RoastSimulation::Scenario* out, size_t count, uint32_t seed);
+
+    // jobs = 0 ならCPU数。成功時 true
+    static bool run(const RoastSimulation::Scenario* scenarios, size_t count,
+                    RoastSimulation::Result* results, unsigned jobs = 0);
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../HAL/ThermoSensor.h"
+#include "RoasterModel.h"
+
+/**
+ * シミュレーター用の偽KMeterISO
+ *
+ * 熱モデルのプローブ値を KMeterISO と同じ形（0.01°C整数、status 0 = 正常）で返す。
+ * 読み出しエラー（I2C不通など）を周期的に注入できる
+ */
+class SimThermoSensor : public hal::ThermoSensor {
+private:
+    RoasterModel* model;
+    uint32_t reads = 0;
+    uint32_t error_every = 0;   // N回に1回エラー（0 = なし）
+    uint8_t error_code = 1;
+
+public:
+    explicit SimThermoSensor(RoasterModel* model) : model(model) {}
+
+    void setErrorInjection(uint32_t every, uint8_t code = 1) {
+        error_every = every;
+        error_code = code;
+    }
+
+    bool begin() override { return model != nullptr; }
+
+    uint8_t getReadyStatus() override {
+        reads++;
+        return (error_every && reads % error_every == 0) ? error_code : 0;
+    }
+
+    int32_t getCelsiusTempValue() override {
+        return (int32_t)lroundf(model->readProbe() * 100.0f);
+    }
+};
@@ -0,0 +1,198 @@
+#include "DerivativeEngine.h"
+
+// シングルトンインスタンス
+DerivativeEngine* DerivativeEngine::instance = nullptr;
+
+// Savitzky-Golay（2次・31点）の終端1階微分係数：古い順、1サンプル間隔あたり
+// 2次多項式を最小二乗で当てはめ、最新点での傾きを評価する因果型フィルタ
+static const float SAVGOL_COEFFS[DerivativeEngine::SAVGOL_WINDOW] = {
+    0.02144428f, 0.01634897f, 0.01163287f, 0.00729599f, 0.00333831f, -0.00024017f,
+    -0.00343943f, -0.00625948f, -0.00870032f, -0.01076196f, -0.01244438f, -0.01374760f,
+    -0.01467160f, -0.01521640f, -0.01538199f, -0.01516837f, -0.01457554f, -0.01360350f,
+    -0.01225225f, -0.01052179f, -0.00841212f, -0.00592325f, -0.00305516f, 0.00019213f,
+    0.00381864f, 0.00782435f, 0.01220927f, 0.01697340f, 0.02211675f, 0.02763930f,
+    0.03354106f
+};
+
+DerivativeEngine::DerivativeEngine() {
+    reset();
+}
+
+DerivativeEngine::~DerivativeEngine() {
+    // デストラクタ
+}
+
+void DerivativeEngine::begin() {
+    reset();
+}
+
+void DerivativeEngine::reset() {
+    sample_count = 0;
+    epoch_us = 0;
+    sum_t = sum_y = sum_tt = sum_ty = 0;
+    ror_sum_t = ror_sum_y = ror_sum_tt = ror_sum_ty = 0;
+    ror_samples = 0;
+    savgol_ror = 0.0f;
+    kalman_ready = false;
+    kf_temp = kf_slope = 0;
+    kf_p00 = kf_p01 = kf_p11 = 0;
+    kf_last_t = 0;
+}
+
+void DerivativeEngine::add(float temp, int64_t timestamp_us) {
+    if (sample_count == 0) epoch_us = timestamp_us;
+    double t = (timestamp_us - epoch_us) / 1000000.0;
+
+    // リングへ格納
+    uint8_t s = (uint8_t)(sample_count & (HISTORY_SIZE - 1));
+    temps[s] = temp;
+    times[s] = t;
+    sample_count++;
+
+    // 温度の最小二乗ランニングサム：窓から外れた1点を引き、新しい1点を足す
+    if (sample_count > LSQ_WINDOW) {
+        uint8_t old = slot(LSQ_WINDOW);
+        sum_t -= times[old];
+        sum_y -= temps[old];
+        sum_tt -= times[old] * times[old];
+        sum_ty -= times[old] * temps[old];
+    }
+    sum_t += t;
+    sum_y += temp;
+    sum_tt += t * t;
+    sum_ty += t * temp;
+
+    // 15秒RoR系列とそのランニングサム（RoR-of-RoR用）
+    if (isReady(WINDOW_15S)) {
+        float ror = getRoR(WINDOW_15S);
+        ror_series[s] = ror;
+        ror_samples++;
+        if (ror_samples > ROR2_WINDOW) {
+            uint8_t old = slot(ROR2_WINDOW);
+            ror_sum_t -= times[old];
+            ror_sum_y -= ror_series[old];
+            ror_sum_tt -= times[old] * times[old];
+            ror_sum_ty -= times[old] * ror_series[old];
+        }
+        ror_sum_t += t;
+        ror_sum_y += ror;
+        ror_sum_tt += t * t;
+        ror_sum_ty += t * ror;
+    }
+
+    // 平滑化RoR
+    updateSavGol();
+    updateKalman(temp, t);
+}
+
+void DerivativeEngine::updateSavGol() {
+    if (sample_count < SAVGOL_WINDOW) return;
+
+    // 係数は等間隔前提：窓全体の平均間隔で秒に換算する
+    double span = times[slot(0)] - times[slot(SAVGOL_WINDOW - 1)];
+    if (span <= 0.0) return;
+    double dt = span / (SAVGOL_WINDOW - 1);
+
+    float acc = 0.0f;
+    for (uint8_t k = 0; k < SAVGOL_WINDOW; k++) {
+        acc += SAVGOL_COEFFS[k] * temps[slot(SAVGOL_WINDOW - 1 - k)];
+    }
+    savgol_ror = (float)(acc * 60.0 / dt);
+}
+
+void DerivativeEngine::updateKalman(float temp, double t) {
+    const double r = (double)KALMAN_MEAS_NOISE * KALMAN_MEAS_NOISE;
+
+    if (!kalman_ready) {
+        // 初回：温度は測定値、傾きは不明として大きな分散で開始
+        kf_temp = temp;
+        kf_slope = 0;
+        kf_p00 = r;
+        kf_p01 = 0;
+        kf_p11 = 1.0;
+        kf_last_t = t;
+        kalman_ready = true;
+        return;
+    }
+
+    double dt = t - kf_last_t;
+    kf_last_t = t;
+    if (dt <= 0.0) return;
+
+    // 予測：等速度モデル（x = [温度, 傾き]、傾きはランダムウォーク）
+    const double q = KALMAN_ACCEL_NOISE;
+    kf_temp += kf_slope * dt;
+    double p00 = kf_p00 + dt * (2 * kf_p01 + dt * kf_p11) + q * dt * dt * dt / 3;
+    double p01 = kf_p01 + dt * kf_p11 + q * dt * dt / 2;
+    double p11 = kf_p11 + q * dt;
+
+    // 更新：温度のみ観測
+    double s = p00 + r;
+    double k0 = p00 / s;
+    double k1 = p01 / s;
+    double innovation = temp - kf_temp;
+    kf_temp += k0 * innovation;
+    kf_slope += k1 * innovation;
+    kf_p00 = (1 - k0) * p00;
+    kf_p01 = (1 - k0) * p01;
+    kf_p11 = p11 - k1 * p01;
+}
+
+bool DerivativeEngine::isSmoothedReady() const {
+    switch (smoothing_mode) {
+        case SMOOTHING_SAVGOL: return sample_count >= SAVGOL_WINDOW;
+        case SMOOTHING_KALMAN: return sample_count > WINDOW_15S;  // 傾き推定の収束待ち
+        default:               return isReady(WINDOW_60S);
+    }
+}
+
+const char* DerivativeEngine::getSmoothingModeName() const {
+    switch (smoothing_mode) {
+        case SMOOTHING_SAVGOL: return "SG";
+        case SMOOTHING_KALMAN: return "KF";
+        default:               return "60s";
+    }
+}
+
+float DerivativeEngine::getSmoothedRoR() const {
+    switch (smoothing_mode) {
+        case SMOOTHING_SAVGOL: return savgol_ror;
+        case SMOOTHING_KALMAN: return getKalmanRoR();
+        default:               return getRoR(WINDOW_60S);
+    }
+}
+
+float DerivativeEngine::getRoR(uint8_t window, uint8_t lag) const {
+    uint32_t oldest_ago = (uint32_t)window + lag;
+    if (window == 0 || oldest_ago >= HISTORY_SIZE || sample_count <= oldest_ago) {
+        return 0.0f;  // データ不足
+    }
+
+    uint8_t newer = slot(lag);
+    uint8_t older = slot(oldest_ago);
+    double dt = times[newer] - times[older];
+    if (dt <= 0.0) return 0.0f;  // 異常値回避
+
+    return (float)((temps[newer] - temps[older]) * 60.0 / dt);
+}
+
+float DerivativeEngine::getTempDelta(uint8_t ago) const {
+    if (ago >= HISTORY_SIZE || sample_count <= ago) return 0.0f;
+    return temps[slot(0)] - temps[slot(ago)];
+}
+
+float DerivativeEngine::slope(double n, double st, double sy, double stt, double sty) {
+    double denom = n * stt - st * st;
+    if (n < 2 || denom <= 0.0) return 0.0f;
+    return (float)((n * sty - st * sy) / denom);
+}
+
+float DerivativeEngine::getLeastSquaresRoR() const {
+    double n = sample_count < LSQ_WINDOW ? sample_count : LSQ_WINDOW;
+    return slope(n, sum_t, sum_y, sum_tt, sum_ty) * 60.0f;  // °C/s → °C/min
+}
+
+float DerivativeEngine::getRoRofRoR() const {
+    double n = ror_samples < ROR2_WINDOW ? ror_samples : ROR2_WINDOW;
+    return slope(n, ror_sum_t, ror_sum_y, ror_sum_tt, ror_sum_ty) * 60.0f;  // °C/min/s → °C/min²
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+
+/**
+ * ストリーミング型 温度微分（RoR）エンジン
+ *
+ * 機能：
+ * - サンプル追加ごとにO(1)で更新
+ * - 5/15/30/60秒の差分RoR（実タイムスタンプ基準）
+ * - 共有ランニングサムによる最小二乗傾き
+ * - RoRの変化率（RoR-of-RoR）
+ * - 任意窓・任意遅れのRoR参照（転換点検出用）
+ * - 判断用の平滑化RoR（Savitzky-Golay微分／等速度カルマンフィルタ）
+ *
+ * 全てのRoR利用箇所はこのエンジンを参照し、窓の数が増えても
+ * 1サンプルあたりの計算量は一定に保たれる
+ */
+class DerivativeEngine {
+public:
+    // 提供する標準窓（秒 = サンプル数、1Hz）
+    static constexpr uint8_t WINDOW_5S = 5;
+    static constexpr uint8_t WINDOW_15S = 15;
+    static constexpr uint8_t WINDOW_30S = 30;
+    static constexpr uint8_t WINDOW_60S = 60;
+
+    static constexpr uint8_t HISTORY_SIZE = 64;   // 60秒窓 + 遅れ参照の余裕（2のべき乗）
+    static constexpr uint8_t LSQ_WINDOW = 30;     // 最小二乗傾きの窓
+    static constexpr uint8_t ROR2_WINDOW = 30;    // RoR-of-RoRの窓
+
+    // 判断用RoRの平滑化方式
+    enum SmoothingMode {
+        SMOOTHING_NONE = 0,  // 60秒差分（従来方式）
+        SMOOTHING_SAVGOL,    // Savitzky-Golay 2次・31点の終端微分
+        SMOOTHING_KALMAN     // 温度・傾きの2状態カルマンフィルタ
+    };
+
+    static constexpr uint8_t SAVGOL_WINDOW = 31;
+    static constexpr float KALMAN_MEAS_NOISE = 0.05f;      // 温度測定ノイズ（°C, 1σ）
+    static constexpr float KALMAN_ACCEL_NOISE = 1.0e-6f;   // 傾き変化のプロセスノイズ（(°C/s)²/s）
+
+private:
+    // 直近サンプルのリング
+    float temps[HISTORY_SIZE];
+    double times[HISTORY_SIZE];     // 開始からの秒
+    float ror_series[HISTORY_SIZE]; // 15秒RoRの系列（RoR-of-RoR用）
+    uint32_t sample_count = 0;
+    int64_t epoch_us = 0;
+
+    // 最小二乗ランニングサム（温度）
+    double sum_t = 0, sum_y = 0, sum_tt = 0, sum_ty = 0;
+    // 最小二乗ランニングサム（15秒RoR）
+    double ror_sum_t = 0, ror_sum_y = 0, ror_sum_tt = 0, ror_sum_ty = 0;
+    uint32_t ror_samples = 0;
+
+    // 平滑化RoR
+    SmoothingMode smoothing_mode = SMOOTHING_KALMAN;
+    float savgol_ror = 0.0f;        // °C/min
+    bool kalman_ready = false;
+    double kf_temp = 0, kf_slope = 0;             // 状態：温度（°C）・傾き（°C/s）
+    double kf_p00 = 0, kf_p01 = 0, kf_p11 = 0;    // 共分散（対称）
+    double kf_last_t = 0;
+
+    // シングルトン
+    static DerivativeEngine* instance;
+
+    uint8_t slot(uint32_t ago) const { return (uint8_t)((sample_count - 1 - ago) & (HISTORY_SIZE - 1)); }
+    static float slope(double n, double st, double sy, double stt, double sty);
+    void updateSavGol();
+    void updateKalman(float temp, double t);
+
+public:
+    DerivativeEngine();
+    ~DerivativeEngine();
+
+    // 初期化
+    void begin();
+    void reset();
+
+    // サンプル追加（O(1)）
+    void add(float temp, int64_t timestamp_us);
+
+    // 件数
+    uint32_t getSampleCount() const { return sample_count; }
+    bool isReady(uint8_t window) const { return sample_count > window; }
+    uint32_t samplesUntilReady(uint8_t window) const {
+        return isReady(window) ? 0 : window + 1 - sample_count;
+    }
+
+    // 差分RoR（°C/min）：lag サンプル前を終端とする window 秒の差分
+    float getRoR(uint8_t window, uint8_t lag = 0) const;
+
+    // 指定サンプル間の温度差（°C）
+    float getTempDelta(uint8_t ago) const;
+
+    // 最小二乗傾き（°C/min, LSQ_WINDOW）
+    float getLeastSquaresRoR() const;
+
+    // RoRの変化率（°C/min², ROR2_WINDOW）
+    float getRoRofRoR() const;
+
+    // 平滑化RoR（°C/min）
+    float getSavGolRoR() const { return savgol_ror; }
+    float getKalmanRoR() const { return kalman_ready ? (float)(kf_slope * 60.0) : 0.0f; }
+    bool isSmoothedReady() const;
+
+    // 判断用RoR：選択中の方式の値（ガイド・火力推奨が参照）
+    void setSmoothingMode(SmoothingMode mode) { smoothing_mode = mode; }
+    SmoothingMode getSmoothingMode() const { return smoothing_mode; }
+    const char* getSmoothingModeName() const;
+    float getSmoothedRoR() const;
+
+    // シングルトンインスタンス取得
+    static DerivativeEngine* getInstance() {
+        if (!instance) {
+            instance = new DerivativeEngine();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define DERIVATIVE DerivativeEngine::getInstance()
@@ -22,6 +22,14 @@ void TemperatureStatistics::addTemperature(float temp) {
     count++;
 }
 
+void TemperatureStatistics::addSummary(float min, float max, float mean, uint32_t n) {
+    if (n == 0 || max <= 0.0f) return;  // 有効な温度データのみ
+    if (min < min_temp) min_temp = min;
+    if (max > max_temp) max_temp = max;
+    sum_temp += mean * n;
+    count += n;
+}
+
 void TemperatureStatistics::reset() {
     min_temp = std::numeric_limits<float>::infinity();
     max_temp = -std::numeric_limits<float>::infinity();
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <Arduino.h>
+#include "../HAL/Platform.h"
 #include <limits>
 
 /**
@@ -10,6 +10,7 @@
  * - 最小/最大/平均温度の追跡
  * - 統計のリセット
  * - バッファからの再計算
+ * - 間引き済み要約（min/max/mean）からの再計算
  */
 class TemperatureStatistics {
 private:
@@ -31,6 +32,9 @@ public:
     // 温度データ追加
     void addTemperature(float temp);
     
+    // 間引き済み要約の追加（n サンプル分のmin/max/mean）
+    void addSummary(float min, float max, float mean, uint32_t n);
+    
     // 統計値取得
     float getMin() const { return (count > 0) ? min_temp : 0.0f; }
     float getMax() const { return (count > 0) ? max_temp : 0.0f; }
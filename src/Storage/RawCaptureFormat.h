@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+
+/**
+ * microSD 生データファイルの形式（実機の書き込み・ホストの読み出しで共通）
+ *
+ * - 先頭 HEADER_SIZE バイトがヘッダー（残りはゼロ埋め）：以降の書き込みがブロック境界に揃う
+ * - 続いて16バイト固定長レコードが書き込み順に並ぶ（件数 = (ファイル長 - HEADER_SIZE) / 16）
+ * - リトルエンディアン、パディングなし
+ */
+namespace RawCaptureFormat {
+
+constexpr uint32_t MAGIC = 0x57525442;     // "BTRW"
+constexpr uint16_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 4096;
+constexpr int32_t INVALID_TEMP = INT32_MIN;
+
+// Record::flags
+enum Flags : uint8_t {
+    FLAG_SAMPLED = 0x01         // 処理系（1秒周期）のサンプルとしても使った読み出し
+};
+
+#pragma pack(push, 1)
+struct Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t header_size;
+    uint32_t raw_period_ms;     // 生データ周期
+    uint32_t sample_period_ms;  // 処理系のサンプル周期
+    uint32_t session_id;        // 焙煎ジャーナルのID（なければ0）
+    uint32_t start_ms;          // 起動からの時間
+};
+
+struct Record {
+    uint32_t index;             // 生データ通し番号（欠落時は飛ぶ）
+    uint32_t time_ms;           // 読み出し時刻（起動から）
+    int32_t temp_centi;         // 0.01°C（エラー時 INVALID_TEMP）
+    uint8_t status;             // getReadyStatus()
+    uint8_t flags;
+    uint16_t read_us;           // I2C読み出し時間
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Record) == 16, "Record must stay 16 bytes");
+static_assert(HEADER_SIZE % sizeof(Record) == 0, "Header must keep records block aligned");
+
+}  // namespace RawCaptureFormat
@@ -0,0 +1,536 @@
+#include "RoastJournal.h"
+#include "../BLE/TelemetryProtocol.h"
+#include "../HAL/Clock.h"
+#include "../RoastGuide/RoastGuide.h"
+#include <unistd.h>
+
+// シングルトンインスタンス
+RoastJournal* RoastJournal::instance = nullptr;
+
+namespace {
+
+constexpr const char* INDEX_NAME = "roasts.idx";
+
+uint16_t crcOf(const void* data, size_t len) {
+    return TelemetryProtocol::crc16((const uint8_t*)data, len);
+}
+
+// fsync まで行う：LittleFSは同期するまでメタデータを確定しない
+bool syncWrite(FILE* f, const void* data, size_t len) {
+    if (fwrite(data, 1, len, f) != len) return false;
+    if (fflush(f) != 0) return false;
+    return fsync(fileno(f)) == 0;
+}
+
+uint16_t toU16(float x) {
+    if (!(x > 0.0f)) return 0;
+    return x < 65535.0f ? (uint16_t)lroundf(x) : 65535;
+}
+
+// インデックス版1のエントリ（フェーズ集計なし）
+#pragma pack(push, 1)
+struct EntryV1 {
+    uint32_t id;
+    uint8_t state;
+    uint8_t level;
+    uint8_t final_stage;
+    uint8_t crack_confirmed;
+    uint32_t boot;
+    uint32_t start_ms;
+    uint32_t duration_s;
+    uint32_t samples;
+    int16_t max_temp_deci;
+    int16_t drop_temp_deci;
+    uint16_t first_crack_s;
+    uint16_t crc;
+};
+#pragma pack(pop)
+static_assert(sizeof(EntryV1) == 32, "EntryV1 is the version 1 slot");
+
+}  // namespace
+
+void RoastJournal::makePath(char* buf, size_t size, const char* name) {
+    snprintf(buf, size, "%s/%s", hal::storageRoot(), name);
+}
+
+void RoastJournal::makeRoastPath(char* buf, size_t size, uint32_t roast_id) {
+    snprintf(buf, size, "%s/r%05lu.bin", hal::storageRoot(), (unsigned long)roast_id);
+}
+
+void RoastJournal::sealPage(Page& page, uint32_t seq) {
+    page.seq = seq;
+    page.crc = crcOf(&page, sizeof(page) - sizeof(page.crc));
+}
+
+void RoastJournal::sealEntry(Entry& entry) {
+    entry.crc = crcOf(&entry, sizeof(entry) - sizeof(entry.crc));
+}
+
+void RoastJournal::setFirstCrack(Entry& entry, uint32_t first_index, uint32_t period_ms, uint32_t sample_index) {
+    if (entry.first_crack_s != NO_FIRST_CRACK || entry.samples == 0) return;
+    uint32_t s = (sample_index - first_index) * period_ms / 1000;
+    entry.first_crack_s = s < NO_FIRST_CRACK ? (uint16_t)s : NO_FIRST_CRACK - 1;
+}
+
+void RoastJournal::storePhases(Entry& entry, const PhaseMetrics& phases) {
+    if (!phases.isCharged()) {
+        entry.charge_s = NO_CHARGE;
+        memset(entry.phase_s, 0, sizeof(entry.phase_s));
+        entry.dtr_deci = 0;
+        memset(entry.auc, 0, sizeof(entry.auc));
+        return;
+    }
+    entry.charge_s = toU16(phases.getChargeMs() / 1000.0f);
+    for (uint8_t p = 0; p < PhaseMetrics::PHASE_COUNT; p++) {
+        entry.phase_s[p] = toU16(phases.getPhaseSeconds((PhaseMetrics::Phase)p));
+        entry.auc[p] = toU16(phases.getAUC((PhaseMetrics::Phase)p));
+    }
+    entry.dtr_deci = toU16(phases.getDTR() * 10.0f);
+}
+
+// 記録中・復旧時で共通の集計（1レコードごとにO(1)）
+void RoastJournal::accumulate(Entry& entry, uint32_t& first_index, PhaseMetrics& phases,
+                              uint32_t period_ms, const Record& record) {
+    switch (record.type) {
+        case REC_SAMPLE:
+            if (entry.samples == 0) first_index = record.sample_index;
+            entry.samples++;
+            entry.duration_s = (record.sample_index - first_index + 1) * period_ms / 1000;
+            if (record.value16 != INT16_MIN) {
+                if (record.value16 > entry.max_temp_deci) entry.max_temp_deci = record.value16;
+                entry.drop_temp_deci = record.value16;
+                phases.update((record.sample_index - first_index) * period_ms, record.value16 / 10.0f);
+                storePhases(entry, phases);
+            }
+            break;
+        case REC_STAGE:
+            entry.final_stage = record.value8;
+            if (record.value8 == RoastGuide::STAGE_FIRST_CRACK) {
+                setFirstCrack(entry, first_index, period_ms, record.sample_index);
+            }
+            if (entry.samples > 0) {
+                phases.onStage(record.value8, (record.sample_index - first_index) * period_ms);
+                storePhases(entry, phases);
+            }
+            break;
+        case REC_GUIDE_START:
+            entry.level = record.value8;
+            break;
+        case REC_FIRST_CRACK:
+            // 確認ボタンの時刻をステージ移行より優先
+            if (!entry.crack_confirmed) {
+                entry.first_crack_s = NO_FIRST_CRACK;
+                setFirstCrack(entry, first_index, period_ms, record.sample_index);
+                entry.crack_confirmed = 1;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool RoastJournal::begin(uint32_t period_ms) {
+    this->period_ms = period_ms;
+    mounted = hal::mountStorage();
+    if (!mounted) {
+        M5_LOGE("Journal storage mount failed");
+        return false;
+    }
+
+    char path[64];
+    makePath(path, sizeof(path), INDEX_NAME);
+    FILE* f = fopen(path, "rb");
+    bool loaded = false;
+    if (f) {
+        loaded = fread(&index, sizeof(index), 1, f) == 1 &&
+                 index.magic == MAGIC && index.max_roasts == MAX_ROASTS &&
+                 index.crc == crcOf(&index, sizeof(index) - sizeof(index.crc));
+        if (loaded && index.version == INDEX_VERSION) {
+            loaded = fread(entries, sizeof(entries), 1, f) == 1;
+        } else if (loaded && index.version == 1) {
+            loaded = migrateIndex(f);
+        } else {
+            loaded = false;
+        }
+        fclose(f);
+        if (loaded && index.version != INDEX_VERSION) {
+            index.version = INDEX_VERSION;
+            loaded = writeIndex();
+        }
+    }
+    if (!loaded) {
+        M5_LOGW("Journal index missing or invalid, creating a new one");
+        if (!createIndex()) {
+            mounted = false;
+            return false;
+        }
+    }
+
+    // 壊れたエントリは空き扱い、記録中のまま残ったものは復旧
+    for (Entry& entry : entries) {
+        if (entry.state == ENTRY_EMPTY) continue;
+        if (entry.crc != crcOf(&entry, sizeof(entry) - sizeof(entry.crc))) {
+            entry = Entry();
+            continue;
+        }
+        if (entry.state == ENTRY_OPEN) {
+            recover(entry);
+        }
+    }
+
+    index.boot_count++;
+    return writeIndexHeader();
+}
+
+bool RoastJournal::createIndex() {
+    index = IndexHeader();
+    index.magic = MAGIC;
+    index.version = INDEX_VERSION;
+    index.max_roasts = MAX_ROASTS;
+    index.next_id = 1;
+    for (Entry& entry : entries) entry = Entry();
+    return writeIndex();
+}
+
+bool RoastJournal::writeIndex() {
+    index.crc = crcOf(&index, sizeof(index) - sizeof(index.crc));
+    char path[64];
+    makePath(path, sizeof(path), INDEX_NAME);
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        M5_LOGE("Cannot create journal index");
+        return false;
+    }
+    bool ok = fwrite(&index, sizeof(index), 1, f) == 1 && syncWrite(f, entries, sizeof(entries));
+    fclose(f);
+    return ok;
+}
+
+// 版1のインデックス：エントリを移し、フェーズは焙煎ファイルから集計し直す（起動時に1回だけ）
+bool RoastJournal::migrateIndex(FILE* f) {
+    for (Entry& entry : entries) {
+        EntryV1 old;
+        if (fread(&old, sizeof(old), 1, f) != 1) return false;
+        entry = Entry();
+        if (old.state == ENTRY_EMPTY || old.crc != crcOf(&old, sizeof(old) - sizeof(old.crc))) continue;
+
+        entry.id = old.id;
+        entry.state = old.state;
+        entry.level = old.level;
+        entry.final_stage = old.final_stage;
+        entry.crack_confirmed = old.crack_confirmed;
+        entry.boot = old.boot;
+        entry.start_ms = old.start_ms;
+        entry.duration_s = old.duration_s;
+        entry.samples = old.samples;
+        entry.max_temp_deci = old.max_temp_deci;
+        entry.drop_temp_deci = old.drop_temp_deci;
+        entry.first_crack_s = old.first_crack_s;
+        entry.charge_s = NO_CHARGE;
+        if (entry.state != ENTRY_OPEN) summarise(entry);  // 記録中のものはこの後の復旧で集計
+        sealEntry(entry);
+    }
+    M5_LOGI("Journal index migrated to version %u", INDEX_VERSION);
+    return true;
+}
+
+bool RoastJournal::writeIndexHeader() {
+    index.crc = crcOf(&index, sizeof(index) - sizeof(index.crc));
+    char path[64];
+    makePath(path, sizeof(path), INDEX_NAME);
+    FILE* f = fopen(path, "r+b");
+    if (!f) return false;
+    bool ok = syncWrite(f, &index, sizeof(index));
+    fclose(f);
+    return ok;
+}
+
+bool RoastJournal::writeEntry(const Entry& entry) {
+    char path[64];
+    makePath(path, sizeof(path), INDEX_NAME);
+    FILE* f = fopen(path, "r+b");
+    if (!f) return false;
+    long offset = (long)(sizeof(IndexHeader) + (&entry - entries) * sizeof(Entry));
+    bool ok = fseek(f, offset, SEEK_SET) == 0 && syncWrite(f, &entry, sizeof(entry));
+    fclose(f);
+    if (!ok) write_errors++;
+    return ok;
+}
+
+// 焙煎ファイルからエントリの集計をやり直す
+bool RoastJournal::summarise(Entry& entry) {
+    Reader reader;
+    if (!reader.open(entry.id)) return false;
+
+    uint32_t period = reader.getHeader().period_ms;
+    uint32_t first = 0;
+    PhaseMetrics file_phases;
+    Record record;
+    entry.samples = 0;
+    entry.duration_s = 0;
+    entry.max_temp_deci = INT16_MIN;
+    entry.drop_temp_deci = INT16_MIN;
+    entry.first_crack_s = NO_FIRST_CRACK;
+    entry.crack_confirmed = 0;
+    storePhases(entry, file_phases);
+    while (reader.next(record)) {
+        accumulate(entry, first, file_phases, period, record);
+    }
+    return true;
+}
+
+void RoastJournal::recover(Entry& entry) {
+    if (!summarise(entry)) {
+        // ヘッダーページも書けていなかった
+        entry = Entry();
+        writeEntry(entry);
+        return;
+    }
+    entry.state = ENTRY_RECOVERED;
+    sealEntry(entry);
+    writeEntry(entry);
+    M5_LOGW("Journal: recovered roast %lu (%lu samples)",
+            (unsigned long)entry.id, (unsigned long)entry.samples);
+}
+
+bool RoastJournal::startRoast() {
+    if (!mounted) return false;
+    if (current) finishRoast();
+
+    uint32_t id = index.next_id++;
+    Entry& entry = entries[id % MAX_ROASTS];
+
+    // 古い焙煎の上書き
+    char path[64];
+    if (entry.state != ENTRY_EMPTY) {
+        makeRoastPath(path, sizeof(path), entry.id);
+        remove(path);
+    }
+
+    makeRoastPath(path, sizeof(path), id);
+    file = fopen(path, "wb");
+    if (!file) {
+        M5_LOGE("Journal: cannot create %s", path);
+        write_errors++;
+        return false;
+    }
+    setvbuf(file, nullptr, _IONBF, 0);  // ページ単位で書くため stdio のバッファは使わない
+
+    // ヘッダーページ
+    uint8_t header_page[PAGE_SIZE] = {};
+    FileHeader* header = (FileHeader*)header_page;
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->page_size = PAGE_SIZE;
+    header->roast_id = id;
+    header->boot = index.boot_count;
+    header->start_ms = hal::millis();
+    header->period_ms = period_ms;
+    header->crc = crcOf(header, sizeof(FileHeader) - sizeof(header->crc));
+    if (!syncWrite(file, header_page, sizeof(header_page))) {
+        M5_LOGE("Journal: header write failed");
+        write_errors++;
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    entry = Entry();
+    entry.id = id;
+    entry.state = ENTRY_OPEN;
+    entry.level = NO_LEVEL;
+    entry.boot = header->boot;
+    entry.start_ms = header->start_ms;
+    entry.max_temp_deci = INT16_MIN;
+    entry.drop_temp_deci = INT16_MIN;
+    entry.first_crack_s = NO_FIRST_CRACK;
+    phases.reset();
+    storePhases(entry, phases);
+    sealEntry(entry);
+
+    // 次回起動時にIDが重ならないよう、ファイルより先にインデックスを確定
+    if (!writeIndexHeader() || !writeEntry(entry)) {
+        M5_LOGE("Journal: index write failed");
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    current = &entry;
+    first_index = 0;
+    last_index = 0;
+    filling = Page();
+    has_pending = false;
+    page_seq = 0;
+    return true;
+}
+
+void RoastJournal::append(const Record& record) {
+    if (!current) return;
+    accumulate(*current, first_index, phases, period_ms, record);
+
+    filling.records[filling.count++] = record;
+    if (filling.count < RECORDS_PER_PAGE) return;
+
+    // 前のページがまだ書けていなければここで書く（通常は service() で書き済み）
+    if (has_pending && !writePending()) return;
+    sealPage(filling, page_seq++);
+    pending = filling;
+    has_pending = true;
+    filling = Page();
+}
+
+void RoastJournal::addSample(uint32_t sample_index, float temp, uint8_t status) {
+    last_index = sample_index;
+    Record record;
+    record.sample_index = sample_index;
+    record.value16 = (status != 0 || isnan(temp)) ? INT16_MIN : (int16_t)lroundf(temp * 10.0f);
+    record.type = REC_SAMPLE;
+    record.value8 = status;
+    append(record);
+}
+
+void RoastJournal::addEvent(RecordType type, uint8_t value) {
+    addEvent(type, value, last_index);
+}
+
+void RoastJournal::addEvent(RecordType type, uint8_t value, uint32_t sample_index) {
+    Record record;
+    record.sample_index = sample_index;
+    record.value16 = 0;
+    record.type = type;
+    record.value8 = value;
+    append(record);
+}
+
+bool RoastJournal::writePending() {
+    if (!has_pending || !file) return true;
+    if (!syncWrite(file, &pending, sizeof(pending))) {
+        // 容量不足など：この焙煎の記録を打ち切る（エントリは次回起動時に復旧）
+        M5_LOGE("Journal: page write failed, recording stopped");
+        write_errors++;
+        abortRoast();
+        return false;
+    }
+    has_pending = false;
+    pages_written++;
+    return true;
+}
+
+void RoastJournal::service() {
+    if (has_pending) writePending();
+}
+
+bool RoastJournal::finishRoast() {
+    if (!current) return false;
+
+    bool ok = writePending();
+    if (ok && filling.count > 0) {
+        // 最終ページは空きを REC_PAD（ゼロ）のまま書く
+        sealPage(filling, page_seq++);
+        pending = filling;
+        has_pending = true;
+        filling = Page();
+        ok = writePending();
+    }
+    if (!ok) return false;
+
+    fclose(file);
+    file = nullptr;
+    current->state = ENTRY_CLOSED;
+    sealEntry(*current);
+    ok = writeEntry(*current);
+    current = nullptr;
+    return ok;
+}
+
+void RoastJournal::abortRoast() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+    current = nullptr;
+    has_pending = false;
+    filling = Page();
+}
+
+uint32_t RoastJournal::getRoastCount() const {
+    uint32_t count = 0;
+    for (const Entry& entry : entries) {
+        if (entry.state != ENTRY_EMPTY) count++;
+    }
+    return count;
+}
+
+const RoastJournal::Entry* RoastJournal::getRecent(uint32_t n) const {
+    if (n >= MAX_ROASTS || index.next_id <= n + 1) return nullptr;
+    return findRoast(index.next_id - 1 - n);
+}
+
+const RoastJournal::Entry* RoastJournal::findRoast(uint32_t roast_id) const {
+    const Entry& entry = entries[roast_id % MAX_ROASTS];
+    if (entry.state == ENTRY_EMPTY || entry.id != roast_id) return nullptr;
+    return &entry;
+}
+
+// ---- Reader ----
+
+bool RoastJournal::Reader::open(uint32_t roast_id) {
+    char path[64];
+    makeRoastPath(path, sizeof(path), roast_id);
+    return openPath(path);
+}
+
+bool RoastJournal::Reader::openPath(const char* path) {
+    close();
+    file = fopen(path, "rb");
+    if (!file) return false;
+
+    uint8_t header_page[PAGE_SIZE];
+    if (fread(header_page, sizeof(header_page), 1, file) != 1) {
+        close();
+        return false;
+    }
+    memcpy(&header, header_page, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION || header.page_size != PAGE_SIZE ||
+        header.crc != crcOf(&header, sizeof(header) - sizeof(header.crc))) {
+        M5_LOGW("Journal: %s has an invalid header", path);
+        close();
+        return false;
+    }
+    page.count = 0;
+    pos = 0;
+    next_seq = 0;
+    return true;
+}
+
+void RoastJournal::Reader::close() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+bool RoastJournal::Reader::readPage() {
+    if (!file || fread(&page, sizeof(page), 1, file) != 1) return false;
+    // 途中で切れた・壊れたページ以降は読まない
+    if (page.crc != crcOf(&page, sizeof(page) - sizeof(page.crc)) ||
+        page.seq != next_seq || page.count > RECORDS_PER_PAGE) {
+        page.count = 0;
+        return false;
+    }
+    next_seq++;
+    pos = 0;
+    return true;
+}
+
+bool RoastJournal::Reader::next(Record& record) {
+    while (pos >= page.count) {
+        if (!readPage()) {
+            close();
+            return false;
+        }
+    }
+    record = page.records[pos++];
+    return true;
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "../HAL/Storage.h"
+#include "../RoastGuide/PhaseMetrics.h"
+
+/**
+ * 焙煎ジャーナル（LittleFS、追記専用バイナリ）と焙煎ライブラリのインデックス
+ *
+ * 機能：
+ * - 監視開始〜停止を1焙煎として、全サンプルとステージ・火力などのイベントを1ファイルへ追記
+ * - 1レコード8バイト、31レコード＋通し番号・CRCで256バイト（フラッシュの1ページ）単位で書き込み
+ *   （ページが埋まった時だけ書く：書き込み回数と停止時間を抑える）
+ * - 書き込みは loop() の service() で行い、センサー処理・安全チェックの中では書かない
+ * - インデックス（roasts.idx）は固定長スロット：焙煎IDから位置が決まり、一覧・参照はO(1)
+ *   フェーズ（乾燥・メイラード・発達、DTR、AUC）も記録されたステージ変化から集計して持つ
+ * - 電源断時：ファイルはCRCの通る最後のページまで有効（失うのは最大1ページ＝約31秒）
+ *   次回起動時に「記録中」のまま残ったエントリをファイルから集計し直して復旧
+ * - 保存数は MAX_ROASTS 件：古いものから上書き
+ *
+ * ファイル：<root>/roasts.idx、<root>/r<ID 5桁>.bin（先頭1ページはヘッダー）
+ */
+class RoastJournal {
+public:
+    static constexpr size_t PAGE_SIZE = 256;
+    static constexpr size_t RECORDS_PER_PAGE = 31;
+    static constexpr uint32_t MAX_ROASTS = 32;
+    static constexpr uint32_t MAGIC = 0x314A5442;   // "BTJ1"
+    static constexpr uint16_t VERSION = 1;         // 焙煎ファイル
+    static constexpr uint16_t INDEX_VERSION = 2;   // インデックス（1：フェーズ集計なしの32バイト）
+    static constexpr uint8_t NO_LEVEL = 0xFF;
+    static constexpr uint16_t NO_FIRST_CRACK = 0xFFFF;
+    static constexpr uint16_t NO_CHARGE = 0xFFFF;
+
+    // レコード種別
+    enum RecordType : uint8_t {
+        REC_PAD = 0,            // 最終ページの空き
+        REC_SAMPLE = 1,         // value16：温度（0.1°C、センサーエラー時 INT16_MIN）、value8：ステータス
+        REC_STAGE = 2,          // value8：新しいステージ
+        REC_FIRE = 3,           // value8：推奨火力
+        REC_GUIDE_START = 4,    // value8：焙煎レベル
+        REC_FIRST_CRACK = 5     // 1ハゼ確認（value8：0 = 手動、1〜100 = 自動検出の確からしさ%）
+    };
+
+    // インデックスのエントリ状態
+    enum EntryState : uint8_t {
+        ENTRY_EMPTY = 0,
+        ENTRY_OPEN = 1,         // 記録中（起動時に残っていれば電源断）
+        ENTRY_CLOSED = 2,       // 正常終了
+        ENTRY_RECOVERED = 3     // 電源断後にファイルから復旧
+    };
+
+#pragma pack(push, 1)
+    struct Record {
+        uint32_t sample_index;  // イベントは直前のサンプル番号
+        int16_t value16;
+        uint8_t type;
+        uint8_t value8;
+    };
+
+    struct Page {
+        Record records[RECORDS_PER_PAGE];
+        uint32_t seq;           // ページ通し番号（0から）
+        uint16_t count;         // 有効レコード数
+        uint16_t crc;           // 先頭からのCRC16
+    };
+
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t page_size;
+        uint32_t roast_id;
+        uint32_t boot;          // 起動回数（RTCがないため開始時刻は起動回数＋起動からの時間）
+        uint32_t start_ms;
+        uint32_t period_ms;     // サンプル周期
+        uint16_t crc;
+    };
+
+    struct Entry {
+        uint32_t id;
+        uint8_t state;          // EntryState
+        uint8_t level;          // NO_LEVEL = ガイド未使用
+        uint8_t final_stage;
+        uint8_t crack_confirmed; // 1ハゼが確認ボタンによるもの（0 = ステージ移行時刻）
+        uint32_t boot;
+        uint32_t start_ms;
+        uint32_t duration_s;
+        uint32_t samples;
+        int16_t max_temp_deci;
+        int16_t drop_temp_deci; // 最後の有効サンプル
+        uint16_t first_crack_s; // 開始からの秒（1ハゼ確認、なければステージ移行。NO_FIRST_CRACK = なし）
+        // フェーズ（記録されたステージ変化から、投入〜排出）
+        uint16_t charge_s;      // 開始から投入までの秒（NO_CHARGE = 投入なし）
+        uint16_t phase_s[PhaseMetrics::PHASE_COUNT];    // 乾燥・メイラード・発達の秒
+        uint16_t dtr_deci;      // 発達時間比（0.1%）
+        uint16_t auc[PhaseMetrics::PHASE_COUNT];        // フェーズごとのAUC（°C·分）
+        uint8_t reserved[16];
+        uint16_t crc;
+    };
+
+    struct IndexHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t max_roasts;
+        uint32_t next_id;
+        uint32_t boot_count;
+        uint8_t reserved[14];
+        uint16_t crc;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(Record) == 8, "Record must stay 8 bytes");
+    static_assert(sizeof(Page) == PAGE_SIZE, "Page must be one flash page");
+    static_assert(sizeof(Entry) == 64, "Entry must stay 64 bytes");
+    static_assert(sizeof(IndexHeader) == 32, "IndexHeader must stay 32 bytes");
+
+    /**
+     * 保存済み焙煎の順次読み出し（CRCの通らないページで終了）
+     */
+    class Reader {
+    private:
+        FILE* file = nullptr;
+        FileHeader header = {};
+        Page page = {};
+        uint16_t pos = 0;
+        uint32_t next_seq = 0;
+
+        bool readPage();
+
+    public:
+        ~Reader() { close(); }
+        bool open(uint32_t roast_id);
+        bool openPath(const char* path);
+        void close();
+        bool next(Record& record);
+        const FileHeader& getHeader() const { return header; }
+    };
+
+private:
+    bool mounted = false;
+    IndexHeader index = {};
+    Entry entries[MAX_ROASTS];
+
+    // 記録中の焙煎
+    FILE* file = nullptr;
+    Entry* current = nullptr;
+    uint32_t period_ms = 1000;
+    uint32_t first_index = 0;
+    uint32_t last_index = 0;
+    PhaseMetrics phases;        // 記録中の焙煎のフェーズ集計
+    Page filling = {};
+    Page pending = {};          // 書き込み待ち（埋まったページ）
+    bool has_pending = false;
+    uint32_t page_seq = 0;
+
+    // 統計
+    uint32_t pages_written = 0;
+    uint32_t write_errors = 0;
+
+    // シングルトン
+    static RoastJournal* instance;
+
+    static void sealPage(Page& page, uint32_t seq);
+    static void sealEntry(Entry& entry);
+    static void accumulate(Entry& entry, uint32_t& first_index, PhaseMetrics& phases,
+                           uint32_t period_ms, const Record& record);
+    static void setFirstCrack(Entry& entry, uint32_t first_index, uint32_t period_ms, uint32_t sample_index);
+    static void storePhases(Entry& entry, const PhaseMetrics& phases);
+    static void makePath(char* buf, size_t size, const char* name);
+
+    void append(const Record& record);
+    bool writePending();
+    bool writeEntry(const Entry& entry);
+    bool writeIndexHeader();
+    bool writeIndex();
+    bool createIndex();
+    bool migrateIndex(FILE* f);
+    bool summarise(Entry& entry);
+    void recover(Entry& entry);
+    void abortRoast();
+
+public:
+    RoastJournal() {}
+
+    // ストレージのマウント・インデックス読み込み・電源断からの復旧
+    bool begin(uint32_t period_ms);
+    bool isReady() const { return mounted; }
+
+    // 記録
+    bool startRoast();
+    void addSample(uint32_t sample_index, float temp, uint8_t status);
+    void addEvent(RecordType type, uint8_t value);  // 直前のサンプル番号で記録
+    void addEvent(RecordType type, uint8_t value, uint32_t sample_index);  // 過去のサンプル（自動検出位置など）
+    bool finishRoast();
+    bool isRecording() const { return current != nullptr; }
+    uint32_t getCurrentId() const { return current ? current->id : 0; }
+
+    // 埋まったページの書き込み（loop() から毎回呼ぶ）
+    void service();
+
+    // ライブラリ：n = 0 が最新。範囲外・空きは nullptr
+    uint32_t getRoastCount() const;
+    const Entry* getRecent(uint32_t n) const;
+    const Entry* findRoast(uint32_t roast_id) const;
+
+    uint32_t getPagesWritten() const { return pages_written; }
+    uint32_t getWriteErrors() const { return write_errors; }
+
+    static void makeRoastPath(char* buf, size_t size, uint32_t roast_id);
+
+    // シングルトンインスタンス取得
+    static RoastJournal* getInstance() {
+        if (!instance) {
+            instance = new RoastJournal();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define JOURNAL RoastJournal::getInstance()
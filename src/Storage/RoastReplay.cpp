@@ -0,0 +1,119 @@
+#include "RoastReplay.h"
+
+// シングルトンインスタンス
+RoastReplay* RoastReplay::instance = nullptr;
+
+bool RoastReplay::start(uint32_t roast_id, uint8_t speed, uint32_t now_ms, int64_t base_us) {
+    stop();
+
+    if (roast_id == 0) {
+        const RoastJournal::Entry* latest = JOURNAL->getRecent(0);
+        if (!latest) {
+            M5_LOGW("Replay: no stored roast");
+            return false;
+        }
+        roast_id = latest->id;
+    }
+    if (!reader.open(roast_id)) {
+        M5_LOGW("Replay: roast %lu not found", (unsigned long)roast_id);
+        return false;
+    }
+
+    this->speed = speed;
+    this->period_ms = reader.getHeader().period_ms ? reader.getHeader().period_ms : 1000;
+    this->start_ms = now_ms;
+    this->base_us = base_us;
+    has_first = false;
+    last_index = 0;
+    has_pending = false;
+    recorded_stage = 0xFF;
+    recorded_fire = 0xFF;
+    summary = Summary();
+    summary.roast_id = roast_id;
+    active = true;
+    return true;
+}
+
+void RoastReplay::stop() {
+    reader.close();
+    active = false;
+    has_pending = false;
+}
+
+void RoastReplay::applyRecorded(const RoastJournal::Record& record) {
+    if (record.type == RoastJournal::REC_STAGE) {
+        if (recorded_stage != 0xFF && record.value8 != recorded_stage) summary.stage_changes++;
+        recorded_stage = record.value8;
+    } else if (record.type == RoastJournal::REC_FIRE) {
+        recorded_fire = record.value8;
+    }
+}
+
+bool RoastReplay::peek() {
+    if (has_pending) return true;
+    has_pending = reader.next(pending);
+    return has_pending;
+}
+
+bool RoastReplay::next(uint32_t now_ms, Item& item) {
+    while (active) {
+        if (!peek()) {
+            // 記録の終わり
+            summary.elapsed_ms = now_ms - start_ms;
+            stop();
+            return false;
+        }
+        const RoastJournal::Record& r = pending;
+
+        switch (r.type) {
+            case RoastJournal::REC_SAMPLE: {
+                if (!has_first) {
+                    first_index = r.sample_index;
+                    has_first = true;
+                }
+                uint32_t offset_ms = (r.sample_index - first_index) * period_ms;
+                if (speed != SPEED_MAX && now_ms - start_ms < offset_ms / speed) {
+                    return false;   // まだ時刻が来ていない
+                }
+                item.type = ITEM_SAMPLE;
+                item.value = 0;
+                item.status = r.value8;
+                item.index = r.sample_index;
+                item.timestamp_us = base_us + (int64_t)offset_ms * 1000;
+                item.temp = r.value16 == INT16_MIN ? NAN : r.value16 / 10.0f;
+                summary.samples++;
+                last_index = r.sample_index;
+                has_pending = false;
+                return true;
+            }
+            case RoastJournal::REC_GUIDE_START:
+            case RoastJournal::REC_FIRST_CRACK:
+                item.type = r.type == RoastJournal::REC_GUIDE_START ? ITEM_GUIDE_START : ITEM_FIRST_CRACK;
+                item.value = r.value8;
+                item.status = 0;
+                item.index = r.sample_index;
+                item.timestamp_us = 0;
+                item.temp = NAN;
+                has_pending = false;
+                return true;
+            default:
+                applyRecorded(r);
+                break;
+        }
+        has_pending = false;
+    }
+    return false;
+}
+
+void RoastReplay::compare(uint8_t live_stage, uint8_t live_fire) {
+    // 記録ではステージ・火力はそのサンプルの処理後に書かれている：同じサンプル番号の分を先に反映
+    while (active && peek() && pending.sample_index <= last_index &&
+           (pending.type == RoastJournal::REC_STAGE || pending.type == RoastJournal::REC_FIRE)) {
+        applyRecorded(pending);
+        has_pending = false;
+    }
+
+    // 記録はガイド動作中のみ：ガイドを使っていない焙煎は比較しない
+    if (recorded_stage != 0xFF && live_stage != recorded_stage) summary.stage_mismatch++;
+    if (recorded_fire != 0xFF && live_fire != recorded_fire) summary.fire_mismatch++;
+}
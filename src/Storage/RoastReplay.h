@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../HAL/Platform.h"
+#include "RoastJournal.h"
+
+/**
+ * 保存済み焙煎の再生（実機・ホスト共通）
+ *
+ * 機能：
+ * - 焙煎ジャーナルを1ページずつ読みながら、サンプルを実時間の1倍・10倍・最速で順に渡す
+ *   （最速は呼び出し1回につき1サンプル：実機では1ループ1サンプルとなり、描画・BLE込みの
+ *   1ティックの最悪コストをプロファイラで測れる）
+ * - サンプルの時刻は記録時の周期から合成（倍速でもRoR・ガイドの時間判定は記録時と同じ）
+ * - 操作イベント（ガイド開始・1ハゼ確認）も記録された位置で渡す
+ * - 記録されたステージ・推奨火力は渡さず、再生側の結果と比較して不一致を数える
+ *   （ガイドの変更を過去の実焙煎で比べる）
+ */
+class RoastReplay {
+public:
+    // 再生速度（倍率、SPEED_MAX = 待たずに次々）
+    static constexpr uint8_t SPEED_MAX = 0;
+
+    enum ItemType : uint8_t {
+        ITEM_SAMPLE,
+        ITEM_GUIDE_START,       // value：焙煎レベル
+        ITEM_FIRST_CRACK
+    };
+
+    struct Item {
+        ItemType type;
+        uint8_t value;
+        uint8_t status;         // ITEM_SAMPLE：センサーステータス
+        uint32_t index;         // サンプル番号（記録時のまま）
+        int64_t timestamp_us;   // 合成した時刻
+        float temp;             // status != 0 の場合は NAN
+    };
+
+    // 比較結果
+    struct Summary {
+        uint32_t roast_id;
+        uint32_t samples;
+        uint32_t stage_mismatch;    // 記録と再生でステージが異なったサンプル数
+        uint32_t fire_mismatch;     // 同じく推奨火力
+        uint32_t stage_changes;     // 記録されたステージ変化の数
+        uint32_t elapsed_ms;        // 再生にかかった実時間
+    };
+
+private:
+    RoastJournal::Reader reader;
+    bool active = false;
+    uint8_t speed = 1;
+    uint32_t period_ms = 1000;
+    uint32_t start_ms = 0;
+    int64_t base_us = 0;
+    uint32_t first_index = 0;
+    uint32_t last_index = 0;    // 最後に渡したサンプル
+    bool has_first = false;
+
+    // 先読みした1レコード（時刻が来るまで保持）
+    RoastJournal::Record pending;
+    bool has_pending = false;
+
+    // 記録側の状態（比較用）
+    uint8_t recorded_stage = 0xFF;
+    uint8_t recorded_fire = 0xFF;
+    Summary summary = {};
+
+    // シングルトン
+    static RoastReplay* instance;
+
+    bool peek();
+    void applyRecorded(const RoastJournal::Record& record);  // 記録されたステージ・火力
+
+public:
+    // roast_id = 0 は最新の焙煎。base_us は1サンプル目に付ける時刻
+    bool start(uint32_t roast_id, uint8_t speed, uint32_t now_ms, int64_t base_us);
+    void stop();
+    bool isActive() const { return active; }
+    uint8_t getSpeed() const { return speed; }
+
+    // 渡せる項目があれば true（サンプルは時刻が来ていなければ渡さない）
+    // 記録の終わりに達すると isActive() が false になる
+    bool next(uint32_t now_ms, Item& item);
+
+    // サンプル処理後の再生側の状態を記録と比較
+    void compare(uint8_t live_stage, uint8_t live_fire);
+
+    const Summary& getSummary() const { return summary; }
+
+    // シングルトンインスタンス取得
+    static RoastReplay* getInstance() {
+        if (!instance) {
+            instance = new RoastReplay();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define REPLAY RoastReplay::getInstance()
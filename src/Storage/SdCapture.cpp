@@ -0,0 +1,185 @@
+#include "SdCapture.h"
+#include <SPI.h>
+#include <M5Unified.h>
+#include <esp_timer.h>
+
+// シングルトンインスタンス
+SdCapture* SdCapture::instance = nullptr;
+
+bool SdCapture::begin() {
+    if (task_handle) return mounted;
+    path[0] = '\0';
+
+    // M5StackのSDスロット（LCDと同じSPIバス）
+    int8_t sclk = M5.getPin(m5::pin_name_t::sd_spi_sclk);
+    int8_t miso = M5.getPin(m5::pin_name_t::sd_spi_miso);
+    int8_t mosi = M5.getPin(m5::pin_name_t::sd_spi_mosi);
+    int8_t ss = M5.getPin(m5::pin_name_t::sd_spi_ss);
+    SPI.begin(sclk, miso, mosi, ss);
+    mounted = SD.begin(ss, SPI, SPI_FREQ);
+    if (!mounted) {
+        M5_LOGW("No microSD card, raw capture disabled");
+        return false;
+    }
+
+    BaseType_t result = xTaskCreatePinnedToCore(taskEntry, "sd_capture", TASK_STACK, this,
+                                                TASK_PRIORITY, &task_handle, TASK_CORE);
+    if (result != pdPASS) {
+        M5_LOGE("Failed to create SD capture task");
+        task_handle = nullptr;
+        mounted = false;
+        return false;
+    }
+    return true;
+}
+
+void SdCapture::start(uint32_t session_id, uint32_t raw_period_ms, uint32_t sample_period_ms) {
+    if (!task_handle) return;
+    request_session = session_id;
+    request_raw_period = raw_period_ms;
+    request_sample_period = sample_period_ms;
+    start_requested = true;
+    xTaskNotifyGive(task_handle);
+}
+
+void SdCapture::stop() {
+    if (!task_handle) return;
+    stop_requested = true;
+    xTaskNotifyGive(task_handle);
+}
+
+void SdCapture::push(const Record& record) {
+    if (!capturing) return;
+
+    // 書き込み待ちの面には書かない（SDが詰まっている間は捨てる）
+    if (ready[fill_block]) {
+        records_dropped = records_dropped + 1;
+        return;
+    }
+    blocks[fill_block][fill_count++] = record;
+    if (fill_count < RECORDS_PER_BLOCK) return;
+
+    ready[fill_block] = true;
+    fill_block ^= 1;
+    fill_count = 0;
+    xTaskNotifyGive(task_handle);
+}
+
+void SdCapture::taskEntry(void* arg) {
+    static_cast<SdCapture*>(arg)->taskLoop();
+}
+
+void SdCapture::taskLoop() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 埋まった面を古い順に：片面だけなら fill_block の反対側。両面なら push() は
+        // 2面目を埋めて fill_block を戻した後なので fill_block 側が古い
+        uint8_t oldest = (ready[0] && ready[1]) ? fill_block : fill_block ^ 1;
+        for (uint8_t i = 0; i < 2; i++) {
+            uint8_t b = oldest ^ i;
+            if (ready[b]) {
+                writeBlock(blocks[b], RECORDS_PER_BLOCK);
+                ready[b] = false;
+            }
+        }
+
+        if (stop_requested) {
+            stop_requested = false;
+            // 以降 push() は何もしない（取得タスクの方が優先度が高いので途中の push() はない）
+            capturing = false;
+            if (fill_count > 0) {
+                writeBlock(blocks[fill_block], fill_count);
+            }
+            closeFile();
+        }
+
+        if (start_requested) {
+            start_requested = false;
+            if (capturing) {
+                capturing = false;
+                if (fill_count > 0) writeBlock(blocks[fill_block], fill_count);
+                closeFile();
+            }
+            ready[0] = ready[1] = false;
+            fill_block = 0;
+            fill_count = 0;
+            if (openFile()) {
+                capturing = true;
+            }
+        }
+    }
+}
+
+bool SdCapture::openFile() {
+    // 焙煎ジャーナルと同じIDのファイル名（IDがなければ空いている番号）
+    uint32_t id = request_session;
+    if (id != 0) {
+        snprintf(path, sizeof(path), "/raw_%05lu.btr", (unsigned long)id);
+    } else {
+        for (uint32_t n = 1; n < 100000; n++) {
+            snprintf(path, sizeof(path), "/raw_x%05lu.btr", (unsigned long)n);
+            if (!SD.exists(path)) break;
+        }
+    }
+
+    file = SD.open(path, FILE_WRITE);
+    if (!file) {
+        M5_LOGE("SD capture: cannot create %s", path);
+        write_errors = write_errors + 1;
+        return false;
+    }
+
+    // ヘッダーは1ブロック分（以降の書き込みをブロック境界に揃える）
+    static uint8_t header_block[RawCaptureFormat::HEADER_SIZE];
+    memset(header_block, 0, sizeof(header_block));
+    RawCaptureFormat::Header* header = (RawCaptureFormat::Header*)header_block;
+    header->magic = RawCaptureFormat::MAGIC;
+    header->version = RawCaptureFormat::VERSION;
+    header->record_size = sizeof(Record);
+    header->header_size = RawCaptureFormat::HEADER_SIZE;
+    header->raw_period_ms = request_raw_period;
+    header->sample_period_ms = request_sample_period;
+    header->session_id = request_session;
+    header->start_ms = millis();
+    if (file.write(header_block, sizeof(header_block)) != sizeof(header_block)) {
+        M5_LOGE("SD capture: header write failed");
+        write_errors = write_errors + 1;
+        file.close();
+        return false;
+    }
+    file.flush();
+    M5_LOGI("SD capture: %s", path);
+    return true;
+}
+
+void SdCapture::closeFile() {
+    if (file) {
+        file.close();
+    }
+}
+
+bool SdCapture::writeBlock(const Record* records, size_t count) {
+    if (!file) return false;
+    int64_t start = esp_timer_get_time();
+    size_t bytes = count * sizeof(Record);
+    // セクター単位で書く：SPIバスロックは書き込み1回ごとに取り直されるため、
+    // LCD描画が待つのは最大1セクター分の転送（＋カードのbusy）に抑えられる
+    const uint8_t* data = (const uint8_t*)records;
+    bool ok = true;
+    for (size_t offset = 0; ok && offset < bytes; offset += SECTOR_SIZE) {
+        size_t n = bytes - offset < SECTOR_SIZE ? bytes - offset : SECTOR_SIZE;
+        ok = file.write(data + offset, n) == n;
+    }
+    file.flush();   // ディレクトリエントリ（ファイル長）を更新：電源断でも書けたブロックまでは残る
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+    if (elapsed > max_write_us) max_write_us = elapsed;
+
+    if (ok) {
+        records_written = records_written + count;
+    } else {
+        write_errors = write_errors + 1;
+        records_dropped = records_dropped + count;
+    }
+    return ok;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SD.h>
+#include "RawCaptureFormat.h"
+
+/**
+ * microSDへの生データ記録（10Hz、センサーステータス込み）
+ *
+ * 機能：
+ * - 取得タスクが push() で2面のブロックバッファへ詰める（ブロックしない・ロックなし）
+ * - 埋まったブロックは低優先度の書き込みタスクがBLOCK_SIZE単位で書き込み・flush
+ * - ファイルのオープン・クローズも書き込みタスクで行う（loop()はフラグを立てるだけ）
+ * - SDが詰まって両面が埋まっている間のレコードは捨てて数える（取得タスクはSDを待たない）
+ *
+ * 書き込みタスクは取得タスクと同じcore 0でより低い優先度：
+ * 書き込みタスクが動いている間、push() は途中で止まっていない（ブロックの受け渡しが単純になる）
+ *
+ * SDはLCDとSPIバスを共有する（排他はArduinoのSPIバスロック、トランザクション単位）。
+ * 書き込みはセクター単位に分けてロックを細かく手放すが、カードが書き込み中のbusyで
+ * 止まるとその間はバスを保持したまま（上限はSDドライバのbusyタイムアウト）。
+ * その間 loop() のLCD描画が待たされ、次のサンプル処理（安全チェックを含む）も遅れる。
+ * サンプルは取得キューに残るため失われず、遅れた分はまとめて処理される
+ */
+class SdCapture {
+public:
+    typedef RawCaptureFormat::Record Record;
+
+    static constexpr size_t BLOCK_SIZE = 4096;     // 4KBクラスタ（FAT32・小容量カードの既定）
+    static constexpr size_t RECORDS_PER_BLOCK = BLOCK_SIZE / sizeof(Record);
+    static constexpr size_t SECTOR_SIZE = 512;     // 1回の書き込み（SPIバスを保持する単位）
+
+private:
+    static constexpr uint32_t TASK_STACK = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 1;   // 取得タスク（3）より低い
+    static constexpr BaseType_t TASK_CORE = 0;
+    static constexpr uint32_t SPI_FREQ = 25000000;
+
+    // ダブルバッファ（push側：fill_block に詰める、書き込み側：ready のブロックを書く）
+    Record blocks[2][RECORDS_PER_BLOCK];
+    volatile bool ready[2] = {false, false};
+    uint8_t fill_block = 0;
+    uint16_t fill_count = 0;
+
+    // 状態（loop → 書き込みタスクへの要求）
+    volatile bool capturing = false;
+    volatile bool start_requested = false;
+    volatile bool stop_requested = false;
+    uint32_t request_session = 0;
+    uint32_t request_raw_period = 0;
+    uint32_t request_sample_period = 0;
+
+    bool mounted = false;
+    File file;
+    TaskHandle_t task_handle = nullptr;
+    char path[32];
+
+    // 統計（書き込みタスク・取得タスクのみ書き込み）
+    volatile uint32_t records_written = 0;
+    volatile uint32_t records_dropped = 0;
+    volatile uint32_t write_errors = 0;
+    volatile uint32_t max_write_us = 0;
+
+    // シングルトン
+    static SdCapture* instance;
+
+    static void taskEntry(void* arg);
+    void taskLoop();
+    bool openFile();
+    void closeFile();
+    bool writeBlock(const Record* records, size_t count);
+
+public:
+    SdCapture() {}
+
+    // カードをマウントし書き込みタスクを起動（カードがなければ false）
+    bool begin();
+    bool isMounted() const { return mounted; }
+
+    // 記録の開始・停止（loop()から、SDには触れない）
+    void start(uint32_t session_id, uint32_t raw_period_ms, uint32_t sample_period_ms);
+    void stop();
+    bool isCapturing() const { return capturing; }
+
+    // 取得タスクから：1読み出しを追加（ブロックしない）
+    void push(const Record& record);
+
+    // 統計
+    uint32_t getRecordsWritten() const { return records_written; }
+    uint32_t getRecordsDropped() const { return records_dropped; }
+    uint32_t getWriteErrors() const { return write_errors; }
+    uint32_t getMaxWriteUs() const { return max_write_us; }
+    const char* getPath() const { return path; }
+
+    // シングルトンインスタンス取得
+    static SdCapture* getInstance() {
+        if (!instance) {
+            instance = new SdCapture();
+        }
+        return instance;
+    }
+};
+
+// 便利なマクロ
+#define SD_CAPTURE SdCapture::getInstance()
@@ -6,13 +6,29 @@
 #include <BLE2902.h>
 #include <ArduinoJson.h>
 #include <stdarg.h>
+#include <esp_timer.h>
+#include <initializer_list>
 
 #include "Audio/MelodyPlayer.h"
 #include "Display/TickerFooter.h"
+#include "Display/GraphBackground.h"
+#include "Display/TextField.h"
 #include "Statistics/TemperatureStatistics.h"
 #include "Safety/SafetySystem.h"
 #include "BLE/BLEManager.h"
+#include "BLE/HistoryBackfill.h"
 #include "RoastGuide/RoastGuide.h"
+#include "RoastGuide/FireAdvisor.h"
+#include "RoastGuide/FirstCrackDetector.h"
+#include "RoastGuide/SampleProcessor.h"
+#include "Sensor/SensorAcquisition.h"
+#include "History/TemperatureHistory.h"
+#include "Storage/RoastJournal.h"
+#include "Storage/SdCapture.h"
+#include "Storage/RoastReplay.h"
+#include "Statistics/DerivativeEngine.h"
+#include "Profiling/LoopProfiler.h"
+#include "Profiling/TraceRecorder.h"
 
 #define KM_SDA   21
 #define KM_SCL   22
@@ -20,7 +36,8 @@
 #define KM_ADDR  KMETER_DEFAULT_ADDR
 
 constexpr uint16_t PERIOD_MS   = 1000;       // 1 秒周期
-constexpr uint16_t BUF_SIZE    = 900;        // 15 分記録
+constexpr uint16_t RAW_PERIOD_MS = 100;      // microSD生データ記録：10Hz（カードがある時のみ）
+constexpr uint16_t GRAPH_SPAN  = 900;        // グラフ表示幅：15 分（履歴自体は最大60分）
 constexpr float    TEMP_MIN    = 20.0f;      // グラフ下限
 constexpr float    TEMP_MAX    = 270.0f;     // グラフ上限（緊急停止域表示用）
 constexpr float    TEMP_DANGER = 245.0f;     // 危険温度
@@ -36,15 +53,12 @@ constexpr int16_t  GRAPH_H     = 240 - HEADER_HEIGHT - FOOTER_HEIGHT;  // 170px
 // セオドア提言：Sprite最適化用
 static LGFX_Sprite graph_sprite(&M5.Lcd);
 static bool sprite_initialized = false;
+constexpr uint8_t  GRAPH_SPRITE_DEPTH = 4;   // 4bitパレット（16bppの1/4、約25KB）
+uint32_t graph_push_us = 0;      // 直近のpushSprite所要時間
+uint32_t graph_push_max_us = 0;  // pushSprite最大所要時間
 
 constexpr uint8_t  LCD_BRIGHTNESS = 1;
 
-// 理想プロファイル定義
-struct ProfilePoint {
-  uint16_t sec;  // 経過秒
-  float    temp; // 目標温度 (°C)
-};
-
 // 各焙煎レベルの理想プロファイル（時刻と温度の折れ線）
 constexpr ProfilePoint PROFILE_LIGHT[] = {
   {   0,  25 },   // 投入直後 BT
@@ -106,14 +120,9 @@ enum SystemState {
 
 // RoastLevel, RoastStage, FirePower, and RoastTarget are now defined in RoastGuide module
 
-// セオドア提言：メモリ効率化のため int16_t に変更（0.1°C刻み）
-int16_t  buf[BUF_SIZE];  // 0.1°C単位で格納（例：25.3°C → 253）
-uint16_t head = 0;
-uint16_t count = 0;
+// 温度履歴はTemperatureHistory（多段解像度、0.1°C刻み int16_t）が保持
 
-
-M5UnitKmeterISO kmeter;
-uint32_t next_tick = 0;
+// センサー取得はSensorAcquisitionタスク（core 0）が担当
 uint8_t  km_err    = 0;
 float    current_temp = 0;
 
@@ -124,30 +133,64 @@ float last_temp = NAN;
 int16_t last_graph_x = -1;
 int16_t last_graph_y = -1;
 
-// セオドア提言：差分描画用キャッシュ変数
-float last_displayed_temp = NAN;
-float last_displayed_ror = NAN;
-RoastGuide::FirePower last_displayed_fire = RoastGuide::FIRE_OFF;
-RoastGuide::RoastStage last_displayed_stage = RoastGuide::STAGE_PREHEAT;
-uint32_t last_displayed_time = 0;
-bool last_roast_guide_state = false;
-int last_ror_wait_seconds = -1;
+// 差分描画用テキストフィールド（前回の文字列・領域を保持し、変化時のみ再描画）
+// ヘッダー
+TextField hdr_temp(&fonts::lgfxJapanGothic_16);
+TextField hdr_fire(&fonts::lgfxJapanGothic_16);
+TextField hdr_ror(&fonts::lgfxJapanGothic_12);
+TextField hdr_stage(&fonts::lgfxJapanGothic_12);
+TextField hdr_time(&fonts::lgfxJapanGothic_12);
+// フッター（ボタン説明）
+TextField footer_text(&fonts::lgfxJapanGothic_12);
+// 統計画面
+TextField stats_current(&fonts::lgfxJapanGothic_16);
+TextField stats_max(&fonts::lgfxJapanGothic_16);
+TextField stats_min(&fonts::lgfxJapanGothic_16);
+TextField stats_avg(&fonts::lgfxJapanGothic_16);
+TextField stats_count(&fonts::lgfxJapanGothic_16);
+// RoR画面
+TextField ror_current(&fonts::lgfxJapanGothic_16);
+TextField ror_projection(&fonts::lgfxJapanGothic_16);
+TextField ror_eval(&fonts::lgfxJapanGothic_16);
+TextField ror_trend_label(&fonts::lgfxJapanGothic_12);
+// ガイド画面
+TextField guide_title(&fonts::lgfxJapanGothic_16);
+TextField guide_time(&fonts::lgfxJapanGothic_16);
+TextField guide_phase(&fonts::lgfxJapanGothic_12);
+TextField guide_maintain(&fonts::lgfxJapanGothic_16);
+TextField guide_next(&fonts::lgfxJapanGothic_16);
+TextField guide_min_time(&fonts::lgfxJapanGothic_16);
+TextField guide_ror_range(&fonts::lgfxJapanGothic_16);
+TextField guide_fire(&fonts::lgfxJapanGothic_16);
+TextField guide_temp_eval(&fonts::lgfxJapanGothic_16);
+TextField guide_ror_eval(&fonts::lgfxJapanGothic_16);
+TextField guide_crack_prompt(&fonts::lgfxJapanGothic_12);
+TextField guide_drop(&fonts::lgfxJapanGothic_12);
+TextField guide_pred(&fonts::lgfxJapanGothic_12);
+int guide_drawn_stage = -1;   // 描画済みのプログレスバー状態
+int guide_drawn_detail = -1;
+
+// 画面クリア後にまとめて再描画を強制
+void invalidateFields(std::initializer_list<TextField*> fields) {
+  for (TextField* field : fields) field->invalidate();
+}
 
 
 // RoR (Rate of Rise) calculation
 float current_ror = 0.0f;
 float current_ror_15s = 0.0f;  // 15秒RoR for quick response
-float ror_buf[BUF_SIZE];
-uint16_t ror_count = 0;
-constexpr uint16_t ROR_INTERVAL = 60;  // 60 seconds for RoR calculation
-constexpr uint16_t ROR_INTERVAL_15S = 15;  // 15 seconds for quick RoR
+float decision_ror = 0.0f;  // 判断用の平滑化RoR（ガイド・火力推奨が参照）
+constexpr DerivativeEngine::SmoothingMode ROR_SMOOTHING_MODE = DerivativeEngine::SMOOTHING_KALMAN;
+uint16_t ror_count = 0;  // 履歴中でRoRが有効なサンプル数（1秒段の範囲まで）
+constexpr uint8_t ROR_INTERVAL = DerivativeEngine::WINDOW_60S;  // 60 seconds for RoR calculation
+constexpr uint8_t ROR_INTERVAL_15S = DerivativeEngine::WINDOW_15S;  // 15 seconds for quick RoR
 
 // Stall detection
 bool stall_warning_active = false;
 uint32_t last_stall_check = 0;
 
 // Safety features
-bool first_crack_confirmation_needed = false;
+bool crack_heard_logged = false;  // 自動検出の後に操作者が聞いた1ハゼを記録済み
 bool first_crack_confirmed = false;
 
 
@@ -162,10 +205,6 @@ int stage_beep_durations[3] = {200, 200, 300};
 
 // セオドア提言：非ブロッキングメロディシステム
 
-// 非ブロッキング初期化待機
-static uint32_t init_retry_timer = 0;
-static bool init_waiting = false;
-
 // 非ブロッキング復旧成功表示
 static uint32_t recovery_display_start = 0;
 static bool recovery_display_active = false;
@@ -175,7 +214,29 @@ static uint32_t ble_restart_timer = 0;
 static bool ble_restart_pending = false;
 
 // 火力推奨
-static RoastGuide::FirePower last_recommended_fire = RoastGuide::FIRE_MEDIUM;
+
+// 保存済み焙煎の再生（REPLAY_DONE：再生し終えた曲線を表示したまま、Button Cで待機へ）
+enum ReplayState : uint8_t {
+  REPLAY_OFF = 0,
+  REPLAY_PLAYING,
+  REPLAY_DONE
+};
+static ReplayState replay_state = REPLAY_OFF;
+
+// ガイドの時計：最後に処理したサンプルの時刻（再生中は記録時の周期から合成した時刻）
+static uint32_t sample_clock_ms = 0;
+
+// ループプロファイラ操作（BLE CMD_PROFILER のpayload、シリアルコマンドと共通）
+enum ProfilerAction : uint8_t {
+  PROFILER_DUMP = 0,
+  PROFILER_ENABLE = 1,
+  PROFILER_DISABLE = 2,
+  PROFILER_RESET = 3
+};
+constexpr uint8_t PROFILER_IDLE = 0xFF;
+constexpr size_t SERIAL_TX_FIFO = 128;  // ESP32 UARTのハードウェアFIFO
+static uint8_t profile_serial_line = PROFILER_IDLE;  // 出力中の行（IDLE = なし）
+static uint8_t profile_ble_line = PROFILER_IDLE;
 
 // セオドア提言：BLE差分パケット送信システム
 static uint32_t last_full_data_send = 0;
@@ -200,33 +261,22 @@ const MelodyPlayer::Melody PROGMEM MELODY_COMPLETION = {{392, 523, 392, 523, 392
 // Temperature prediction for gas burner
 class TemperaturePredictor {
 private:
-  float temp_history[10];
-  int history_index = 0;
-  bool history_full = false;
+  static constexpr uint8_t RECENT_WINDOW = 10;  // 直近10秒
   
 public:
-  void addTemperature(float temp) {
-    temp_history[history_index] = temp;
-    history_index = (history_index + 1) % 10;
-    if (history_index == 0) history_full = true;
-  }
-  
   float predictTemperatureIn30s() {
-    if (!history_full && history_index < 3) return current_temp;
+    if (DERIVATIVE->getSampleCount() < 3) return current_temp;
     
     float recent_ror = calculateRecentRoR();
     return current_temp + (recent_ror * 0.5f);  // 30秒後の予測
   }
   
+  // 直近の差分RoR（データが揃うまでは利用可能な最長窓）
   float calculateRecentRoR() {
-    int samples = history_full ? 10 : history_index;
-    if (samples < 2) return 0.0f;
-    
-    // 正しい最古インデックスの計算
-    int oldestIdx = history_full ? history_index : 0;
-    float oldest = temp_history[oldestIdx];
-    float newest = temp_history[(history_index - 1 + 10) % 10];
-    return (newest - oldest) / samples * 60.0f;  // °C/分
+    uint32_t available = DERIVATIVE->getSampleCount();
+    if (available < 2) return 0.0f;
+    uint8_t window = (available > RECENT_WINDOW) ? RECENT_WINDOW : (uint8_t)(available - 1);
+    return DERIVATIVE->getRoR(window);  // °C/分
   }
 };
 
@@ -245,13 +295,10 @@ inline void updateMelodyWrapper() {
 
 // ティッカーフッターラッパー関数
 inline void addTickerMessageWrapper(const char* format, ...) {
-    char buffer[128];
     va_list args;
     va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    TICKER->addMessageV(format, args);  // 整形は1回だけ
     va_end(args);
-    
-    TICKER->addMessage("%s", buffer);
 }
 
 inline void updateTickerFooterWrapper() {
@@ -268,62 +315,22 @@ inline bool isTickerEnabledWrapper() {
 
 
 
-// セオドア提言：温度バッファの型変換ヘルパー関数
-inline void setTempToBuffer(uint16_t index, float temp) {
-  buf[index] = (int16_t)(temp * 10.0f);  // 0.1°C刻みで格納
+// 履歴アクセスヘルパー（ago = 0 が最新サンプル）
+inline uint32_t getSampleCount() {
+  return HISTORY->getTotalSamples();
 }
 
-inline float getTempFromBuffer(uint16_t index) {
-  return buf[index] * 0.1f;  // float に戻す
-}
-
-// セオドア提言：転換点検出用の移動平均RoR計算
-float calculateMovingAverageRoR(int window_size = 5) {
-  if (count < window_size + 1) return 0.0f;
-  
-  float sum_ror = 0.0f;
-  int valid_samples = 0;
-  
-  for (int i = 1; i <= window_size; i++) {
-    uint16_t current_idx = (head - i + BUF_SIZE) % BUF_SIZE;
-    uint16_t prev_idx = (head - i - 1 + BUF_SIZE) % BUF_SIZE;
-    
-    float current_temp = getTempFromBuffer(current_idx);
-    float prev_temp = getTempFromBuffer(prev_idx);
-    
-    // 1秒間隔でのRoR計算
-    float point_ror = (current_temp - prev_temp) * 60.0f;  // °C/min
-    sum_ror += point_ror;
-    valid_samples++;
-  }
-  
-  return valid_samples > 0 ? sum_ror / valid_samples : 0.0f;
+inline float getTempAgo(uint16_t ago) {
+  return HISTORY->getTemp(ago);
 }
 
 // セオドア提言：転換点検出（RoRの符号反転を検出）
 bool detectTurningPoint() {
-  if (count < 10) return false;  // 最低10サンプル必要
-  
-  float current_ma_ror = calculateMovingAverageRoR(3);  // 短期移動平均
-  float prev_ma_ror = 0.0f;
+  if (DERIVATIVE->getSampleCount() < 10) return false;  // 最低10サンプル必要
   
-  // 3秒前の移動平均RoRを計算
-  if (count >= 13) {
-    // 一時的にheadを3つ戻して計算
-    uint16_t temp_head = (head - 3 + BUF_SIZE) % BUF_SIZE;
-    uint16_t temp_count = count - 3;
-    
-    float sum_ror = 0.0f;
-    for (int i = 1; i <= 3; i++) {
-      uint16_t current_idx = (temp_head - i + BUF_SIZE) % BUF_SIZE;
-      uint16_t prev_idx = (temp_head - i - 1 + BUF_SIZE) % BUF_SIZE;
-      
-      float current_temp = getTempFromBuffer(current_idx);
-      float prev_temp = getTempFromBuffer(prev_idx);
-      sum_ror += (current_temp - prev_temp) * 60.0f;
-    }
-    prev_ma_ror = sum_ror / 3.0f;
-  }
+  // 短期(3秒)RoRと、その3秒前の短期RoRをエンジンからO(1)で参照
+  float current_ma_ror = DERIVATIVE->getRoR(3);
+  float prev_ma_ror = DERIVATIVE->getRoR(3, 3);
   
   // 転換点条件：負から正への転換（±1°C/minの閾値）
   return (prev_ma_ror < -1.0f && current_ma_ror > 1.0f);
@@ -365,18 +372,36 @@ bool btnB_long_press_handled = false;
 constexpr uint32_t LONG_PRESS_DURATION = 2000;  // 2 seconds
 
 void drawGraph();
-void drawIdealCurve(const ProfilePoint* profile, size_t len);
+void prepareGraphBackground();
+void pushGraphSprite();
 void drawCurrentValue();
 void drawStats();
 void drawRoR();
 void drawGuide();
+void drawPhaseMetrics(int x, int y);
 void addNewGraphPoint();
 void handleButtons();
+uint8_t handleRemoteCommand(const BLEManager::Command& command);
+bool startMonitoring();
+void stopMonitoring();
+void startRoastGuide(RoastGuide::RoastLevel level);
+bool confirmFirstCrackAction();
+void notifyFirstCrackAccepted();
+bool canLogHeardFirstCrack();
+bool clearAllData();
+void resetRoastData();
+bool isLiveRoastRunning();
+bool startReplay(uint32_t roast_id, uint8_t speed);
+bool nextSample(SensorAcquisition::Sample& sample);
+void reportReplay();
+void startJournal();
+void onRawReading(const SensorAcquisition::RawReading& reading);
+void setDisplayMode(DisplayMode mode);
+bool applyProfilerAction(uint8_t action, bool to_ble);
+void handleSerialCommands();
+void serviceProfileDump();
 void drawStandbyScreen();
 float getAverageTemp();
-float calculateRoR();
-float calculateRoR15s();
-void updateRoRBuffer();
 void drawRoastLevelSelection();
 // RoastTarget getRoastTarget now delegated to RoastGuide module
 // const char* getRoastLevelName now delegated to RoastGuide module
@@ -385,14 +410,13 @@ uint32_t getRoastElapsedTime();
 float getStageElapsedTime();
 void sendBLEData();
 const char* getFirePowerName(RoastGuide::FirePower fire);
-RoastGuide::FirePower calculateRecommendedFire();
 void playBeep(int duration_ms, int frequency = 1000);
 // playMelody is now handled by MelodyPlayer class
 void playStageChangeBeep();
 void playCriticalWarningBeep();
-void updateFirePowerRecommendation();
+void notifyFirePowerRecommendation(bool changed);
 void forceNextStage();
-void checkEmergencyConditions();
+void showSafetyWarnings();
 void handleNonBlockingBeeps();
 float getNextStageKeyTemp(RoastGuide::RoastStage stage, RoastGuide::RoastLevel level);
 const char* getGasAdjustmentAdvice(RoastGuide::FirePower current_fire, RoastGuide::FirePower target_fire);
@@ -413,22 +437,17 @@ inline float getAverageTemp() {
   return TEMP_STATS->getAverage();
 }
 
-inline void updateStats(float temp) {
-  TEMP_STATS->addTemperature(temp);
-}
-
 inline void resetStats() {
   TEMP_STATS->reset();
 }
 
 inline void recalculateStatsFromBuffer() {
-  // Create a temporary float buffer for the statistics module
-  float* temp_buf = new float[count];
-  for (uint16_t i = 0; i < count; i++) {
-    temp_buf[i] = getTempFromBuffer((head - count + i + BUF_SIZE) % BUF_SIZE);
-  }
-  TEMP_STATS->recalculateFromBuffer(temp_buf, count, count);
-  delete[] temp_buf;
+  // 履歴の共通クエリから統計を再構築（間引き段はmin/max/meanをそのまま反映）
+  TEMP_STATS->reset();
+  HISTORY->forEach(0, getSampleCount(), [](const TemperatureHistory::Point& p) {
+    TEMP_STATS->addSummary(p.min * 0.1f, p.max * 0.1f, p.mean * 0.1f, p.span);
+    return true;
+  });
 }
 
 // BLE接続状態ラッパー関数
@@ -445,16 +464,17 @@ inline const char* getStageName(RoastGuide::RoastStage stage) {
   return stage_names[(int)stage];
 }
 
+// JSON用：小数2桁に丸める（String一時オブジェクトを作らない）
+inline double round2(float value) {
+  return round(value * 100.0) / 100.0;
+}
+
 inline RoastGuide::FirePower getRecommendedFire() {
   if (!ROAST_GUIDE->isActive()) return RoastGuide::FIRE_MEDIUM;
-  auto target = ROAST_GUIDE->getRoastTarget(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
+  const RoastGuide::RoastTarget& target = ROAST_GUIDE->getCurrentTarget();
   return target.fire;
 }
 
-// Helper variables for timing (managed locally)
-static uint32_t roast_start_time = 0;
-static uint32_t stage_start_time = 0;
-
 // Ticker wrapper function (needs to be after statistics wrappers)
 inline void updateTickerSystemInfoWrapper() {
     // モジュラー版では、TickerFooterが自動的にシステム情報を収集する
@@ -471,11 +491,11 @@ inline void updateTickerSystemInfoWrapper() {
             
             // BLE接続状態
             if (isBLEConnected()) {
-                TICKER->addMessage("BLE接続中");
+                TICKER->addMessage("BLE接続中 (MTU %u)", BLE_MGR->getMtu());
             }
             
             // 統計情報
-            if (count > 60) {
+            if (getSampleCount() > 60) {
                 TICKER->addMessage("平均温度: %.1f°C | 最高: %.1f°C", getAverageTemp(), getMaxTemp());
             }
         }
@@ -499,7 +519,7 @@ inline void setEmergencyActive(bool active) {
   if (!active) {
     SAFETY->resetEmergency();
   }
-  // Note: Setting to true is handled by checkEmergencyConditions
+  // Note: Setting to true is handled by SampleProcessor (SAFETY->checkEmergencyConditions)
 }
 
 inline void executeAutoRecovery() {
@@ -520,8 +540,13 @@ void setup() {
   M5.begin(cfg);
   
   // セオドア提言：Sprite初期化（真のスクロール実装）
-  graph_sprite.createSprite(GRAPH_W, GRAPH_H);
-  sprite_initialized = true;
+  // パレット付きSpriteでBLE（Bluedroid）用のヒープを確保
+  GRAPH_BG->begin(GRAPH_W, GRAPH_H, TEMP_MIN, TEMP_MAX, GRAPH_SPAN);
+  uint32_t heap_before = ESP.getFreeHeap();
+  sprite_initialized = GRAPH_BG->createSprite(graph_sprite, GRAPH_SPRITE_DEPTH);
+  M5_LOGI("Graph sprite %dbpp: %u bytes, free heap %u -> %u",
+          GRAPH_BG->getColorDepth(), (unsigned)GRAPH_BG->getSpriteBytes(),
+          heap_before, ESP.getFreeHeap());
 
   // MelodyPlayer初期化
   MELODY_PLAYER->begin();
@@ -532,27 +557,80 @@ void setup() {
   // TemperatureStatistics初期化
   TEMP_STATS->begin();
 
-  // SafetySystem初期化
+  // SafetySystem初期化（チェック自体は SampleProcessor が毎サンプル行う）
   SAFETY->begin();
+  SAFETY->setBeepCallback(playBeep);
+  SAFETY->setEmergencyCallback([]() {
+    // Emergency stop - handled by RoastGuide
+    ROAST_GUIDE->stop();
+    M5.Lcd.fillScreen(TFT_RED);
+    M5.Lcd.setTextColor(TFT_WHITE, TFT_RED);
+    M5.Lcd.setFont(&fonts::lgfxJapanGothic_36);
+    M5.Lcd.setCursor(50, 100);
+    M5.Lcd.printf("EMERGENCY STOP!");
+  });
 
   // RoastGuide初期化
   ROAST_GUIDE->begin();
 
+  // 温度履歴・微分エンジン初期化
+  HISTORY->begin();
+  DERIVATIVE->begin();
+  DERIVATIVE->setSmoothingMode(ROR_SMOOTHING_MODE);
+
   // I2C明示的初期化（M5Unifiedの実装変更に対応）
   Wire.begin(KM_SDA, KM_SCL, I2C_FREQ);
   
-  // 非ブロッキング初期化（セオドア提言：スタートアップも非ブロッキング化）
-  if (!kmeter.begin(&Wire, KM_ADDR, KM_SDA, KM_SCL, I2C_FREQ)) {
-    M5_LOGE("KMeterISO not found…再試行中");
-    init_waiting = true;
-    init_retry_timer = millis();
-    // 初期化失敗時は一旦setup()を抜けてloop()で再試行
-    return;
+  // microSD生データ記録：カードがあれば取得タスクを10Hzにして全読み出しを渡す
+  if (SD_CAPTURE->begin()) {
+    SENSOR_ACQ->setRawCallback(onRawReading, RAW_PERIOD_MS);
+  }
+
+  // センサー取得タスク起動（core 0固定、未検出時の再試行もタスク内で非ブロッキング処理）
+  SENSOR_ACQ->begin(&Wire, KM_ADDR, KM_SDA, KM_SCL, I2C_FREQ, PERIOD_MS);
+  PROFILER->setTickPeriod(PERIOD_MS * 1000);
+
+  // 焙煎ジャーナル（LittleFS）：前回電源断で記録中だった焙煎はここで復旧
+  if (!JOURNAL->begin(PERIOD_MS)) {
+    M5_LOGE("Roast journal unavailable, roasts will not be saved");
   }
 
   // BLEManager初期化
   BLE_MGR->begin("M5Stack-Thermometer");
   
+  // バイナリテレメトリ用の現在値（ヒープ確保なし）
+  BLE_MGR->setTelemetryRequestCallback([](TelemetryProtocol::Snapshot& snap) {
+    uint32_t total = getSampleCount();
+    snap.sample_index = total > 0 ? total - 1 : 0;
+    snap.timestamp_ms = millis();
+    snap.temp = current_temp;
+    snap.ror = current_ror;
+    snap.ror_smooth = decision_ror;
+    snap.temp_min = total > 0 ? getMinTemp() : NAN;
+    snap.temp_max = total > 0 ? getMaxTemp() : NAN;
+    snap.temp_avg = total > 0 ? getAverageTemp() : NAN;
+    snap.elapsed_s = getRoastElapsedTime();
+    snap.missed = SENSOR_ACQ->getMissedCount();
+    snap.flags = (system_state == STATE_RUNNING ? TelemetryProtocol::FLAG_RUNNING : 0) |
+                 (ROAST_GUIDE->isActive() ? TelemetryProtocol::FLAG_GUIDE_ACTIVE : 0) |
+                 (km_err != 0 ? TelemetryProtocol::FLAG_SENSOR_ERROR : 0);
+    snap.stage = ROAST_GUIDE->getCurrentStage();
+    snap.fire = getRecommendedFire();
+    snap.level = ROAST_GUIDE->getSelectedLevel();
+    snap.smoothing = DERIVATIVE->getSmoothingMode();
+
+    const PhaseMetrics& phases = ROAST_GUIDE->getPhaseMetrics();
+    snap.phase = ROAST_GUIDE->isActive() ? phases.getPhase() : PhaseMetrics::NO_PHASE;
+    for (uint8_t i = 0; i < PhaseMetrics::PHASE_COUNT; i++) {
+      snap.phase_s[i] = phases.getPhaseSeconds((PhaseMetrics::Phase)i);
+      snap.auc[i] = phases.getAUC((PhaseMetrics::Phase)i);
+    }
+    snap.since_tp_s = phases.getSinceTurningPoint();
+  });
+  
+  // RXコマンド（BLEManagerが処理しないもの）
+  BLE_MGR->setCommandCallback(handleRemoteCommand);
+  
   // データ要求コールバック設定
   BLE_MGR->setDataRequestCallback([](JsonDocument& doc, bool fullData) {
     // この関数はsendBLEDataの内容を移植
@@ -563,13 +641,28 @@ void setup() {
     }
     
     doc["timestamp"] = millis();
-    doc["temp"] = serialized(String(current_temp, 2));
-    doc["ror"] = serialized(String(current_ror, 2));
+    doc["temp"] = round2(current_temp);
+    doc["ror"] = round2(current_ror);
     doc["state"] = system_state;
     
     if (fullData) {
       doc["mode"] = display_mode;
-      doc["count"] = count;
+      doc["count"] = getSampleCount();
+      doc["ror_smooth"] = round2(decision_ror);
+      doc["ror_filter"] = DERIVATIVE->getSmoothingModeName();
+      
+      // サンプリング健全性（欠落・遅延・リング溢れ）
+      JsonObject acq = doc["acq"].to<JsonObject>();
+      acq["missed"] = SENSOR_ACQ->getMissedCount();
+      acq["late"] = SENSOR_ACQ->getLateCount();
+      acq["dropped"] = SENSOR_ACQ->getDroppedCount();
+      
+      // 描画負荷とヒープ（グラフSpriteの色深度による差の確認用）
+      JsonObject gfx = doc["gfx"].to<JsonObject>();
+      gfx["depth"] = GRAPH_BG->getColorDepth();
+      gfx["push_us"] = graph_push_us;
+      gfx["push_max_us"] = graph_push_max_us;
+      gfx["heap"] = ESP.getFreeHeap();
       
       if (ROAST_GUIDE->isActive()) {
         JsonObject roast = doc["roast"].to<JsonObject>();
@@ -578,13 +671,33 @@ void setup() {
         roast["stage"] = getStageName(ROAST_GUIDE->getCurrentStage());  // Helper function needed
         roast["elapsed"] = getRoastElapsedTime();
         roast["fire"] = getFirePowerName(getRecommendedFire());  // Helper function needed
+        roast["crack_conf"] = round2(CRACK_DETECTOR->getConfidence());
+        roast["crack_auto"] = CRACK_DETECTOR->isDetected();
+
+        // フェーズ集計（投入後のみ）
+        const PhaseMetrics& phases = ROAST_GUIDE->getPhaseMetrics();
+        if (phases.isCharged()) {
+          JsonObject phase = roast["phases"].to<JsonObject>();
+          phase["total"] = round2(phases.getTotalSeconds());
+          phase["dtr"] = round2(phases.getDTR());
+          phase["since_tp"] = round2(phases.getSinceTurningPoint());
+          JsonArray secs = phase["s"].to<JsonArray>();
+          JsonArray pct = phase["pct"].to<JsonArray>();
+          JsonArray auc = phase["auc"].to<JsonArray>();
+          for (uint8_t i = 0; i < PhaseMetrics::PHASE_COUNT; i++) {
+            PhaseMetrics::Phase p = (PhaseMetrics::Phase)i;
+            secs.add(round2(phases.getPhaseSeconds(p)));
+            pct.add(round2(phases.getPhasePercent(p)));
+            auc.add(round2(phases.getAUC(p)));
+          }
+        }
       }
       
-      if (count > 0) {
+      if (getSampleCount() > 0) {
         JsonObject stats = doc["stats"].to<JsonObject>();
-        stats["min"] = serialized(String(getMinTemp(), 2));
-        stats["max"] = serialized(String(getMaxTemp(), 2));
-        stats["avg"] = serialized(String(getAverageTemp(), 2));
+        stats["min"] = round2(getMinTemp());
+        stats["max"] = round2(getMaxTemp());
+        stats["avg"] = round2(getAverageTemp());
       }
     }
   });
@@ -596,18 +709,16 @@ void setup() {
   // Initialize statistics
   resetStats();
   current_ror = 0.0f;
+  decision_ror = 0.0f;
   ror_count = 0;
   
   // Initialize roast guide through RoastGuide module
   ROAST_GUIDE->stop();  // Ensure it's stopped
   // Other roast guide state now managed by RoastGuide module
-  first_crack_confirmation_needed = false;
   first_crack_confirmed = false;
   
   // Draw initial standby screen
   drawStandbyScreen();
-  
-  next_tick = millis();
 }
 
 
@@ -615,229 +726,137 @@ void setup() {
  * セオドア提言：差分描画によるフラッシュ防止ヘッダー描画
  */
 void drawCurrentValue() {
-  bool needs_full_clear = need_full_redraw;
-  
   // 全体クリアが必要な場合のみ実行
-  if (needs_full_clear) {
+  if (need_full_redraw) {
     M5.Lcd.fillRect(0, 0, 320, HEADER_HEIGHT, TFT_BLACK);
-    // キャッシュをリセットして全体再描画を促す
-    last_displayed_temp = NAN;
-    last_displayed_ror = NAN;
-    last_displayed_fire = (RoastGuide::FirePower)-1;
-    last_displayed_stage = (RoastGuide::RoastStage)-1;
-    last_displayed_time = UINT32_MAX;
-    last_roast_guide_state = !ROAST_GUIDE->isActive();
-    last_ror_wait_seconds = -1;
-  }
-  
-  // 1. メイン温度表示（変化時のみ更新）
-  if (needs_full_clear || abs(current_temp - last_displayed_temp) > 0.05f) {
-    // テキスト領域のみクリア
-    M5.Lcd.fillRect(0, 5, 200, 16, TFT_BLACK);
-    M5.Lcd.setCursor(0, 5);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-    M5.Lcd.setTextColor(TFT_WHITE);
-    M5.Lcd.printf("TEMP: %6.2f C", current_temp);
-    last_displayed_temp = current_temp;
+    invalidateFields({&hdr_temp, &hdr_fire, &hdr_ror, &hdr_stage, &hdr_time});
   }
   
-  // 2. 火力推奨インジケーター表示（変化時のみ）
-  bool fire_display_needed = (ROAST_GUIDE->isActive() && system_state == STATE_RUNNING);
-  RoastGuide::FirePower current_recommended_fire = getRecommendedFire();
-  if (needs_full_clear || 
-      fire_display_needed != last_roast_guide_state ||
-      (fire_display_needed && current_recommended_fire != last_displayed_fire)) {
-    
-    // 火力表示領域をクリア
-    M5.Lcd.fillRect(220, 5, 100, 16, TFT_BLACK);
+  // 1. メイン温度表示（文字列が変化した時のみ更新）
+  hdr_temp.printf(0, 5, TFT_WHITE, "TEMP: %6.2f C", current_temp);
+  
+  // 2. 火力推奨インジケーター表示
+  if (ROAST_GUIDE->isActive() && system_state == STATE_RUNNING) {
+    RoastGuide::FirePower current_recommended_fire = getRecommendedFire();
     
-    if (fire_display_needed) {
-      M5.Lcd.setCursor(220, 5);
-      M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-      
-      // 火力に応じて色を変える
-      uint16_t fire_color = TFT_WHITE;
-      switch(current_recommended_fire) {
-        case RoastGuide::FIRE_OFF: fire_color = TFT_DARKGREY; break;
-        case RoastGuide::FIRE_VERY_LOW: fire_color = TFT_BLUE; break;
-        case RoastGuide::FIRE_LOW: fire_color = TFT_CYAN; break;
-        case RoastGuide::FIRE_MEDIUM: fire_color = TFT_YELLOW; break;
-        case RoastGuide::FIRE_HIGH: fire_color = TFT_ORANGE; break;
-        case RoastGuide::FIRE_VERY_HIGH: fire_color = TFT_RED; break;
-      }
-      
-      M5.Lcd.setTextColor(fire_color);
-      M5.Lcd.printf("[%s]", getFirePowerName(current_recommended_fire));
-      M5.Lcd.setTextColor(TFT_WHITE);
+    // 火力に応じて色を変える
+    uint16_t fire_color = TFT_WHITE;
+    switch(current_recommended_fire) {
+      case RoastGuide::FIRE_OFF: fire_color = TFT_DARKGREY; break;
+      case RoastGuide::FIRE_VERY_LOW: fire_color = TFT_BLUE; break;
+      case RoastGuide::FIRE_LOW: fire_color = TFT_CYAN; break;
+      case RoastGuide::FIRE_MEDIUM: fire_color = TFT_YELLOW; break;
+      case RoastGuide::FIRE_HIGH: fire_color = TFT_ORANGE; break;
+      case RoastGuide::FIRE_VERY_HIGH: fire_color = TFT_RED; break;
     }
-    last_displayed_fire = current_recommended_fire;
-    last_roast_guide_state = fire_display_needed;
-  }
-  
-  // 3. RoR表示（変化時のみ）
-  bool ror_changed = false;
-  if (count >= ROR_INTERVAL) {
-    ror_changed = (abs(current_ror - last_displayed_ror) > 0.05f);
+    hdr_fire.printf(220, 5, fire_color, "[%s]", getFirePowerName(current_recommended_fire));
   } else {
-    int wait_seconds = ROR_INTERVAL - count;
-    ror_changed = (wait_seconds != last_ror_wait_seconds);
-    last_ror_wait_seconds = wait_seconds;
+    hdr_fire.clear();
   }
   
-  if (needs_full_clear || ror_changed) {
-    M5.Lcd.fillRect(0, 25, 140, 12, TFT_BLACK);
-    M5.Lcd.setCursor(0, 25);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.setTextColor(TFT_WHITE);
-    if (count >= ROR_INTERVAL) {
-      M5.Lcd.printf("RoR: %.1f C/min", current_ror);
-      last_displayed_ror = current_ror;
-    } else {
-      M5.Lcd.printf("RoR: Wait %ds", ROR_INTERVAL - count);
-    }
+  // 3. RoR表示
+  if (DERIVATIVE->isReady(ROR_INTERVAL)) {
+    hdr_ror.printf(0, 25, TFT_WHITE, "RoR: %.1f C/min", current_ror);
+  } else {
+    hdr_ror.printf(0, 25, TFT_WHITE, "RoR: Wait %ds", (int)DERIVATIVE->samplesUntilReady(ROR_INTERVAL));
   }
   
-  // 4. 焙焙ステージ情報（変化時のみ）
+  // 4. 焙焙ステージ情報（ガイド停止時は消去）
   if (ROAST_GUIDE->isActive()) {
-    RoastGuide::RoastStage current_stage = ROAST_GUIDE->getCurrentStage();
-    if (needs_full_clear || current_stage != last_displayed_stage) {
-      M5.Lcd.fillRect(150, 25, 170, 12, TFT_BLACK);
-      M5.Lcd.setCursor(150, 25);
-      M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-      M5.Lcd.setTextColor(TFT_WHITE);
-      M5.Lcd.printf("Stage: %s", getStageName(current_stage));
-      last_displayed_stage = current_stage;
-    }
-    
     uint32_t current_elapsed = getRoastElapsedTime();
-    if (needs_full_clear || current_elapsed != last_displayed_time) {
-      M5.Lcd.fillRect(0, 35, 120, 12, TFT_BLACK);
-      M5.Lcd.setCursor(0, 35);
-      M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-      M5.Lcd.setTextColor(TFT_WHITE);
-      M5.Lcd.printf("Time: %02d:%02d", current_elapsed / 60, current_elapsed % 60);
-      last_displayed_time = current_elapsed;
-    }
-  } else if (last_roast_guide_state != ROAST_GUIDE->isActive()) {
-    // 焙焙ガイドが停止した場合、関連領域をクリア
-    M5.Lcd.fillRect(150, 25, 170, 12, TFT_BLACK);
-    M5.Lcd.fillRect(0, 35, 120, 12, TFT_BLACK);
-    last_roast_guide_state = ROAST_GUIDE->isActive();
+    hdr_stage.printf(150, 25, TFT_WHITE, "Stage: %s", getStageName(ROAST_GUIDE->getCurrentStage()));
+    hdr_time.printf(0, 35, TFT_WHITE, "Time: %02d:%02d", current_elapsed / 60, current_elapsed % 60);
+  } else {
+    hdr_stage.clear();
+    hdr_time.clear();
   }
 }
 
 /**
- * 現在の buf 内容でグラフを再描画
+ * 選択中ローストレベルの背景レイヤー（危険域・理想曲線）を用意
+ * レベルが変わった時だけ再計算する
  */
-void drawIdealCurve(const ProfilePoint* profile, size_t len) {
-  if (!sprite_initialized || !profile || len < 2) return;
-
-  // ドット間隔ピクセル
-  constexpr int DOT_STEP = 4;
-
-  for (size_t i = 1; i < len; ++i) {
-    // 区間の２端
-    float t0 = profile[i - 1].sec;
-    float v0 = profile[i - 1].temp;
-    float t1 = profile[i].sec;
-    float v1 = profile[i].temp;
-
-    // 区間を 1 秒刻みで線形補間しドットを置く
-    for (uint16_t s = t0; s <= t1; ++s) {
-      // 1 s → 1 px で 15 分グラフ (900 s) に収まる
-      float x_ratio = (float)s / (BUF_SIZE - 1);        // 0.0 – 1.0
-      int   x = x_ratio * GRAPH_W;
-
-      // 線形補間温度
-      float f = (t1 > t0) ? (float)(s - t0) / (t1 - t0) : 0;
-      float temp = v0 + f * (v1 - v0);
-
-      // 温度を Y 座標へ
-      float y_ratio = (temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN);
-      int   y = GRAPH_H - y_ratio * GRAPH_H;
-
-      // ドット間隔ごとに描画（範囲チェック付き）
-      if ((s % DOT_STEP) == 0 && x >= 0 && x < GRAPH_W && y >= 0 && y < GRAPH_H) {
-        graph_sprite.drawPixel(x, y, TFT_DARKGREY);
-      }
-    }
-  }
-}
-
-void drawGraph() {
-  if (count == 0 || !sprite_initialized) return;
-
-  // 画面上の枠線を描画
-  M5.Lcd.fillRect(GRAPH_X0-1, GRAPH_Y0-1, GRAPH_W+2, GRAPH_H+2, TFT_BLACK);
-  M5.Lcd.drawRect(GRAPH_X0-1, GRAPH_Y0-1, GRAPH_W+2, GRAPH_H+2, TFT_WHITE);
-  
-  // Sprite内容をクリアして背景を再構築
-  graph_sprite.fillSprite(TFT_BLACK);
-  
-  // ローストレベル依存の危険域表示（Sprite内）
-  float current_danger_temp = getDangerTemp(ROAST_GUIDE->getSelectedLevel());
-  float current_critical_temp = getCriticalTemp(ROAST_GUIDE->getSelectedLevel());
-  
-  // セオドア提言：色覚配慮の危険域表示（Sprite座標系で）
-  float danger_y_start = GRAPH_H - (current_danger_temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
-  float danger_y_end = GRAPH_H - (current_critical_temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
-  
-  // 注意域（Danger〜Critical）
-  if (danger_y_start > danger_y_end) {
-    graph_sprite.fillRect(0, (int)danger_y_end, GRAPH_W, (int)(danger_y_start - danger_y_end), TFT_OLIVE);
-  }
-  
-  // 緊急停止域（Critical〜TEMP_MAX）縞模様
-  int critical_height = (int)danger_y_end;
-  for (int y = 0; y < critical_height; y += 4) {
-    uint16_t color = (y % 8 < 4) ? TFT_RED : TFT_DARKGREY;
-    graph_sprite.drawFastHLine(0, y, GRAPH_W, color);
-  }
+void prepareGraphBackground() {
+  RoastGuide::RoastLevel level = ROAST_GUIDE->getSelectedLevel();
+  if (GRAPH_BG->isBuiltFor(level)) return;
 
-  // 理想曲線を描画（背景として）
-  switch (ROAST_GUIDE->getSelectedLevel()) {
+  const ProfilePoint* profile = nullptr;
+  size_t len = 0;
+  switch (level) {
     case RoastGuide::ROAST_LIGHT:
     case RoastGuide::ROAST_MEDIUM_LIGHT:
-      drawIdealCurve(PROFILE_LIGHT, sizeof(PROFILE_LIGHT)/sizeof(ProfilePoint));
+      profile = PROFILE_LIGHT;
+      len = sizeof(PROFILE_LIGHT)/sizeof(ProfilePoint);
       break;
     case RoastGuide::ROAST_MEDIUM:
-      drawIdealCurve(PROFILE_MEDIUM, sizeof(PROFILE_MEDIUM)/sizeof(ProfilePoint));
+      profile = PROFILE_MEDIUM;
+      len = sizeof(PROFILE_MEDIUM)/sizeof(ProfilePoint);
       break;
     case RoastGuide::ROAST_MEDIUM_DARK:
-      drawIdealCurve(PROFILE_MEDIUM_DARK, sizeof(PROFILE_MEDIUM_DARK)/sizeof(ProfilePoint));
+      profile = PROFILE_MEDIUM_DARK;
+      len = sizeof(PROFILE_MEDIUM_DARK)/sizeof(ProfilePoint);
       break;
     case RoastGuide::ROAST_DARK:
-      drawIdealCurve(PROFILE_DARK, sizeof(PROFILE_DARK)/sizeof(ProfilePoint));
+      profile = PROFILE_DARK;
+      len = sizeof(PROFILE_DARK)/sizeof(ProfilePoint);
       break;
     case RoastGuide::ROAST_FRENCH:
-      drawIdealCurve(PROFILE_FRENCH, sizeof(PROFILE_FRENCH)/sizeof(ProfilePoint));
+      profile = PROFILE_FRENCH;
+      len = sizeof(PROFILE_FRENCH)/sizeof(ProfilePoint);
       break;
     default:
       break;
   }
 
-  // 折れ線をSprite内に描画
-  uint16_t start = (count < BUF_SIZE) ? 0 : head;
+  GRAPH_BG->build(level, getDangerTemp(level), getCriticalTemp(level), profile, len);
+}
+
+/**
+ * グラフSpriteを画面へ転送（パレット→RGB565変換込みの所要時間を計測）
+ */
+void pushGraphSprite() {
+  uint32_t start = micros();
+  graph_sprite.pushSprite(GRAPH_X0, GRAPH_Y0);
+  graph_push_us = micros() - start;
+  if (graph_push_us > graph_push_max_us) graph_push_max_us = graph_push_us;
+}
+
+void drawGraph() {
+  if (getSampleCount() == 0 || !sprite_initialized) return;
+
+  // 画面上の枠線を描画
+  M5.Lcd.fillRect(GRAPH_X0-1, GRAPH_Y0-1, GRAPH_W+2, GRAPH_H+2, TFT_BLACK);
+  M5.Lcd.drawRect(GRAPH_X0-1, GRAPH_Y0-1, GRAPH_W+2, GRAPH_H+2, TFT_WHITE);
+  
+  // 事前計算済みの背景レイヤーを転写（危険域・理想曲線）
+  prepareGraphBackground();
+  GRAPH_BG->render(graph_sprite);
+
+  // 折れ線をSprite内に描画（直近15分、古い区間は間引き段の平均値）
+  uint32_t total = getSampleCount();
+  uint32_t start = (total < GRAPH_SPAN) ? 0 : total - GRAPH_SPAN;
   float prevX = -1, prevY = -1;
-  for (uint16_t i = 0; i < count; ++i) {
-    uint16_t idx = (start + i) % BUF_SIZE;
-    float v = getTempFromBuffer(idx);
+  HISTORY->forEach(start, total, [&](const TemperatureHistory::Point& p) {
+    float v = p.mean * 0.1f;
 
     // 範囲外は無視
-    if (v < TEMP_MIN || v > TEMP_MAX) continue;
+    if (v < TEMP_MIN || v > TEMP_MAX) return true;
 
-    float x = (float)i / (BUF_SIZE - 1) * GRAPH_W;
-    float y = GRAPH_H - (v - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
+    // 間引き点はバケット中央に配置
+    float pos = (p.index < start) ? 0.0f : (float)(p.index - start) + (p.span - 1) * 0.5f;
+    float x = pos / (GRAPH_SPAN - 1) * GRAPH_W;
+    float y = GRAPH_BG->tempToY(v);
 
     if (prevX >= 0) {
-      graph_sprite.drawLine((int)prevX, (int)prevY, (int)x, (int)y, TFT_CYAN);
+      graph_sprite.drawLine((int)prevX, (int)prevY, (int)x, (int)y, GRAPH_BG->ink(GraphBackground::GC_CYAN));
     }
     prevX = x;
     prevY = y;
-  }
+    return true;
+  });
 
   // Spriteを画面に転送
-  graph_sprite.pushSprite(GRAPH_X0, GRAPH_Y0);
+  pushGraphSprite();
   
   // 画面上に軸ラベルを描画（Sprite外）
   M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
@@ -901,9 +920,7 @@ void handleButtons() {
         recovery_display_active = true;
       } else {
         // 通常のモード切り替え
-        display_mode = (DisplayMode)((display_mode + 1) % MODE_COUNT);
-        need_full_redraw = true;
-        M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
+        setDisplayMode((DisplayMode)((display_mode + 1) % MODE_COUNT));
       }
     }
     
@@ -935,6 +952,7 @@ void handleButtons() {
           M5.Lcd.setTextColor(TFT_WHITE);
           feedback_start = millis();
           feedback_active = true;
+          need_full_redraw = true;  // 次の描画でオーバーレイを消す
         } else if (millis() - feedback_start > 300) {
           need_full_redraw = true;
           feedback_active = false;
@@ -944,30 +962,9 @@ void handleButtons() {
   } else if (btnB_press_start > 0) {
     // Button released - short press
     if (!btnB_long_press_handled) {
-      // 1ハゼ確認処理
-      if (ROAST_GUIDE->isFirstCrackConfirmationNeeded()) {
-        ROAST_GUIDE->confirmFirstCrack();
-        first_crack_confirmation_needed = false;
-        
-        // 視覚的フィードバック（非ブロッキング化）
-        static uint32_t crack_feedback_start = 0;
-        static bool crack_feedback_active = false;
-        
-        if (!crack_feedback_active) {
-          M5.Lcd.fillRect(60, 100, 200, 40, TFT_BLACK);
-          M5.Lcd.drawRect(60, 100, 200, 40, TFT_GREEN);
-          M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-          M5.Lcd.setTextColor(TFT_GREEN);
-          M5.Lcd.setCursor(70, 115);
-          M5.Lcd.printf("1ST CRACK CONFIRMED");
-          M5.Lcd.setTextColor(TFT_WHITE);
-          playBeep(200, 1200);
-          crack_feedback_start = millis();
-          crack_feedback_active = true;
-        } else if (millis() - crack_feedback_start > 300) {
-          need_full_redraw = true;
-          crack_feedback_active = false;
-        }
+      // 1ハゼ確認処理（自動検出後は聞いた時刻の記録）
+      if (ROAST_GUIDE->isFirstCrackConfirmationNeeded() || canLogHeardFirstCrack()) {
+        confirmFirstCrackAction();
       } else if (display_mode == MODE_GUIDE && !ROAST_GUIDE->isActive()) {
         // 焙煎レベル変更
         ROAST_GUIDE->cycleRoastLevel();
@@ -991,40 +988,9 @@ void handleButtons() {
     // Check for long press (2 seconds)
     uint32_t now = millis();
     if (!btnC_long_press_handled && (now - btnC_press_start) >= LONG_PRESS_DURATION) {
-      // Long press: Clear all data and reset emergency state
-      count = 0;
-      head = 0;
-      resetStats();
-      current_ror = 0.0f;
-      ror_count = 0;
-      // Reset roast guide state
-      ROAST_GUIDE->stop();
-      setEmergencyActive(false);  // Theodore提言：緊急停止状態もリセット
-      need_full_redraw = true;
-      
-      // Visual feedback for clear（非ブロッキング化）
-      static uint32_t clear_feedback_start = 0;
-      static bool clear_feedback_active = false;
-      
-      if (!clear_feedback_active) {
-        M5.Lcd.fillScreen(TFT_BLACK);
-        M5.Lcd.setFont(&fonts::lgfxJapanGothic_24);
-        M5.Lcd.setCursor(80, 120);
-        M5.Lcd.println("*** DATA CLEARED ***");
-        clear_feedback_start = millis();
-        clear_feedback_active = true;
-      } else if (millis() - clear_feedback_start > 500) {
-        clear_feedback_active = false;
-        
-        if (system_state == STATE_RUNNING) {
-          M5.Lcd.fillScreen(TFT_BLACK);
-          M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-          M5.Lcd.setCursor(0, 0);
-          M5.Lcd.println("Real-Time Temperature");
-          need_full_redraw = true;
-        } else {
-          drawStandbyScreen();
-        }
+      // Long press: Clear all data and reset emergency state（再生中は無視：Cの短押しで先に停止）
+      if (!clearAllData()) {
+        addTickerMessageWrapper("再生中はクリアできません（Cで停止）");
       }
       
       btnC_long_press_handled = true;
@@ -1034,27 +1000,13 @@ void handleButtons() {
     if (!btnC_long_press_handled) {
       // Short press: Start/Stop toggle
       if (system_state == STATE_STANDBY) {
-        // Start monitoring
-        system_state = STATE_RUNNING;
-        M5.Lcd.fillScreen(TFT_BLACK);
-        M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-        M5.Lcd.setCursor(0, 0);
-        M5.Lcd.println("Real-Time Temperature");
-        need_full_redraw = true;
-        next_tick = millis();
+        startMonitoring();
       } else {
         // Stop monitoring or start roast guide
         if (display_mode == MODE_GUIDE && !ROAST_GUIDE->isActive()) {
-          // 焙煎ガイド開始
-          ROAST_GUIDE->start(ROAST_GUIDE->getSelectedLevel());
-          stage_start_temp = current_temp;
-          roast_start_time = millis();
-          stage_start_time = millis();
+          startRoastGuide(ROAST_GUIDE->getSelectedLevel());
         } else {
-          // Stop monitoring
-          system_state = STATE_STANDBY;
-          ROAST_GUIDE->stop();
-          drawStandbyScreen();
+          stopMonitoring();
         }
       }
     }
@@ -1062,106 +1014,514 @@ void handleButtons() {
   }
 }
 
+/**
+ * 操作（ボタンとBLEリモートコマンドで共通）
+ */
+// 再生中は受け付けない（再生がサンプルの流れを占有している：先に停止する）
+bool startMonitoring() {
+  if (replay_state != REPLAY_OFF) return false;
+  if (system_state == STATE_RUNNING) return true;
+  system_state = STATE_RUNNING;
+  M5.Lcd.fillScreen(TFT_BLACK);
+  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+  M5.Lcd.setCursor(0, 0);
+  M5.Lcd.println("Real-Time Temperature");
+  need_full_redraw = true;
+  SENSOR_ACQ->discardPending();  // 待機中に溜まった古いサンプルは使わない
+  sample_clock_ms = (uint32_t)(esp_timer_get_time() / 1000);
+  startJournal();
+  SD_CAPTURE->start(JOURNAL->getCurrentId(), SENSOR_ACQ->getRawPeriodMs(), PERIOD_MS);
+  return true;
+}
+
+void stopMonitoring() {
+  if (system_state == STATE_STANDBY) return;
+  system_state = STATE_STANDBY;
+  JOURNAL->finishRoast();
+  SD_CAPTURE->stop();
+  REPLAY->stop();
+  replay_state = REPLAY_OFF;
+  ROAST_GUIDE->stop();
+  drawStandbyScreen();
+}
+
+void startRoastGuide(RoastGuide::RoastLevel level) {
+  SAMPLE_PROCESSOR->startGuide(level, sample_clock_ms);
+  crack_heard_logged = false;
+  stage_start_temp = current_temp;
+  need_full_redraw = true;  // 選択画面からガイド画面へ切り替え
+}
+
+bool confirmFirstCrackAction() {
+  if (!ROAST_GUIDE->isFirstCrackConfirmationNeeded()) {
+    // 自動検出済み：操作者が聞いた時刻を手動確認として記録だけ残す（検出器の評価の正解）
+    if (!canLogHeardFirstCrack()) return false;
+    crack_heard_logged = true;
+    JOURNAL->addEvent(RoastJournal::REC_FIRST_CRACK, 0);
+    playBeep(100, 1200);
+    return true;
+  }
+  ROAST_GUIDE->confirmFirstCrack();
+  JOURNAL->addEvent(RoastJournal::REC_FIRST_CRACK, 0);
+  
+  // 視覚的フィードバック（非ブロッキング化）
+  static uint32_t crack_feedback_start = 0;
+  static bool crack_feedback_active = false;
+  
+  if (!crack_feedback_active) {
+    M5.Lcd.fillRect(60, 100, 200, 40, TFT_BLACK);
+    M5.Lcd.drawRect(60, 100, 200, 40, TFT_GREEN);
+    M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+    M5.Lcd.setTextColor(TFT_GREEN);
+    M5.Lcd.setCursor(70, 115);
+    M5.Lcd.printf("1ST CRACK CONFIRMED");
+    M5.Lcd.setTextColor(TFT_WHITE);
+    playBeep(200, 1200);
+    crack_feedback_start = millis();
+    crack_feedback_active = true;
+    need_full_redraw = true;  // 次の描画でオーバーレイを消す
+  } else if (millis() - crack_feedback_start > 300) {
+    need_full_redraw = true;
+    crack_feedback_active = false;
+  }
+  return true;
+}
+
+// RoRの形から検出した1ハゼをガイドが受け付けた（記録は SampleProcessor）：音で知らせる
+// ボタンでの確認も引き続き可能（聞いた時刻として記録）
+void notifyFirstCrackAccepted() {
+  M5_LOGI("1st crack detected at sample %lu, accepted at %lu (confidence %u%%)",
+          (unsigned long)CRACK_DETECTOR->getDetectedIndex(), (unsigned long)(getSampleCount() - 1),
+          (unsigned)lroundf(CRACK_DETECTOR->getConfidence() * 100.0f));
+  playBeep(200, 1200);
+  need_full_redraw = true;
+}
+
+bool canLogHeardFirstCrack() {
+  return ROAST_GUIDE->isActive() && CRACK_DETECTOR->isDetected() && !crack_heard_logged &&
+         ROAST_GUIDE->getCurrentStage() < RoastGuide::STAGE_FINISH;
+}
+
+bool clearAllData() {
+  // 再生中は受け付けない（ガイドを止めても再生はサンプルを流し続けるため）
+  if (replay_state != REPLAY_OFF) return false;
+  // 画面上の曲線は消すが、ジャーナルでは閉じて保存し新しい焙煎として続ける
+  if (system_state == STATE_RUNNING) {
+    JOURNAL->finishRoast();
+    startJournal();
+  }
+  resetRoastData();
+  
+  // Visual feedback for clear（非ブロッキング化）
+  static uint32_t clear_feedback_start = 0;
+  static bool clear_feedback_active = false;
+  
+  if (!clear_feedback_active) {
+    M5.Lcd.fillScreen(TFT_BLACK);
+    M5.Lcd.setFont(&fonts::lgfxJapanGothic_24);
+    M5.Lcd.setCursor(80, 120);
+    M5.Lcd.println("*** DATA CLEARED ***");
+    clear_feedback_start = millis();
+    clear_feedback_active = true;
+  } else if (millis() - clear_feedback_start > 500) {
+    clear_feedback_active = false;
+    
+    if (system_state == STATE_RUNNING) {
+      M5.Lcd.fillScreen(TFT_BLACK);
+      M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+      M5.Lcd.setCursor(0, 0);
+      M5.Lcd.println("Real-Time Temperature");
+      need_full_redraw = true;
+    } else {
+      drawStandbyScreen();
+    }
+  }
+  return true;
+}
+
+// 履歴・統計・RoR・ガイド・緊急停止状態を初期化（データクリアと再生開始で共通）
+void resetRoastData() {
+  HISTORY->clear();
+  DERIVATIVE->reset();
+  resetStats();
+  current_ror = 0.0f;
+  decision_ror = 0.0f;
+  ror_count = 0;
+  // Reset roast guide state
+  ROAST_GUIDE->stop();
+  setEmergencyActive(false);  // Theodore提言：緊急停止状態もリセット
+  need_full_redraw = true;
+}
+
+/**
+ * 保存済み焙煎の再生：センサーの代わりにジャーナルのサンプルを実機と同じ処理に流す
+ * roast_id = 0 は最新、speed は倍率（RoastReplay::SPEED_MAX = 1ループ1サンプルで最速）
+ * ガイドの時計は合成したサンプル時刻のため、倍速・最速でも記録時と同じ時間で判定する
+ * 実測中は受け付けない（記録・SD取得・画面の曲線を誤操作で失わないため、先に停止する）
+ */
+bool isLiveRoastRunning() {
+  return system_state == STATE_RUNNING && replay_state == REPLAY_OFF;
+}
+
+bool startReplay(uint32_t roast_id, uint8_t speed) {
+  if (isLiveRoastRunning()) return false;
+  stopMonitoring();
+  int64_t base_us = esp_timer_get_time();
+  if (!REPLAY->start(roast_id, speed, millis(), base_us)) return false;
+  resetRoastData();
+  sample_clock_ms = (uint32_t)(base_us / 1000);
+  PROFILER->reset();  // 再生中の1ループの最悪値を見る
+  replay_state = REPLAY_PLAYING;
+  system_state = STATE_RUNNING;
+  SAMPLE_PROCESSOR->reset();
+  M5.Lcd.fillScreen(TFT_BLACK);
+  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+  M5.Lcd.setCursor(0, 0);
+  M5.Lcd.printf("Replay #%lu", (unsigned long)REPLAY->getSummary().roast_id);
+  SENSOR_ACQ->discardPending();
+  return true;
+}
+
+// 次に処理するサンプル（通常は取得タスクのリング、再生中はジャーナル）
+bool nextSample(SensorAcquisition::Sample& sample) {
+  if (replay_state == REPLAY_OFF) return SENSOR_ACQ->popSample(sample);
+
+  SENSOR_ACQ->discardPending();
+  // 再生は1ループ1サンプル（最速でも毎サンプル描画・BLE送信まで通す）
+  static bool replay_taken = false;
+  if (replay_taken) {
+    replay_taken = false;
+    return false;
+  }
+  RoastReplay::Item item;
+  while (REPLAY->next(millis(), item)) {
+    if (item.type == RoastReplay::ITEM_GUIDE_START) {
+      if (item.value < RoastGuide::ROAST_COUNT) {
+        ROAST_GUIDE->setSelectedLevel((RoastGuide::RoastLevel)item.value);
+        startRoastGuide((RoastGuide::RoastLevel)item.value);
+      }
+    } else if (item.type == RoastReplay::ITEM_FIRST_CRACK) {
+      // 記録された自動検出は流さない（再生側の検出器がもう一度判定する）
+      if (item.value == 0) confirmFirstCrackAction();
+    } else {
+      sample.index = item.index;
+      sample.timestamp_us = item.timestamp_us;
+      sample.temp = item.temp;
+      sample.status = item.status;
+      replay_taken = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void reportReplay() {
+  const RoastReplay::Summary& s = REPLAY->getSummary();
+  const LoopProfiler::Stats& loop_stats = PROFILER->getStats(LoopProfiler::SEC_LOOP);
+  Serial.printf("replay roast=%lu samples=%lu elapsed_ms=%lu stage_changes=%lu stage_mismatch=%lu "
+                "fire_mismatch=%lu loop_max_us=%lu\n",
+                (unsigned long)s.roast_id, (unsigned long)s.samples, (unsigned long)s.elapsed_ms,
+                (unsigned long)s.stage_changes, (unsigned long)s.stage_mismatch,
+                (unsigned long)s.fire_mismatch, (unsigned long)(loop_stats.max / hal::cpuMhz()));
+  M5.Lcd.fillRect(0, 0, 320, 20, TFT_BLACK);
+  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+  M5.Lcd.setCursor(0, 0);
+  M5.Lcd.printf("Replay #%lu done", (unsigned long)s.roast_id);
+}
+
+void setDisplayMode(DisplayMode mode) {
+  display_mode = mode;
+  need_full_redraw = true;
+  if (system_state == STATE_RUNNING) {
+    M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
+  }
+}
+
+/**
+ * BLEリモートコマンド（RX）の実行：戻り値はACKで返す結果
+ * ボタン操作と同じ関数を呼ぶため、画面・ビープの反応も同じ
+ */
+uint8_t handleRemoteCommand(const BLEManager::Command& command) {
+  switch (command.opcode) {
+    case BLEManager::CMD_BACKFILL: {
+      if (command.length < 4) return TelemetryProtocol::ACK_BAD_PAYLOAD;
+      // チャンクはバイナリ（改行区切りのJSONストリームには混ぜられない）
+      if (BLE_MGR->getProtocol() != TelemetryProtocol::PROTOCOL_BINARY) return TelemetryProtocol::ACK_REJECTED;
+      uint32_t from = (uint32_t)command.payload[0] |
+                      ((uint32_t)command.payload[1] << 8) |
+                      ((uint32_t)command.payload[2] << 16) |
+                      ((uint32_t)command.payload[3] << 24);
+      BACKFILL->start(from);
+      return TelemetryProtocol::ACK_OK;
+    }
+    
+    case BLEManager::CMD_START:
+      return startMonitoring() ? TelemetryProtocol::ACK_OK : TelemetryProtocol::ACK_REJECTED;
+    
+    case BLEManager::CMD_STOP:
+      stopMonitoring();
+      return TelemetryProtocol::ACK_OK;
+    
+    case BLEManager::CMD_SET_LEVEL:
+      if (command.length < 1 || command.payload[0] >= RoastGuide::ROAST_COUNT) return TelemetryProtocol::ACK_BAD_PAYLOAD;
+      if (ROAST_GUIDE->isActive()) return TelemetryProtocol::ACK_REJECTED;
+      ROAST_GUIDE->setSelectedLevel((RoastGuide::RoastLevel)command.payload[0]);
+      need_full_redraw = true;
+      return TelemetryProtocol::ACK_OK;
+    
+    case BLEManager::CMD_START_GUIDE: {
+      if (command.length >= 1 && command.payload[0] >= RoastGuide::ROAST_COUNT) return TelemetryProtocol::ACK_BAD_PAYLOAD;
+      if (system_state != STATE_RUNNING || ROAST_GUIDE->isActive()) return TelemetryProtocol::ACK_REJECTED;
+      RoastGuide::RoastLevel level = command.length >= 1
+        ? (RoastGuide::RoastLevel)command.payload[0]
+        : ROAST_GUIDE->getSelectedLevel();
+      ROAST_GUIDE->setSelectedLevel(level);
+      startRoastGuide(level);
+      return TelemetryProtocol::ACK_OK;
+    }
+    
+    case BLEManager::CMD_CONFIRM_FIRST_CRACK:
+      return confirmFirstCrackAction() ? TelemetryProtocol::ACK_OK : TelemetryProtocol::ACK_REJECTED;
+    
+    case BLEManager::CMD_CLEAR_DATA:
+      return clearAllData() ? TelemetryProtocol::ACK_OK : TelemetryProtocol::ACK_REJECTED;
+    
+    case BLEManager::CMD_SET_DISPLAY_MODE:
+      if (command.length < 1) return TelemetryProtocol::ACK_BAD_PAYLOAD;
+      if (command.payload[0] == 0xFF) {
+        setDisplayMode((DisplayMode)((display_mode + 1) % MODE_COUNT));
+      } else if (command.payload[0] < MODE_COUNT) {
+        setDisplayMode((DisplayMode)command.payload[0]);
+      } else {
+        return TelemetryProtocol::ACK_BAD_PAYLOAD;
+      }
+      return TelemetryProtocol::ACK_OK;
+    
+    case BLEManager::CMD_PROFILER:
+      return applyProfilerAction(command.length >= 1 ? command.payload[0] : PROFILER_DUMP, true)
+        ? TelemetryProtocol::ACK_OK : TelemetryProtocol::ACK_BAD_PAYLOAD;
+    
+    case BLEManager::CMD_REPLAY: {
+      uint8_t speed = command.length >= 1 ? command.payload[0] : 1;
+      uint32_t id = 0;
+      if (command.length >= 5) {
+        id = (uint32_t)command.payload[1] |
+             ((uint32_t)command.payload[2] << 8) |
+             ((uint32_t)command.payload[3] << 16) |
+             ((uint32_t)command.payload[4] << 24);
+      }
+      if (isLiveRoastRunning()) return TelemetryProtocol::ACK_REJECTED;
+      return startReplay(id, speed) ? TelemetryProtocol::ACK_OK : TelemetryProtocol::ACK_REJECTED;
+    }
+    
+    default:
+      return TelemetryProtocol::ACK_UNKNOWN_OPCODE;
+  }
+}
+
+/**
+ * ループプロファイラの操作（シリアル・BLE共通）
+ * 結果の出力は1ループ1行ずつ（シリアル送信・BLEキューでloopを止めない）
+ */
+bool applyProfilerAction(uint8_t action, bool to_ble) {
+  switch (action) {
+    case PROFILER_DUMP:
+      if (to_ble) {
+        profile_ble_line = 0;
+      } else {
+        profile_serial_line = 0;
+      }
+      return true;
+    case PROFILER_ENABLE:
+      PROFILER->setEnabled(true);
+      return true;
+    case PROFILER_DISABLE:
+      PROFILER->setEnabled(false);
+      return true;
+    case PROFILER_RESET:
+      PROFILER->reset();
+      return true;
+    default:
+      return false;
+  }
+}
+
+// シリアルの1文字コマンド：p = 結果出力, e = 有効, d = 無効, r = リセット
+// t = イベントトレース出力, x = トレース記録の有効/無効, c = microSD記録の状態
+// y = 最新の焙煎を10倍速で再生, Y = 最速で再生
+void handleSerialCommands() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    switch (c) {
+      case 'p': applyProfilerAction(PROFILER_DUMP, false); break;
+      case 'e': applyProfilerAction(PROFILER_ENABLE, false); Serial.println("profiler on"); break;
+      case 'd': applyProfilerAction(PROFILER_DISABLE, false); Serial.println("profiler off"); break;
+      case 'r': applyProfilerAction(PROFILER_RESET, false); Serial.println("profiler reset"); break;
+      case 't': TRACE->beginDump(); break;
+      case 'x':
+        TRACE->setEnabled(!TRACE->isEnabled());
+        Serial.println(TRACE->isEnabled() ? "trace on" : "trace off");
+        break;
+      case 'c':
+        Serial.printf("sd %s %s written=%lu dropped=%lu errors=%lu max_write_us=%lu\n",
+                      SD_CAPTURE->isMounted() ? (SD_CAPTURE->isCapturing() ? "capturing" : "idle") : "none",
+                      SD_CAPTURE->getPath(),
+                      (unsigned long)SD_CAPTURE->getRecordsWritten(),
+                      (unsigned long)SD_CAPTURE->getRecordsDropped(),
+                      (unsigned long)SD_CAPTURE->getWriteErrors(),
+                      (unsigned long)SD_CAPTURE->getMaxWriteUs());
+        break;
+      case 'y':
+      case 'Y':
+        if (isLiveRoastRunning()) {
+          Serial.println("stop monitoring before replaying");
+        } else if (!startReplay(0, c == 'Y' ? RoastReplay::SPEED_MAX : 10)) {
+          Serial.println("no roast to replay");
+        }
+        break;
+      default: break;
+    }
+  }
+}
+
+void serviceProfileDump() {
+  // シリアル：送信バッファに収まる時だけ1行（FIFOより長い行はFIFOが空いた時に）
+  if (profile_serial_line < LoopProfiler::LINE_COUNT) {
+    char line[256];
+    size_t len = PROFILER->formatLine(profile_serial_line, line, sizeof(line));
+    size_t room = Serial.availableForWrite();
+    if (room > len || room >= SERIAL_TX_FIFO) {
+      Serial.println(line);
+      profile_serial_line++;
+    }
+  } else if (TRACE->isDumping() && Serial.availableForWrite() >= (int)SERIAL_TX_FIFO) {
+    // トレース：FIFOが空いている時に1行（1行はFIFOに収まる長さ）
+    char line[128];
+    if (TRACE->nextDumpLine(line, sizeof(line))) {
+      Serial.println(line);
+    }
+  }
+
+  // BLE：キューに余裕がある時だけ1メッセージ（切断されたら中止）
+  if (profile_ble_line < LoopProfiler::LINE_COUNT) {
+    if (!BLE_MGR->isConnected()) {
+      profile_ble_line = PROFILER_IDLE;
+      return;
+    }
+    if (!BLE_MGR->canQueueBulk()) return;
+
+    JsonDocument doc;
+    doc["type"] = "profile";
+    if (profile_ble_line == 0) {
+      doc["enabled"] = PROFILER->isEnabled();
+      doc["window_ms"] = PROFILER->getWindowMs();
+      doc["cpu_mhz"] = ESP.getCpuFreqMHz();
+      doc["loop_hz"] = PROFILER->getLoopHz();
+    } else {
+      const char* name;
+      bool in_us;
+      const LoopProfiler::Stats* stats = PROFILER->getLine(profile_ble_line, &name, &in_us);
+      doc["sec"] = name;
+      doc["unit"] = in_us ? "us" : "cycles";
+      doc["n"] = stats->count;
+      if (stats->count > 0) {
+        doc["min"] = stats->min;
+        doc["mean"] = (uint32_t)(stats->sum / stats->count);
+        doc["max"] = stats->max;
+        uint8_t first, last;
+        LoopProfiler::histRange(*stats, first, last);
+        doc["h0"] = first;
+        JsonArray hist = doc["h"].to<JsonArray>();
+        for (uint8_t b = first; b <= last; b++) {
+          hist.add(stats->hist[b]);
+        }
+      }
+    }
+    if (BLE_MGR->sendJson(doc)) {
+      profile_ble_line++;
+    }
+  }
+}
+
 // セオドア提言：Sprite使用による真のスクロールグラフ実装
 void addNewGraphPoint() {
-  if (count < 2 || !sprite_initialized) return;
-  
-  uint16_t current_idx = (head - 1 + BUF_SIZE) % BUF_SIZE;
-  uint16_t prev_idx = (head - 2 + BUF_SIZE) % BUF_SIZE;
+  uint32_t total = getSampleCount();
+  if (total < 2 || !sprite_initialized) return;
   
-  float curr_temp = getTempFromBuffer(current_idx);
-  float prev_temp = getTempFromBuffer(prev_idx);
+  float curr_temp = getTempAgo(0);
+  float prev_temp = getTempAgo(1);
   
   // Skip if out of range
   if (curr_temp < TEMP_MIN || curr_temp > TEMP_MAX || 
       prev_temp < TEMP_MIN || prev_temp > TEMP_MAX) return;
   
-  if (count < BUF_SIZE) {
-    // バッファがまだ満杯でない場合：従来の方式でSprite内に描画
-    float x1 = (float)(count - 2) / (BUF_SIZE - 1) * GRAPH_W;
-    float x2 = (float)(count - 1) / (BUF_SIZE - 1) * GRAPH_W;
-    float y1 = GRAPH_H - (prev_temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
-    float y2 = GRAPH_H - (curr_temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
+  if (total <= GRAPH_SPAN) {
+    // 表示幅がまだ埋まっていない場合：従来の方式でSprite内に描画
+    float x1 = (float)(total - 2) / (GRAPH_SPAN - 1) * GRAPH_W;
+    float x2 = (float)(total - 1) / (GRAPH_SPAN - 1) * GRAPH_W;
+    float y1 = GRAPH_BG->tempToY(prev_temp);
+    float y2 = GRAPH_BG->tempToY(curr_temp);
     
-    graph_sprite.drawLine((int)x1, (int)y1, (int)x2, (int)y2, TFT_CYAN);
+    graph_sprite.drawLine((int)x1, (int)y1, (int)x2, (int)y2, GRAPH_BG->ink(GraphBackground::GC_CYAN));
     
     // Spriteを画面に転送
-    graph_sprite.pushSprite(GRAPH_X0, GRAPH_Y0);
+    pushGraphSprite();
   } else {
     // バッファ満杯：真のスクロール描画（Sprite効率活用）
     
     // 1. Sprite内容を1ピクセル左にスクロール
     graph_sprite.scroll(-1, 0);
     
-    // 2. 右端の列をクリア（危険域背景も含む）
-    float current_danger_temp = getDangerTemp(ROAST_GUIDE->getSelectedLevel());
-    float current_critical_temp = getCriticalTemp(ROAST_GUIDE->getSelectedLevel());
-    
-    // 背景を再描画（右端1列のみ）
-    int x_col = GRAPH_W - 1;
-    for (int y = 0; y < GRAPH_H; y++) {
-      uint16_t bg_color = TFT_BLACK;
-      
-      // Y座標から実際の温度を計算
-      float temp_at_y = TEMP_MIN + (1.0f - (float)y / GRAPH_H) * (TEMP_MAX - TEMP_MIN);
-      
-      if (temp_at_y >= current_critical_temp) {
-        // 緊急停止域（縞模様）
-        bg_color = (y % 8 < 4) ? TFT_RED : TFT_DARKGREY;
-      } else if (temp_at_y >= current_danger_temp) {
-        // 注意域（暗い色）
-        bg_color = TFT_OLIVE;
-      }
-      
-      graph_sprite.drawPixel(x_col, y, bg_color);
-    }
+    // 2. 右端の列を背景レイヤーからコピー（危険域の帯）
+    prepareGraphBackground();
+    GRAPH_BG->renderColumn(graph_sprite, GRAPH_W - 1);
     
     // 3. 最新の線分を右端に描画
-    float y1 = GRAPH_H - (prev_temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
-    float y2 = GRAPH_H - (curr_temp - TEMP_MIN) / (TEMP_MAX - TEMP_MIN) * GRAPH_H;
+    float y1 = GRAPH_BG->tempToY(prev_temp);
+    float y2 = GRAPH_BG->tempToY(curr_temp);
     
-    graph_sprite.drawLine(GRAPH_W - 2, (int)y1, GRAPH_W - 1, (int)y2, TFT_CYAN);
+    graph_sprite.drawLine(GRAPH_W - 2, (int)y1, GRAPH_W - 1, (int)y2, GRAPH_BG->ink(GraphBackground::GC_CYAN));
     
     // 4. Spriteを画面に転送
-    graph_sprite.pushSprite(GRAPH_X0, GRAPH_Y0);
+    pushGraphSprite();
   }
 }
 
 void drawStats() {
-  if (count == 0) {
+  if (getSampleCount() == 0) {
     M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
+    invalidateFields({&stats_current, &stats_max, &stats_min, &stats_avg, &stats_count, &footer_text});
     M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
     M5.Lcd.setCursor(20, GRAPH_Y0 + 20);
     M5.Lcd.println("No data available");
     return;
   }
   
-  M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
-  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-  
   int y_pos = GRAPH_Y0 + 20;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf(">> Temperature Stats <<");
+  if (need_full_redraw) {
+    // 見出しなど固定部分は全体再描画時のみ
+    M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
+    invalidateFields({&stats_current, &stats_max, &stats_min, &stats_avg, &stats_count, &footer_text});
+    M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+    M5.Lcd.setTextColor(TFT_WHITE);
+    M5.Lcd.setCursor(20, y_pos);
+    M5.Lcd.printf(">> Temperature Stats <<");
+  }
   
   y_pos += 30;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf("* Current: %.2f C", current_temp);
+  stats_current.printf(20, y_pos, TFT_WHITE, "* Current: %.2f C", current_temp);
   
   y_pos += 25;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf("^ Maximum: %.2f C", getMaxTemp());
+  stats_max.printf(20, y_pos, TFT_WHITE, "^ Maximum: %.2f C", getMaxTemp());
   
   y_pos += 25;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf("v Minimum: %.2f C", getMinTemp());
+  stats_min.printf(20, y_pos, TFT_WHITE, "v Minimum: %.2f C", getMinTemp());
   
   y_pos += 25;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf("~ Average: %.2f C", getAverageTemp());
+  stats_avg.printf(20, y_pos, TFT_WHITE, "~ Average: %.2f C", getAverageTemp());
   
   y_pos += 25;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf("# Data Points: %d", count);
+  stats_count.printf(20, y_pos, TFT_WHITE, "# Data Points: %u", getSampleCount());
   
   // Button instructions（統一フッターに移動）
   drawFooter("[A]Mode [B]Reset [C]Stop");
@@ -1184,158 +1544,92 @@ void drawStandbyScreen() {
   M5.Lcd.println("> Hold Button C (2sec) to CLEAR");
   
   // Show data count if available
-  if (count > 0) {
+  if (getSampleCount() > 0) {
     M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
     M5.Lcd.setCursor(10, 220);
-    M5.Lcd.printf("Stored: %d points", count);
+    M5.Lcd.printf("Stored: %u points", getSampleCount());
   }
 }
 
-float calculateRoR() {
-  if (count < ROR_INTERVAL) {
-    return 0.0f;  // Not enough data for RoR calculation
-  }
-  
-  // Get temperature from 60 seconds ago
-  uint16_t old_idx = (head - ROR_INTERVAL + BUF_SIZE) % BUF_SIZE;
-  uint16_t current_idx = (head - 1 + BUF_SIZE) % BUF_SIZE;
-  
-  float old_temp = getTempFromBuffer(old_idx);
-  float current_temp_val = getTempFromBuffer(current_idx);
-  
-  // 実測時間補正: サンプリング遅延を考慮（Theodore提言によるオーバーフロー防止）
-  float actual_time_interval = (float)ROR_INTERVAL; // 基本は60秒
-  if (millis() - next_tick > (uint32_t)PERIOD_MS * 2) {
-    // サンプリング遅延が発生している場合の補正
-    float delay_factor = (float)(millis() - next_tick) / ((float)PERIOD_MS * (float)ROR_INTERVAL);
-    actual_time_interval = (float)ROR_INTERVAL * (1.0f + delay_factor);
-  }
-  
-  // Calculate RoR: (ΔT) / (実測秒 / 60.0f) - 安全な除算
-  if (actual_time_interval > 0.0f) {
-    return (current_temp_val - old_temp) / (actual_time_interval / 60.0f);
-  } else {
-    return 0.0f;  // 異常値回避
-  }
-}
-
-float calculateRoR15s() {
-  if (count < ROR_INTERVAL_15S) {
-    return 0.0f;  // Not enough data for 15s RoR calculation
-  }
-  
-  // Get temperature from 15 seconds ago
-  uint16_t old_idx = (head - ROR_INTERVAL_15S + BUF_SIZE) % BUF_SIZE;
-  uint16_t current_idx = (head - 1 + BUF_SIZE) % BUF_SIZE;
-  
-  float old_temp = getTempFromBuffer(old_idx);
-  float current_temp_val = getTempFromBuffer(current_idx);
-  
-  // Calculate 15s RoR and scale to per-minute
-  return (current_temp_val - old_temp) * 4.0f;  // 15s * 4 = 60s
-}
-
-
-void updateRoRBuffer() {
-  if (count >= ROR_INTERVAL) {
-    // 最新値は head-1 の位置に格納
-    uint16_t last_idx = (head + BUF_SIZE - 1) % BUF_SIZE;
-    ror_buf[last_idx] = current_ror;
-    if (ror_count < BUF_SIZE) ror_count++;
-  }
-}
 
 void drawRoR() {
-  M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
-  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-  
   int y_pos = GRAPH_Y0 + 20;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf(">> Rate of Rise (RoR) <<");
+  if (need_full_redraw) {
+    // 見出しなど固定部分は全体再描画時のみ
+    M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
+    invalidateFields({&ror_current, &ror_projection, &ror_eval, &ror_trend_label, &footer_text});
+    M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+    M5.Lcd.setTextColor(TFT_WHITE);
+    M5.Lcd.setCursor(20, y_pos);
+    M5.Lcd.printf(">> Rate of Rise (RoR) <<");
+  }
   
   y_pos += 30;
-  M5.Lcd.setCursor(20, y_pos);
-  M5.Lcd.printf("Current: %.1f C/min", current_ror);
+  ror_current.printf(20, y_pos, TFT_WHITE, "Current: %.1f C/min (%s %.1f)", current_ror,
+                     DERIVATIVE->getSmoothingModeName(), decision_ror);
   
   y_pos += 25;
-  M5.Lcd.setCursor(20, y_pos);
-  if (count < ROR_INTERVAL) {
-    M5.Lcd.printf("Wait %d more seconds", ROR_INTERVAL - count);
+  if (!DERIVATIVE->isReady(ROR_INTERVAL)) {
+    ror_projection.printf(20, y_pos, TFT_WHITE, "Wait %d more seconds", (int)DERIVATIVE->samplesUntilReady(ROR_INTERVAL));
   } else {
-    M5.Lcd.printf("10min projection: +%.0f C", current_ror * 10);
+    ror_projection.printf(20, y_pos, TFT_WHITE, "10min projection: +%.0f C", current_ror * 10);
   }
   
   // RoR interpretation based on Scott Rao guidelines and roast stage
   y_pos += 30;
-  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
-  M5.Lcd.setCursor(20, y_pos);
   
   // Stage-aware RoR evaluation
   if (ROAST_GUIDE->isActive()) {
-    RoastGuide::RoastTarget target = ROAST_GUIDE->getRoastTarget(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
+    const RoastGuide::RoastTarget& target = ROAST_GUIDE->getCurrentTarget();
     RoastGuide::RoastStage current_stage = ROAST_GUIDE->getCurrentStage();
     if (current_ror > target.ror_max + 3) {
-      M5.Lcd.setTextColor(TFT_RED);
-      M5.Lcd.printf("[!] RoR: Too High for %s", getStageName(current_stage));
+      ror_eval.printf(20, y_pos, TFT_RED, "[!] RoR: Too High for %s", getStageName(current_stage));
     } else if (current_ror > target.ror_max) {
-      M5.Lcd.setTextColor(TFT_ORANGE);
-      M5.Lcd.printf("[^] RoR: High for %s", getStageName(current_stage));
+      ror_eval.printf(20, y_pos, TFT_ORANGE, "[^] RoR: High for %s", getStageName(current_stage));
     } else if (current_ror >= target.ror_min) {
-      M5.Lcd.setTextColor(TFT_GREEN);
-      M5.Lcd.printf("[OK] RoR: Good for %s", getStageName(current_stage));
+      ror_eval.printf(20, y_pos, TFT_GREEN, "[OK] RoR: Good for %s", getStageName(current_stage));
     } else if (current_ror >= target.ror_min - 2) {
-      M5.Lcd.setTextColor(TFT_CYAN);
-      M5.Lcd.printf("[v] RoR: Low for %s", getStageName(current_stage));
+      ror_eval.printf(20, y_pos, TFT_CYAN, "[v] RoR: Low for %s", getStageName(current_stage));
     } else {
-      M5.Lcd.setTextColor(TFT_BLUE);
-      M5.Lcd.printf("[!] RoR: Too Low - Risk of stall");
+      ror_eval.printf(20, y_pos, TFT_BLUE, "[!] RoR: Too Low - Risk of stall");
     }
   } else {
     // General RoR evaluation when not using roast guide
     if (current_ror > 20) {
-      M5.Lcd.setTextColor(TFT_RED);
-      M5.Lcd.printf("[!] RoR: Excessive (>20 C/min) - Risk flick");
+      ror_eval.printf(20, y_pos, TFT_RED, "[!] RoR: Excessive (>20 C/min) - Risk flick");
     } else if (current_ror > 15) {
-      M5.Lcd.setTextColor(TFT_ORANGE);
-      M5.Lcd.printf("[^] RoR: Very High (15-20 C/min)");
+      ror_eval.printf(20, y_pos, TFT_ORANGE, "[^] RoR: Very High (15-20 C/min)");
     } else if (current_ror > 8) {
-      M5.Lcd.setTextColor(TFT_YELLOW);
-      M5.Lcd.printf("[^] RoR: High (8-15 C/min)");
+      ror_eval.printf(20, y_pos, TFT_YELLOW, "[^] RoR: High (8-15 C/min)");
     } else if (current_ror > 3) {
-      M5.Lcd.setTextColor(TFT_GREEN);
-      M5.Lcd.printf("[OK] RoR: Moderate (3-8 C/min)");
+      ror_eval.printf(20, y_pos, TFT_GREEN, "[OK] RoR: Moderate (3-8 C/min)");
     } else if (current_ror > 0) {
-      M5.Lcd.setTextColor(TFT_CYAN);
-      M5.Lcd.printf("[v] RoR: Low (0-3 C/min)");
+      ror_eval.printf(20, y_pos, TFT_CYAN, "[v] RoR: Low (0-3 C/min)");
     } else {
-      M5.Lcd.setTextColor(TFT_BLUE);
-      M5.Lcd.printf("[-] RoR: Cooling (%.1f C/min)", current_ror);
+      ror_eval.printf(20, y_pos, TFT_BLUE, "[-] RoR: Cooling (%.1f C/min)", current_ror);
     }
   }
-  M5.Lcd.setTextColor(TFT_WHITE);
   
   // Simple RoR trend graph
   if (ror_count > 1) {
     y_pos += 40;
-    M5.Lcd.setCursor(20, y_pos);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.printf("RoR Trend (last 5min):");
+    ror_trend_label.printf(20, y_pos, TFT_WHITE, "RoR Trend (last 5min):");
     
-    // Draw mini RoR graph
+    // Draw mini RoR graph（枠は固定、内側のみ描き直す）
     int graph_y = y_pos + 20;
     int graph_x = 20;
     int graph_w = 280;
     int graph_h = 30;
     
     M5.Lcd.drawRect(graph_x, graph_y, graph_w, graph_h, TFT_WHITE);
+    M5.Lcd.fillRect(graph_x + 1, graph_y + 1, graph_w - 2, graph_h - 2, TFT_BLACK);
     
     // Draw RoR trend line
     uint16_t points_to_show = (ror_count < 300) ? ror_count : 300;  // Last 5 minutes
     if (points_to_show > 1) {
       float prevX = -1, prevY = -1;
       for (uint16_t i = 0; i < points_to_show; ++i) {
-        uint16_t idx = (head - points_to_show + i + BUF_SIZE) % BUF_SIZE;
-        float ror_val = ror_buf[idx];
+        float ror_val = HISTORY->getRoR(points_to_show - 1 - i);
         
         float x = graph_x + (float)i / (points_to_show - 1) * graph_w;
         float y = graph_y + graph_h/2 - (ror_val / 20.0f) * (graph_h/2);  // Scale: ±20°C/min
@@ -1358,22 +1652,19 @@ void drawRoR() {
 
 // getRoastLevelName and getRoastStageName removed - now delegated to RoastGuide module
 
-// セオドア提言：millis()オーバーフロー対策（減算形式）
+// 焙煎・ステージの開始時刻はRoastGuideのステージ遷移で管理
 uint32_t getRoastElapsedTime() {
-  if (roast_start_time == 0) return 0;
-  uint32_t now = millis();
-  return (now - roast_start_time) / 1000;  // unsigned減算でオーバーフロー安全
+  return ROAST_GUIDE->getRoastElapsedTime();
 }
 
 float getStageElapsedTime() {
-  if (stage_start_time == 0) return 0;
-  uint32_t now = millis();
-  return (now - stage_start_time) / 1000.0f;  // unsigned減算でオーバーフロー安全
+  return ROAST_GUIDE->getStageElapsedTime();
 }
 
 
 void drawRoastLevelSelection() {
   M5.Lcd.fillRect(0, GRAPH_Y0, 320, 240 - GRAPH_Y0, TFT_BLACK);
+  footer_text.invalidate();  // フッターも消去したため
   M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
   
   int y_pos = GRAPH_Y0 + 10;
@@ -1404,160 +1695,180 @@ void drawRoastLevelSelection() {
   drawFooter("[B]Change [C]Start");
 }
 
+// フェーズ集計：乾燥中は転換点から、メイラード中は乾燥の割合、発達中はDTR
+void drawPhaseMetrics(int x, int y) {
+  const PhaseMetrics& phases = ROAST_GUIDE->getPhaseMetrics();
+  if (!phases.isCharged()) {
+    guide_phase.clear();
+    return;
+  }
+  uint8_t phase = phases.getPhase();
+  int phase_s = (int)phases.getPhaseSeconds((PhaseMetrics::Phase)phase);
+  if (phase == PhaseMetrics::PHASE_DEVELOPMENT) {
+    float dtr = phases.getDTR();
+    uint16_t color = dtr < 15.0f ? TFT_YELLOW : (dtr <= 25.0f ? TFT_GREEN : TFT_RED);
+    guide_phase.printf(x, y, color, "Dev %d:%02d DTR %.1f%%", phase_s / 60, phase_s % 60, dtr);
+  } else if (phase == PhaseMetrics::PHASE_MAILLARD) {
+    guide_phase.printf(x, y, TFT_ORANGE, "Mai %d:%02d Dry %.0f%%", phase_s / 60, phase_s % 60,
+                       phases.getPhasePercent(PhaseMetrics::PHASE_DRYING));
+  } else {
+    float since_tp = phases.getSinceTurningPoint();
+    if (since_tp >= 0.0f) {
+      guide_phase.printf(x, y, TFT_YELLOW, "Dry %d:%02d TP+%d:%02d", phase_s / 60, phase_s % 60,
+                         (int)since_tp / 60, (int)since_tp % 60);
+    } else {
+      guide_phase.printf(x, y, TFT_YELLOW, "Dry %d:%02d", phase_s / 60, phase_s % 60);
+    }
+  }
+}
+
 void drawGuide() {
   // ガイド表示領域：ヘッダーとフッターを除いた範囲
   int content_height = 240 - HEADER_HEIGHT - FOOTER_HEIGHT;
-  M5.Lcd.fillRect(0, GRAPH_Y0, 320, content_height, TFT_BLACK);
-  M5.Lcd.setFont(&fonts::lgfxJapanGothic_16);
+  if (need_full_redraw) {
+    M5.Lcd.fillRect(0, GRAPH_Y0, 320, content_height, TFT_BLACK);
+    invalidateFields({&guide_title, &guide_time, &guide_phase, &guide_maintain, &guide_next, &guide_min_time,
+                      &guide_ror_range, &guide_fire, &guide_temp_eval, &guide_ror_eval,
+                      &guide_crack_prompt, &guide_drop, &guide_pred, &footer_text});
+    guide_drawn_stage = -1;
+    guide_drawn_detail = -1;
+  }
   
   int y_pos = GRAPH_Y0 + 10;
   
   // 焙煎レベルと段階表示
-  M5.Lcd.setCursor(10, y_pos);
-  M5.Lcd.printf("%s - %s", ROAST_GUIDE->getRoastLevelName(ROAST_GUIDE->getSelectedLevel()), getStageName(ROAST_GUIDE->getCurrentStage()));
+  guide_title.printf(10, y_pos, TFT_WHITE, "%s - %s", ROAST_GUIDE->getRoastLevelName(ROAST_GUIDE->getSelectedLevel()), getStageName(ROAST_GUIDE->getCurrentStage()));
   
-  // 段階プログレスバー
+  // 段階プログレスバー（段階が変わった時のみ）
   y_pos += 15;
   int progress_width = 280;
   int progress_x = 20;
-  int stage_progress = (ROAST_GUIDE->getCurrentStage() * progress_width) / 7;  // 8段階
-  M5.Lcd.drawRect(progress_x, y_pos, progress_width, 8, TFT_WHITE);
-  M5.Lcd.fillRect(progress_x + 1, y_pos + 1, stage_progress, 6, TFT_GREEN);
+  int current_stage = ROAST_GUIDE->getCurrentStage();
+  if (current_stage != guide_drawn_stage) {
+    int stage_progress = (current_stage * progress_width) / 7;  // 8段階
+    M5.Lcd.fillRect(progress_x, y_pos, progress_width, 8, TFT_BLACK);
+    M5.Lcd.drawRect(progress_x, y_pos, progress_width, 8, TFT_WHITE);
+    M5.Lcd.fillRect(progress_x + 1, y_pos + 1, stage_progress, 6, TFT_GREEN);
+  }
   
-  // 現在ステージ内の詳細進行率
+  // 現在ステージ内の詳細進行率（バーの長さが変わった時のみ）
   y_pos += 10;
-  RoastGuide::RoastTarget stage_target = ROAST_GUIDE->getRoastTarget(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
+  const RoastGuide::RoastTarget& stage_target = ROAST_GUIDE->getCurrentTarget();
   float stage_elapsed = getStageElapsedTime();
   float stage_total_time = stage_target.time_max > 0 ? stage_target.time_max : stage_target.time_min + 60;
   float stage_progress_pct = stage_elapsed / stage_total_time;
   if (stage_progress_pct > 1.0f) stage_progress_pct = 1.0f;
   
   int detail_progress = (int)(stage_progress_pct * progress_width);
-  M5.Lcd.drawRect(progress_x, y_pos, progress_width, 6, TFT_DARKGREY);
-  uint16_t detail_color = stage_progress_pct > 0.8f ? TFT_YELLOW : TFT_CYAN;
-  M5.Lcd.fillRect(progress_x + 1, y_pos + 1, detail_progress, 4, detail_color);
-  
-  // 段階インジケーター
-  for (int i = 0; i < 8; i++) {
-    int dot_x = progress_x + (i * progress_width / 7);
-    uint16_t color = (i <= ROAST_GUIDE->getCurrentStage()) ? TFT_YELLOW : TFT_DARKGREY;
-    M5.Lcd.fillCircle(dot_x, y_pos + 4, 3, color);
+  if (current_stage != guide_drawn_stage || detail_progress != guide_drawn_detail) {
+    M5.Lcd.fillRect(progress_x - 3, y_pos - 3, progress_width + 7, 12, TFT_BLACK);
+    M5.Lcd.drawRect(progress_x, y_pos, progress_width, 6, TFT_DARKGREY);
+    uint16_t detail_color = stage_progress_pct > 0.8f ? TFT_YELLOW : TFT_CYAN;
+    M5.Lcd.fillRect(progress_x + 1, y_pos + 1, detail_progress, 4, detail_color);
+    
+    // 段階インジケーター
+    for (int i = 0; i < 8; i++) {
+      int dot_x = progress_x + (i * progress_width / 7);
+      uint16_t color = (i <= current_stage) ? TFT_YELLOW : TFT_DARKGREY;
+      M5.Lcd.fillCircle(dot_x, y_pos + 4, 3, color);
+    }
+    guide_drawn_stage = current_stage;
+    guide_drawn_detail = detail_progress;
   }
   
   y_pos += 25;  // プログレスバー拡張分のスペースを追加
-  M5.Lcd.setCursor(10, y_pos);
-  M5.Lcd.printf("Time: %02d:%02d", getRoastElapsedTime() / 60, getRoastElapsedTime() % 60);
+  guide_time.printf(10, y_pos, TFT_WHITE, "Time: %02d:%02d", getRoastElapsedTime() / 60, getRoastElapsedTime() % 60);
+  drawPhaseMetrics(130, y_pos + 2);
   
   // 現在の目標値
-  RoastGuide::RoastTarget target = ROAST_GUIDE->getRoastTarget(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
+  const RoastGuide::RoastTarget& target = ROAST_GUIDE->getCurrentTarget();
   
   y_pos += 20;
-  M5.Lcd.setCursor(10, y_pos);
   // 三層ガイド表示（初心者向け明確化）
-  M5.Lcd.setTextColor(TFT_CYAN);
-  M5.Lcd.printf("Maintain: %.0f-%.0f C", target.temp_min, target.temp_max);
-  M5.Lcd.setTextColor(TFT_WHITE);
+  guide_maintain.printf(10, y_pos, TFT_CYAN, "Maintain: %.0f-%.0f C", target.temp_min, target.temp_max);
   
   y_pos += 15;
-  M5.Lcd.setCursor(10, y_pos);
   // 次段階の鍵温度表示
   float next_key_temp = getNextStageKeyTemp(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
   if (next_key_temp > 0) {
     bool key_temp_reached = current_temp >= next_key_temp;
-    M5.Lcd.setTextColor(key_temp_reached ? TFT_GREEN : TFT_RED);
-    M5.Lcd.printf("Next Step: %s%.0f C", key_temp_reached ? "OK" : ">=", next_key_temp);
-    M5.Lcd.setTextColor(TFT_WHITE);
+    guide_next.printf(10, y_pos, key_temp_reached ? TFT_GREEN : TFT_RED,
+                      "Next Step: %s%.0f C", key_temp_reached ? "OK" : ">=", next_key_temp);
   } else {
-    M5.Lcd.setTextColor(TFT_YELLOW);
-    M5.Lcd.printf("Next Step: Time Based");
-    M5.Lcd.setTextColor(TFT_WHITE);
+    guide_next.printf(10, y_pos, TFT_YELLOW, "Next Step: Time Based");
   }
   
   y_pos += 15;
-  M5.Lcd.setCursor(10, y_pos);
   // 最小時間表示
   float elapsed = getStageElapsedTime();
   bool min_time_met = elapsed >= target.time_min;
-  M5.Lcd.setTextColor(min_time_met ? TFT_GREEN : TFT_YELLOW);
-  M5.Lcd.printf("Min Time: %s%ds (%.0fs)", min_time_met ? "OK" : "", target.time_min, elapsed);
-  M5.Lcd.setTextColor(TFT_WHITE);
+  guide_min_time.printf(10, y_pos, min_time_met ? TFT_GREEN : TFT_YELLOW,
+                        "Min Time: %s%ds (%.0fs)", min_time_met ? "OK" : "", target.time_min, elapsed);
   
   y_pos += 16;
-  M5.Lcd.setCursor(10, y_pos);
-  M5.Lcd.printf("RoR: %.1f-%.1f C/min", target.ror_min, target.ror_max);
+  guide_ror_range.printf(10, y_pos, TFT_WHITE, "RoR: %.1f-%.1f C/min", target.ror_min, target.ror_max);
   
   // 火力推奨表示
   y_pos += 16;
-  M5.Lcd.setCursor(10, y_pos);
-  M5.Lcd.setTextColor(TFT_ORANGE);
-  M5.Lcd.printf("Fire: %s", getFirePowerName(getRecommendedFire()));
-  M5.Lcd.setTextColor(TFT_WHITE);
+  guide_fire.printf(10, y_pos, TFT_ORANGE, "Fire: %s", getFirePowerName(getRecommendedFire()));
   
   // 現在の状態評価
   y_pos += 18;
-  M5.Lcd.setCursor(10, y_pos);
   if (current_temp < target.temp_min) {
-    M5.Lcd.setTextColor(TFT_BLUE);
-    M5.Lcd.printf("[v] Temp: LOW (%.1f C)", current_temp);
+    guide_temp_eval.printf(10, y_pos, TFT_BLUE, "[v] Temp: LOW (%.1f C)", current_temp);
   } else if (current_temp > target.temp_max) {
-    M5.Lcd.setTextColor(TFT_RED);
-    M5.Lcd.printf("[!] Temp: HIGH (%.1f C)", current_temp);
+    guide_temp_eval.printf(10, y_pos, TFT_RED, "[!] Temp: HIGH (%.1f C)", current_temp);
   } else {
-    M5.Lcd.setTextColor(TFT_GREEN);
-    M5.Lcd.printf("[OK] Temp: OK (%.1f C)", current_temp);
+    guide_temp_eval.printf(10, y_pos, TFT_GREEN, "[OK] Temp: OK (%.1f C)", current_temp);
   }
-  M5.Lcd.setTextColor(TFT_WHITE);
   
   y_pos += 20;
-  M5.Lcd.setCursor(10, y_pos);
-  if (current_ror < target.ror_min) {
-    M5.Lcd.setTextColor(TFT_BLUE);
-    M5.Lcd.printf("[v] RoR: LOW (%.1f)", current_ror);
-  } else if (current_ror > target.ror_max) {
-    M5.Lcd.setTextColor(TFT_RED);
-    M5.Lcd.printf("[!] RoR: HIGH (%.1f)", current_ror);
+  if (decision_ror < target.ror_min) {
+    guide_ror_eval.printf(10, y_pos, TFT_BLUE, "[v] RoR: LOW (%.1f)", decision_ror);
+  } else if (decision_ror > target.ror_max) {
+    guide_ror_eval.printf(10, y_pos, TFT_RED, "[!] RoR: HIGH (%.1f)", decision_ror);
   } else {
-    M5.Lcd.setTextColor(TFT_GREEN);
-    M5.Lcd.printf("[OK] RoR: OK (%.1f)", current_ror);
+    guide_ror_eval.printf(10, y_pos, TFT_GREEN, "[OK] RoR: OK (%.1f)", decision_ror);
   }
-  M5.Lcd.setTextColor(TFT_WHITE);
   
   // 表示可能領域の制限チェック
   int max_y = 240 - FOOTER_HEIGHT - 15;  // フッター上部マージン
   
   // 1ハゼ確認表示（優先度高）
-  if (first_crack_confirmation_needed && y_pos < max_y - 25) {
+  if (ROAST_GUIDE->isFirstCrackConfirmationNeeded() && y_pos < max_y - 25) {
     y_pos += 15;
-    M5.Lcd.setTextColor(TFT_YELLOW);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.setCursor(10, y_pos);
-    M5.Lcd.printf(">>> 1st Crack? Press B <<<");
-    M5.Lcd.setTextColor(TFT_WHITE);
+    guide_crack_prompt.printf(10, y_pos, TFT_YELLOW, ">>> 1st Crack? Press B <<<");
+  } else if (canLogHeardFirstCrack() && y_pos < max_y - 25) {
+    y_pos += 15;
+    guide_crack_prompt.printf(10, y_pos, TFT_YELLOW, "1st Crack: auto %.0f%% (B: heard)",
+                              CRACK_DETECTOR->getConfidence() * 100.0f);
+  } else {
+    guide_crack_prompt.clear();
   }
   
   // 重要警告（優先度最高）
   if (ROAST_GUIDE->getCurrentStage() == RoastGuide::STAGE_FINISH && y_pos < max_y - 20) {
     y_pos += 15;
-    M5.Lcd.setTextColor(TFT_RED);
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.setCursor(30, y_pos);
-    M5.Lcd.printf("*** DROP BEANS NOW! ***");
-    M5.Lcd.setTextColor(TFT_WHITE);
+    guide_drop.printf(30, y_pos, TFT_RED, "*** DROP BEANS NOW! ***");
+  } else {
+    guide_drop.clear();
   }
   
   // 下部情報（スペースが許す場合のみ）
   if (y_pos < max_y - 35) {
     y_pos += 12;
-    M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-    M5.Lcd.setCursor(10, y_pos);
     RoastGuide::FirePower current_fire = getRecommendedFire();
-    M5.Lcd.printf("Pred: %.0f°C | %s", predictor.predictTemperatureIn30s(), 
-                  getGasAdjustmentAdvice(last_recommended_fire, current_fire));
+    guide_pred.printf(10, y_pos, TFT_WHITE, "Pred: %.0f°C | %s", predictor.predictTemperatureIn30s(), 
+                      getGasAdjustmentAdvice(SAMPLE_PROCESSOR->getFire(), current_fire));
+  } else {
+    guide_pred.clear();
   }
   
   // ボタン指示（統一フッターに移動）
-  if (first_crack_confirmation_needed) {
+  if (ROAST_GUIDE->isFirstCrackConfirmationNeeded()) {
     drawFooter("[A]Mode [B]Confirm 1st Crack [C]Stop");
+  } else if (canLogHeardFirstCrack()) {
+    drawFooter("[A]Mode [B]Heard 1st Crack [C]Stop");
   } else if (ROAST_GUIDE->isActive() && ROAST_GUIDE->getCurrentStage() < RoastGuide::STAGE_FINISH) {
     drawFooter("[A]Mode [B-Hold]Next Stage [C]Stop");
   } else {
@@ -1577,112 +1888,10 @@ const char* getFirePowerName(RoastGuide::FirePower fire) {
   }
 }
 
-RoastGuide::FirePower calculateRecommendedFire() {
-  if (!ROAST_GUIDE->isActive()) return RoastGuide::FIRE_MEDIUM;
-  
-  RoastGuide::RoastTarget target = ROAST_GUIDE->getRoastTarget(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
-  RoastGuide::FirePower base_fire = target.fire;
-  
-  // Scott Rao原則：「常に下降するRoR」を維持する火力制御
-  float ror_trend = 0.0f;
-  if (count >= 3) {
-    // 直近3点のRoR傾向を計算
-    uint16_t idx1 = (head - 3 + BUF_SIZE) % BUF_SIZE;
-    uint16_t idx2 = (head - 1 + BUF_SIZE) % BUF_SIZE;
-    ror_trend = getTempFromBuffer(idx2) - getTempFromBuffer(idx1);  // 簡易的な傾向
-  }
-  
-  // 段階別の高度な火力制御
-  auto current_stage = ROAST_GUIDE->getCurrentStage();
-  switch(current_stage) {
-    case RoastGuide::STAGE_CHARGE:
-      // 投入段階：RoRピーク後の下降開始をサポート
-      if (current_ror > 18 && ror_trend > 0) {
-        base_fire = RoastGuide::FIRE_LOW;  // 早めに火力を落とす
-      } else if (current_ror < 10) {
-        base_fire = RoastGuide::FIRE_MEDIUM;  // 十分な熱を与える
-      }
-      break;
-      
-    case RoastGuide::STAGE_DRYING:
-      // 乾燥段階：10-15°C/minを維持しつつ下降
-      if (current_ror > target.ror_max + 2) {
-        base_fire = (base_fire > RoastGuide::FIRE_OFF) ? (RoastGuide::FirePower)(base_fire - 1) : RoastGuide::FIRE_OFF;
-      } else if (current_ror < target.ror_min - 2) {
-        base_fire = (base_fire < RoastGuide::FIRE_VERY_HIGH) ? (RoastGuide::FirePower)(base_fire + 1) : RoastGuide::FIRE_VERY_HIGH;
-      }
-      break;
-      
-    case RoastGuide::STAGE_MAILLARD:
-      // メイラード段階：滑らかな下降を最優先
-      if (ror_trend > 0.5f) {  // RoRが上昇傾向
-        base_fire = (base_fire > RoastGuide::FIRE_OFF) ? (RoastGuide::FirePower)(base_fire - 1) : RoastGuide::FIRE_OFF;
-      } else if (current_ror > target.ror_max) {
-        base_fire = RoastGuide::FIRE_VERY_LOW;  // 1ハゼ前に火力を十分下げる
-      } else if (current_ror < target.ror_min && current_temp < 180) {
-        base_fire = (base_fire < RoastGuide::FIRE_LOW) ? (RoastGuide::FirePower)(base_fire + 1) : RoastGuide::FIRE_LOW;
-      }
-      break;
-      
-    case RoastGuide::STAGE_FIRST_CRACK:
-      // 1ハゼ：クラッシュ防止とフィック回避が最優先
-      base_fire = RoastGuide::FIRE_VERY_LOW;  // 基本は極低火
-      if (current_ror < -1.0f) {  // 急激なクラッシュ
-        base_fire = RoastGuide::FIRE_LOW;  // 少し火力を戻す
-      } else if (ror_trend > 0.2f) {  // フィックの兆候
-        base_fire = RoastGuide::FIRE_OFF;  // 即座に火を切る
-      }
-      break;
-      
-    case RoastGuide::STAGE_DEVELOPMENT:
-      // 発達段階：RoR 0に向けて緩やかに制御
-      if (current_ror > 3) {
-        base_fire = RoastGuide::FIRE_OFF;  // 火力を大幅削減
-      } else if (current_ror > 1) {
-        base_fire = RoastGuide::FIRE_VERY_LOW;
-      } else if (current_ror < 0.5f && getStageElapsedTime() < target.time_min) {
-        base_fire = RoastGuide::FIRE_VERY_LOW;  // 最低限の熱は維持
-      } else {
-        base_fire = RoastGuide::FIRE_OFF;  // 基本はオフ
-      }
-      break;
-      
-    case RoastGuide::STAGE_SECOND_CRACK:
-    case RoastGuide::STAGE_FINISH:
-      // 2ハゼ以降：火力オフが基本
-      base_fire = RoastGuide::FIRE_OFF;
-      break;
-      
-    default:
-      // 予熱段階
-      base_fire = RoastGuide::FIRE_HIGH;
-      break;
-  }
-  
-  // 温度安全措置（最優先）
-  float current_danger_temp = getDangerTemp(ROAST_GUIDE->getSelectedLevel());
-  if (current_temp > current_danger_temp - 5) {
-    base_fire = RoastGuide::FIRE_OFF;  // 危険温度接近時は火力カット
-  } else if (current_temp > target.temp_max + 3) {
-    base_fire = (base_fire > RoastGuide::FIRE_OFF) ? (RoastGuide::FirePower)(base_fire - 1) : RoastGuide::FIRE_OFF;
-  }
-  
-  // ヒステリシス適用（振動防止）
-  RoastGuide::FirePower current_fire = last_recommended_fire;
-  if (abs(base_fire - current_fire) <= 1) {
-    // 微小な変更は無視
-    if (current_ror >= target.ror_min - 1 && 
-        current_ror <= target.ror_max + 1 &&
-        abs(ror_trend) < 0.3f) {
-      return current_fire;
-    }
-  }
-  
-  return base_fire;
-}
 
 void playBeep(int duration_ms, int frequency) {
   // M5Stackのスピーカーでビープ音を鳴らす
+  TRACE_MARK(MARK_BEEP, frequency);
   MELODY_PLAYER->playBeep(duration_ms, frequency);
 }
 
@@ -1716,12 +1925,15 @@ void playTemperatureWarning(float temp, float danger_temp, float critical_temp)
     
     if (temp >= critical_temp) {
       // 緊急段階：最初のビープ開始
+      TRACE_MARK(MARK_BEEP, 2000);
       M5.Speaker.tone(2000, 100);
     } else if (temp >= danger_temp) {
       // 警告段階：最初のビープ開始
+      TRACE_MARK(MARK_BEEP, 1500);
       M5.Speaker.tone(1500, 200);
     } else if (temp >= danger_temp - 5) {
       // 注意段階：単発ビープ
+      TRACE_MARK(MARK_BEEP, 1000);
       M5.Speaker.tone(1000, 300);
       warning_active = false;  // 単発なので即終了
     }
@@ -1732,10 +1944,12 @@ void playTemperatureWarning(float temp, float danger_temp, float critical_temp)
     if (temp >= critical_temp) {
       // 緊急段階：3回連続ビープ
       if (elapsed >= 150 && warning_beep_step == 0) {
-        M5.Speaker.tone(2000, 100);
+        TRACE_MARK(MARK_BEEP, 2000);
+      M5.Speaker.tone(2000, 100);
         warning_beep_step = 1;
       } else if (elapsed >= 300 && warning_beep_step == 1) {
-        M5.Speaker.tone(2000, 100);
+        TRACE_MARK(MARK_BEEP, 2000);
+      M5.Speaker.tone(2000, 100);
         warning_beep_step = 2;
       } else if (elapsed >= 450) {
         warning_active = false;
@@ -1743,7 +1957,8 @@ void playTemperatureWarning(float temp, float danger_temp, float critical_temp)
     } else if (temp >= danger_temp) {
       // 警告段階：2回連続ビープ
       if (elapsed >= 300 && warning_beep_step == 0) {
-        M5.Speaker.tone(1500, 200);
+        TRACE_MARK(MARK_BEEP, 1500);
+      M5.Speaker.tone(1500, 200);
         warning_beep_step = 1;
       } else if (elapsed >= 600) {
         warning_active = false;
@@ -1753,45 +1968,15 @@ void playTemperatureWarning(float temp, float danger_temp, float critical_temp)
 }
 
 void forceNextStage() {
-  if (!ROAST_GUIDE->isActive() || ROAST_GUIDE->getCurrentStage() >= RoastGuide::STAGE_FINISH) return;
-  
-  RoastGuide::RoastStage prev_stage = ROAST_GUIDE->getCurrentStage();
-  
-  // 次の段階に強制移行
-  // TODO: Implement forceNextStage in RoastGuide module
-  // ROAST_GUIDE->forceNextStage();
-  
-  // Check if stage changed and play beep
-  if (prev_stage != ROAST_GUIDE->getCurrentStage()) {
+  // 次の段階に強制移行（イベントログ・ターゲット・フェーズ集計はガイド側で更新、記録は次のサンプルで）
+  uint32_t total = getSampleCount();
+  if (ROAST_GUIDE->forceNextStage(total > 0 ? total - 1 : 0, current_temp)) {
     playStageChangeBeep();
   }
 }
 
-void checkEmergencyConditions() {
-  // Configure safety thresholds
-  SAFETY->setDangerTemp(getDangerTemp(ROAST_GUIDE->getSelectedLevel()));
-  SAFETY->setCriticalTemp(getCriticalTemp(ROAST_GUIDE->getSelectedLevel()));
-  
-  // Set callbacks
-  static bool callbacks_set = false;
-  if (!callbacks_set) {
-    SAFETY->setBeepCallback(playBeep);
-    SAFETY->setEmergencyCallback([]() {
-      // Emergency stop - handled by RoastGuide
-      ROAST_GUIDE->stop();
-      M5.Lcd.fillScreen(TFT_RED);
-      M5.Lcd.setTextColor(TFT_WHITE, TFT_RED);
-      M5.Lcd.setFont(&fonts::lgfxJapanGothic_36);
-      M5.Lcd.setCursor(50, 100);
-      M5.Lcd.printf("EMERGENCY STOP!");
-    });
-    callbacks_set = true;
-  }
-  
-  // Check conditions
-  bool guide_active = ROAST_GUIDE->isActive();
-  SAFETY->checkEmergencyConditions(current_temp, current_ror, ROAST_GUIDE->getCurrentStage(), guide_active);
-  
+// 安全チェック自体は SampleProcessor：ここでは復旧ダイアログと危険温度の警告表示・警告音
+void showSafetyWarnings() {
   // Draw recovery dialog if active
   if (SAFETY->getState().recovery_dialog_active) {
     SAFETY->drawRecoveryDialog(current_temp, current_ror);
@@ -1815,27 +2000,15 @@ void checkEmergencyConditions() {
 }
 
 const char* getGasAdjustmentAdvice(RoastGuide::FirePower current_fire, RoastGuide::FirePower target_fire) {
-  if (current_fire == target_fire) return "火力維持";
-  
-  int diff = target_fire - current_fire;
-  switch(diff) {
-    case -2: case -3: return "すぐに弱火に！";
-    case -1: return "少し火を弱める";
-    case 1: return "少し火を強める";
-    case 2: case 3: return "すぐに火を強く！";
-    default: return "火力調整";
-  }
+  return FireAdvisor::adjustmentAdvice(current_fire, target_fire);
 }
 
-void updateFirePowerRecommendation() {
+// 推奨火力の算出は SampleProcessor：ここでは変更時と過熱時の音声通知
+void notifyFirePowerRecommendation(bool changed) {
   if (!ROAST_GUIDE->isActive()) return;
   
-  RoastGuide::FirePower new_fire = calculateRecommendedFire();
-  
   // 火力推奨が変わった場合の通知
-  if (new_fire != last_recommended_fire) {
-    last_recommended_fire = new_fire;
-    
+  if (changed) {
     // 火力変更の音声通知
     uint32_t now = millis();
     if ((now - last_beep_time) > 3000) {  // 3秒間隔制限
@@ -1845,7 +2018,7 @@ void updateFirePowerRecommendation() {
   }
   
   // 基本的な警告チェック
-  RoastGuide::RoastTarget target = ROAST_GUIDE->getRoastTarget(ROAST_GUIDE->getCurrentStage(), ROAST_GUIDE->getSelectedLevel());
+  const RoastGuide::RoastTarget& target = ROAST_GUIDE->getCurrentTarget();
   bool critical_temp = (current_temp > target.temp_max + 10) || 
                       (ROAST_GUIDE->getCurrentStage() == RoastGuide::STAGE_FINISH && current_temp > target.temp_max);
   
@@ -1861,27 +2034,93 @@ void updateFirePowerRecommendation() {
 
 /**
  * セオドア提言：BLE差分パケット送信最適化
- * 温度/RoRデータは1秒間隔、統計データは15秒間隔で送信し帯域節約
+ * 温度/RoRデータは変化時のみ（不感帯・最大5Hz・キープアライブ5秒）、統計データは15秒間隔で送信し帯域節約
  */
 void sendBLEData() {
+  // 1ハゼ〜2ハゼ付近は高速レートで送る
+  RoastGuide::RoastStage stage = ROAST_GUIDE->getCurrentStage();
+  BLE_MGR->setFastRateHint(ROAST_GUIDE->isActive() &&
+                           stage >= RoastGuide::STAGE_FIRST_CRACK &&
+                           stage <= RoastGuide::STAGE_SECOND_CRACK);
+  
   // モジュラーBLEManagerが自動的に処理
   BLE_MGR->update();
 }
 
+/**
+ * 取得タスク（core 0）から10Hzで呼ばれる：microSDのブロックバッファへ詰めるだけ
+ */
+void onRawReading(const SensorAcquisition::RawReading& reading) {
+  RawCaptureFormat::Record record;
+  record.index = reading.index;
+  record.time_ms = (uint32_t)(reading.timestamp_us / 1000);
+  record.temp_centi = reading.status == 0 ? reading.temp_centi : RawCaptureFormat::INVALID_TEMP;
+  record.status = reading.status;
+  record.flags = reading.sampled ? RawCaptureFormat::FLAG_SAMPLED : 0;
+  record.read_us = reading.read_us;
+  SD_CAPTURE->push(record);
+}
+
+/**
+ * 焙煎ジャーナル：監視開始・データクリアで新しい焙煎として記録を始める
+ */
+void startJournal() {
+  SAMPLE_PROCESSOR->resetJournal();  // ステージ・火力は次のサンプルで記録し直す
+  JOURNAL->startRoast();
+}
+
+
+/**
+ * 取得済みサンプル1件をデータ系（統計・RoR・安全・火力推奨）に反映
+ * 描画やBLE送信はキューを空にした後にまとめて行う
+ */
+void processSample(const SensorAcquisition::Sample& sample) {
+  current_temp = sample.temp;
+  sample_clock_ms = (uint32_t)(sample.timestamp_us / 1000);
+  PROFILE_TICK(sample.timestamp_us);
+  TRACE_MARK(MARK_SAMPLE, sample.index);
+
+  // ジャーナル・統計・履歴・RoR・1ハゼ検出・安全チェック・火力推奨・ステージ進行（ホストと共通）
+  SampleProcessor::Tick tick = SAMPLE_PROCESSOR->process(sample.index, current_temp, sample.timestamp_us);
+  current_ror = tick.ror;
+  current_ror_15s = tick.ror_15s;
+  decision_ror = tick.decision_ror;
+  if (tick.ror_ready && ror_count < TemperatureHistory::RAW_SIZE) ror_count++;
+
+  if (tick.crack_accepted) notifyFirstCrackAccepted();
+  showSafetyWarnings();
+  notifyFirePowerRecommendation(tick.fire_changed);
+
+  if (replay_state == REPLAY_PLAYING) {
+    REPLAY->compare(ROAST_GUIDE->getCurrentStage(), SAMPLE_PROCESSOR->getFire());
+  }
+}
+
 void loop() {
+  PROFILE_LOOP_START();
+  PROFILE_SCOPE(SEC_LOOP);
+
   M5.update();
-  handleButtons();
-  handleNonBlockingBeeps();
-  
-  // セオドア提言：完全非ブロッキング初期化リトライ
-  if (init_waiting && millis() - init_retry_timer >= 500) {
-    if (kmeter.begin(&Wire, KM_ADDR, KM_SDA, KM_SCL, I2C_FREQ)) {
-      M5_LOGI("KMeterISO initialization successful!");
-      init_waiting = false;
-    } else {
-      M5_LOGE("KMeterISO still not found…再試行");
-      init_retry_timer = millis(); // Reset timer for next retry
-    }
+  handleSerialCommands();
+  {
+    PROFILE_SCOPE(SEC_BUTTONS);
+    handleButtons();
+  }
+  {
+    PROFILE_SCOPE(SEC_BEEPS);
+    handleNonBlockingBeeps();
+  }
+  
+  {
+    PROFILE_SCOPE(SEC_BLE_POLL);
+    // BLE接続管理とリモートコマンド（待機中も受け付ける）
+    BLE_MGR->poll();
+    
+    // 履歴バックフィル：ライブ送信の合間に1チャンクずつ
+    BACKFILL->service();
+    
+    // プロファイル結果のBLE送信（要求時、1メッセージずつ）
+    serviceProfileDump();
   }
   
   // 非ブロッキング復旧成功表示処理
@@ -1891,55 +2130,52 @@ void loop() {
     need_full_redraw = true;
   }
 
-
   if (system_state == STATE_STANDBY) {
-    // In standby mode, just handle buttons
+    // In standby mode, just handle buttons（取得タスクのサンプルは破棄）
+    SENSOR_ACQ->discardPending();
     return;
   }
 
-  if (millis() >= next_tick) {
-    next_tick += PERIOD_MS;
-
-    km_err = kmeter.getReadyStatus();
-    if (km_err == 0) {
-      current_temp = kmeter.getCelsiusTempValue() / 100.0f;
-
-      // Update statistics
-      updateStats(current_temp);
-
-      setTempToBuffer(head, current_temp);
-      head = (head + 1) % BUF_SIZE;
-      if (count < BUF_SIZE) ++count;
-
-      // Calculate and update RoR (both 15s and 60s)
-      current_ror = calculateRoR();
-      current_ror_15s = calculateRoR15s();
-      updateRoRBuffer();
-      
-      // Check for stall condition
-      ROAST_GUIDE->checkStallCondition(current_temp, current_ror);
-      
-      // Add temperature to predictor
-      predictor.addTemperature(current_temp);
-      
-      // Check emergency conditions
-      checkEmergencyConditions();
-
-      // Update fire power recommendations and audio notifications
-      updateFirePowerRecommendation();
+  // 取得タスクのリングから溜まっているサンプルを全て消費
+  uint8_t processed = 0;
+  bool sensor_error = false;
+  {
+    PROFILE_SCOPE(SEC_SENSOR);
+    SensorAcquisition::Sample sample;
+    while (nextSample(sample)) {
+      km_err = sample.status;
+      if (km_err == 0) {
+        processSample(sample);
+        processed++;
+        sensor_error = false;
+      } else {
+        TRACE_MARK(MARK_SENSOR_ERROR, sample.status);
+        JOURNAL->addSample(sample.index, NAN, sample.status);
+        sensor_error = true;
+      }
+    }
+  }
 
-      // Send BLE data
-      sendBLEData();
-      
-      // Update ticker system information periodically
-      updateTickerSystemInfoWrapper();
+  if (processed > 0) {
+    // 複数サンプルをまとめて消費した場合、差分描画では線分が欠けるため全体再描画
+    if (processed > 1 && display_mode == MODE_GRAPH) {
+      need_full_redraw = true;
+    }
+    
+    // Update ticker system information periodically
+    updateTickerSystemInfoWrapper();
 
+    {
+      PROFILE_SCOPE(SEC_CURRENT_VALUE);
       drawCurrentValue();
-      
+    }
+    
+    {
+      PROFILE_SCOPE(SEC_MODE_DRAW);
       if (display_mode == MODE_GRAPH) {
         if (need_full_redraw) {
+          TRACE_MARK(MARK_FULL_REDRAW, processed);
           drawGraph();
-          need_full_redraw = false;
         } else {
           addNewGraphPoint();
         }
@@ -1949,21 +2185,45 @@ void loop() {
         drawRoR();
       } else if (display_mode == MODE_GUIDE) {
         if (ROAST_GUIDE->isActive()) {
-          ROAST_GUIDE->update(current_temp, current_ror);
           drawGuide();
         } else {
           drawRoastLevelSelection();
         }
       }
-    } else {
-      M5.Lcd.fillRect(0, 30, 320, 30, TFT_BLACK);
-      M5.Lcd.setCursor(0, 30);
-      M5.Lcd.printf("KMeter Err: %d", km_err);
     }
+    // 全モード共通：描画し終えたら差分描画に戻る
+    need_full_redraw = false;
+  }
+
+  if (replay_state == REPLAY_PLAYING && !REPLAY->isActive()) {
+    replay_state = REPLAY_DONE;
+    reportReplay();
+  }
+
+  // BLE送信：サンプル到着に関係なく毎回呼び、送信タイミングはBLEManagerが判定
+  {
+    PROFILE_SCOPE(SEC_BLE_SEND);
+    sendBLEData();
+  }
+
+  // ジャーナル：埋まったページがあればフラッシュへ（描画・送信の後）
+  {
+    PROFILE_SCOPE(SEC_JOURNAL);
+    JOURNAL->service();
+  }
+
+  if (sensor_error) {
+    M5.Lcd.fillRect(0, 30, 320, 30, TFT_BLACK);
+    M5.Lcd.setCursor(0, 30);
+    M5.Lcd.printf("KMeter Err: %d", km_err);
+    need_full_redraw = true;  // エラー表示がヘッダーとグラフに重なるため復帰時に全体再描画
   }
   
   // Update ticker footer every loop iteration for smooth scrolling
-  updateTickerFooterWrapper();
+  {
+    PROFILE_SCOPE(SEC_TICKER);
+    updateTickerFooterWrapper();
+  }
 }
 
 void handleNonBlockingBeeps() {
@@ -2035,12 +2295,9 @@ float getNextStageKeyTemp(RoastGuide::RoastStage stage, RoastGuide::RoastLevel l
  * フッター領域の統一描画（画面下部のボタン指示）
  */
 void drawFooter(const char* instructions) {
+  // 文字列が変わった時のみ描き直す
   int footer_y = 240 - FOOTER_HEIGHT;
-  M5.Lcd.fillRect(0, footer_y, 320, FOOTER_HEIGHT, TFT_BLACK);
-  M5.Lcd.setFont(&fonts::lgfxJapanGothic_12);
-  M5.Lcd.setTextColor(TFT_WHITE);
-  M5.Lcd.setCursor(5, footer_y + 4);
-  M5.Lcd.printf("%s", instructions);
+  footer_text.printf(5, footer_y + 4, TFT_WHITE, "%s", instructions);
 }
 
 /**
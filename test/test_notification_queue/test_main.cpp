@@ -0,0 +1,160 @@
+// NotificationQueue：分割・コアレス・破棄・バルク予約枠・輻輳時の保留
+#include <unity.h>
+#include "../../src/BLE/NotificationQueue.h"
+#include "../../src/HAL/native/CaptureTransport.h"
+
+namespace {
+
+NotificationQueue queue;
+hal::CaptureTransport transport;
+
+void fill(uint8_t* buf, size_t len, uint8_t seed) {
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(seed + i);
+}
+
+}  // namespace
+
+void setUp() {
+    queue = NotificationQueue();
+    transport.clear();
+    transport.setCongested(false);
+}
+
+void tearDown() {}
+
+void test_splits_message_at_max_payload() {
+    uint8_t data[50];
+    fill(data, sizeof(data), 1);
+    TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_FULL));
+    TEST_ASSERT_EQUAL(3, queue.size());
+
+    TEST_ASSERT_EQUAL(3, queue.drainTo(transport, 8));
+    const auto& frames = transport.getFrames();
+    TEST_ASSERT_EQUAL(20, frames[0].size());
+    TEST_ASSERT_EQUAL(20, frames[1].size());
+    TEST_ASSERT_EQUAL(10, frames[2].size());
+    TEST_ASSERT_EQUAL_MEMORY(data + 40, frames[2].data(), 10);
+    TEST_ASSERT_EQUAL(3, queue.getSentCount());
+}
+
+void test_lite_frames_coalesce_to_latest() {
+    uint8_t first[20], second[20];
+    fill(first, sizeof(first), 0x10);
+    fill(second, sizeof(second), 0x80);
+    TEST_ASSERT_TRUE(queue.push(first, sizeof(first), 20, NotificationQueue::KIND_LITE));
+    TEST_ASSERT_TRUE(queue.push(second, sizeof(second), 20, NotificationQueue::KIND_LITE));
+    TEST_ASSERT_EQUAL(1, queue.size());
+    TEST_ASSERT_EQUAL(1, queue.getCoalescedCount());
+    TEST_ASSERT_EQUAL_MEMORY(second, queue.peek()->data, sizeof(second));
+}
+
+void test_multi_chunk_lite_is_not_coalesced() {
+    uint8_t data[30];
+    fill(data, sizeof(data), 0);
+    TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_LITE));
+    TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_LITE));
+    TEST_ASSERT_EQUAL(4, queue.size());
+    TEST_ASSERT_EQUAL(0, queue.getCoalescedCount());
+}
+
+void test_full_queue_drops_lite_and_evicts_it_for_events() {
+    uint8_t data[20];
+    fill(data, sizeof(data), 0);
+    TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_LITE));
+    for (size_t i = 1; i < NotificationQueue::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_EVENT));
+    }
+    TEST_ASSERT_EQUAL(0, queue.available());
+
+    // 満杯：フル・イベントは未送信のライトデータを追い出して積む
+    TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_FULL));
+    TEST_ASSERT_EQUAL(1, queue.getDroppedCount());
+    TEST_ASSERT_EQUAL(NotificationQueue::KIND_EVENT, queue.peek()->kind);
+
+    // 追い出せるライトがなければ積まずに false
+    TEST_ASSERT_FALSE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_EVENT));
+    TEST_ASSERT_FALSE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_LITE));
+    TEST_ASSERT_EQUAL(3, queue.getDroppedCount());
+    TEST_ASSERT_EQUAL(NotificationQueue::CAPACITY, queue.size());
+}
+
+void test_bulk_keeps_reserve_free() {
+    uint8_t data[20];
+    fill(data, sizeof(data), 0);
+    size_t accepted = 0;
+    while (queue.push(data, sizeof(data), 20, NotificationQueue::KIND_BULK)) accepted++;
+    TEST_ASSERT_EQUAL(NotificationQueue::CAPACITY - NotificationQueue::BULK_RESERVE, accepted);
+    TEST_ASSERT_EQUAL(0, queue.getDroppedCount());  // 呼び出し側が再試行するため破棄ではない
+
+    // 予約枠はイベント用に残る
+    TEST_ASSERT_TRUE(queue.push(data, sizeof(data), 20, NotificationQueue::KIND_EVENT));
+}
+
+// 既定MTU（23）ではフレームごとに1通知：BLEManager は状態フレームとフェーズフレームを
+// 別々のフル・データとして積む。後続のライブフレームと満杯の圧力で失われないこと
+void test_status_and_phase_survive_pressure_at_default_mtu() {
+    const size_t max_payload = TelemetryProtocol::FRAME_SIZE;   // MTU 23 - ATTヘッダー3
+    TelemetryProtocol::Snapshot snap = {};
+    snap.temp = 180.0f;
+    snap.phase = PhaseMetrics::PHASE_MAILLARD;
+    uint8_t live[TelemetryProtocol::FRAME_SIZE];
+    uint8_t status[TelemetryProtocol::FRAME_SIZE];
+    uint8_t phase[TelemetryProtocol::FRAME_SIZE];
+
+    TEST_ASSERT_TRUE(queue.push(live, TelemetryProtocol::encodeLive(snap, 0, live), max_payload,
+                                NotificationQueue::KIND_LITE));
+    TEST_ASSERT_TRUE(queue.push(status, TelemetryProtocol::encodeStatus(snap, 1, status), max_payload,
+                                NotificationQueue::KIND_FULL));
+    TEST_ASSERT_TRUE(queue.push(phase, TelemetryProtocol::encodePhase(snap, 2, phase), max_payload,
+                                NotificationQueue::KIND_FULL));
+
+    // 輻輳中に後続のライブフレームとイベントで満杯にする
+    transport.setCongested(true);
+    for (uint8_t seq = 3; seq < 3 + 2 * NotificationQueue::CAPACITY; seq++) {
+        snap.sample_index = seq;
+        queue.push(live, TelemetryProtocol::encodeLive(snap, seq, live), max_payload,
+                   seq % 2 ? NotificationQueue::KIND_LITE : NotificationQueue::KIND_EVENT);
+    }
+    TEST_ASSERT_EQUAL(0, queue.available());
+    TEST_ASSERT_TRUE(queue.getDroppedCount() > 0);
+
+    transport.setCongested(false);
+    queue.drainTo(transport, NotificationQueue::CAPACITY);
+    bool status_sent = false, phase_sent = false;
+    for (const auto& frame : transport.getFrames()) {
+        TEST_ASSERT_TRUE(TelemetryProtocol::verify(frame.data(), frame.size()));
+        status_sent |= memcmp(frame.data(), status, sizeof(status)) == 0;
+        phase_sent |= memcmp(frame.data(), phase, sizeof(phase)) == 0;
+    }
+    TEST_ASSERT_TRUE(status_sent);
+    TEST_ASSERT_TRUE(phase_sent);
+}
+
+void test_congestion_holds_frames() {
+    uint8_t data[20];
+    fill(data, sizeof(data), 0);
+    queue.push(data, sizeof(data), 20, NotificationQueue::KIND_EVENT);
+    queue.push(data, sizeof(data), 20, NotificationQueue::KIND_FULL);
+
+    transport.setCongested(true);
+    TEST_ASSERT_EQUAL(0, queue.drainTo(transport, 4));
+    TEST_ASSERT_EQUAL(2, queue.size());
+
+    transport.setCongested(false);
+    TEST_ASSERT_EQUAL(1, queue.drainTo(transport, 1));  // 1回あたりの上限
+    TEST_ASSERT_EQUAL(1, queue.drainTo(transport, 4));
+    TEST_ASSERT_EQUAL(0, queue.size());
+    TEST_ASSERT_EQUAL(2, transport.getFrames().size());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_splits_message_at_max_payload);
+    RUN_TEST(test_lite_frames_coalesce_to_latest);
+    RUN_TEST(test_multi_chunk_lite_is_not_coalesced);
+    RUN_TEST(test_full_queue_drops_lite_and_evicts_it_for_events);
+    RUN_TEST(test_bulk_keeps_reserve_free);
+    RUN_TEST(test_status_and_phase_survive_pressure_at_default_mtu);
+    RUN_TEST(test_congestion_holds_frames);
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+// PhaseMetrics：フェーズの区切り・飛ばしたフェーズ・DTR・AUC・転換点
+#include <unity.h>
+#include "../../src/RoastGuide/PhaseMetrics.h"
+#include "../../src/RoastGuide/RoastGuide.h"
+
+namespace {
+
+PhaseMetrics phases;
+
+// from_ms から to_ms まで1秒ごとに一定温度のサンプル
+void feed(uint32_t from_ms, uint32_t to_ms, float temp) {
+    for (uint32_t ms = from_ms; ms <= to_ms; ms += 1000) phases.update(ms, temp);
+}
+
+}  // namespace
+
+void setUp() {
+    phases.reset();
+}
+
+void tearDown() {}
+
+void test_ignores_samples_and_stages_before_charge() {
+    phases.onStage(RoastGuide::STAGE_MAILLARD, 10000);
+    feed(0, 30000, 180.0f);
+    TEST_ASSERT_FALSE(phases.isCharged());
+    TEST_ASSERT_EQUAL(PhaseMetrics::NO_PHASE, phases.getPhase());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, phases.getTotalSeconds());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, phases.getDTR());
+}
+
+void test_full_roast_phases_and_dtr() {
+    phases.onStage(RoastGuide::STAGE_CHARGE, 60000);
+    feed(60000, 300000, 150.0f);
+    phases.onStage(RoastGuide::STAGE_MAILLARD, 300000);
+    feed(300000, 540000, 180.0f);
+    phases.onStage(RoastGuide::STAGE_FIRST_CRACK, 540000);
+    phases.onStage(RoastGuide::STAGE_DEVELOPMENT, 600000);  // 発達フェーズのまま
+    feed(540000, 660000, 200.0f);
+    phases.onStage(RoastGuide::STAGE_FINISH, 660000);
+
+    TEST_ASSERT_TRUE(phases.isDropped());
+    TEST_ASSERT_EQUAL_FLOAT(240.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DRYING));
+    TEST_ASSERT_EQUAL_FLOAT(240.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_MAILLARD));
+    TEST_ASSERT_EQUAL_FLOAT(120.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DEVELOPMENT));
+    TEST_ASSERT_EQUAL_FLOAT(600.0f, phases.getTotalSeconds());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, phases.getDTR());
+
+    // AUC：100°C基準の温度差 × 分（フェーズ境界をまたぐ区間は新しいフェーズへ）
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f * 4.0f, phases.getAUC(PhaseMetrics::PHASE_DRYING));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 80.0f * 4.0f, phases.getAUC(PhaseMetrics::PHASE_MAILLARD));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 100.0f * 2.0f, phases.getAUC(PhaseMetrics::PHASE_DEVELOPMENT));
+
+    // 排出後は伸びない
+    feed(661000, 700000, 210.0f);
+    TEST_ASSERT_EQUAL_FLOAT(600.0f, phases.getTotalSeconds());
+}
+
+void test_skipped_maillard_stays_zero() {
+    phases.onStage(RoastGuide::STAGE_CHARGE, 0);
+    feed(0, 300000, 150.0f);
+    // 乾燥から直接1ハゼ（メイラードを飛ばした）
+    phases.onStage(RoastGuide::STAGE_FIRST_CRACK, 300000);
+    feed(300000, 400000, 200.0f);
+    phases.onStage(RoastGuide::STAGE_FINISH, 400000);
+
+    TEST_ASSERT_EQUAL_FLOAT(300.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DRYING));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_MAILLARD));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, phases.getAUC(PhaseMetrics::PHASE_MAILLARD));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DEVELOPMENT));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.0f, phases.getDTR());
+
+    // 戻る方向のステージ移行は無視
+    phases.reset();
+    phases.onStage(RoastGuide::STAGE_CHARGE, 0);
+    phases.onStage(RoastGuide::STAGE_FIRST_CRACK, 1000);
+    phases.onStage(RoastGuide::STAGE_MAILLARD, 2000);
+    TEST_ASSERT_EQUAL(PhaseMetrics::PHASE_DEVELOPMENT, phases.getPhase());
+}
+
+void test_drop_without_first_crack() {
+    phases.onStage(RoastGuide::STAGE_CHARGE, 0);
+    feed(0, 200000, 150.0f);
+    phases.onStage(RoastGuide::STAGE_FINISH, 200000);
+
+    TEST_ASSERT_EQUAL_FLOAT(200.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DRYING));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DEVELOPMENT));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, phases.getDTR());
+}
+
+void test_sensor_gap_and_turning_point() {
+    phases.onStage(RoastGuide::STAGE_CHARGE, 0);
+    TEST_ASSERT_TRUE(phases.getSinceTurningPoint() < 0.0f);
+    feed(0, 60000, 120.0f);
+    phases.onTurningPoint(60000);
+    phases.onTurningPoint(90000);   // 2回目は無視
+    phases.update(61000, NAN);      // センサーエラーは区間を伸ばさない
+    feed(120000, 180000, 120.0f);
+
+    TEST_ASSERT_EQUAL_FLOAT(120.0f, phases.getSinceTurningPoint());
+    TEST_ASSERT_EQUAL_FLOAT(180.0f, phases.getPhaseSeconds(PhaseMetrics::PHASE_DRYING));
+    // 欠けた区間も前後のサンプルで台形補間
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f * 3.0f, phases.getAUC(PhaseMetrics::PHASE_DRYING));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ignores_samples_and_stages_before_charge);
+    RUN_TEST(test_full_roast_phases_and_dtr);
+    RUN_TEST(test_skipped_maillard_stays_zero);
+    RUN_TEST(test_drop_without_first_crack);
+    RUN_TEST(test_sensor_gap_and_turning_point);
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+// RoastJournal：電源断（途中で切れたページ）からの復旧と、壊れたページでの読み出し停止
+#include <unity.h>
+#include "../../src/Storage/RoastJournal.h"
+#include "../../src/RoastGuide/RoastGuide.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t PERIOD_MS = 1000;
+char root[64];
+
+// 記録中の焙煎：samples 件のサンプルを追記し、埋まったページを書く
+void record(RoastJournal& journal, uint32_t samples) {
+    for (uint32_t i = 0; i < samples; i++) {
+        journal.addSample(i, 150.0f + i * 0.1f, 0);
+        journal.service();
+    }
+}
+
+long fileSize(uint32_t roast_id) {
+    char path[64];
+    RoastJournal::makeRoastPath(path, sizeof(path), roast_id);
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+uint32_t countRecords(uint32_t roast_id, uint32_t* last_index) {
+    RoastJournal::Reader reader;
+    if (!reader.open(roast_id)) return 0;
+    RoastJournal::Record r;
+    uint32_t n = 0;
+    while (reader.next(r)) {
+        if (last_index) *last_index = r.sample_index;
+        n++;
+    }
+    return n;
+}
+
+}  // namespace
+
+void setUp() {
+    strcpy(root, "/tmp/journal_test_XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+    hal::setStorageRoot(root);
+}
+
+void tearDown() {
+    char cmd[96];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", root);
+    system(cmd);
+}
+
+void test_finished_roast_reads_back() {
+    RoastJournal journal;
+    TEST_ASSERT_TRUE(journal.begin(PERIOD_MS));
+    TEST_ASSERT_TRUE(journal.startRoast());
+    uint32_t id = journal.getCurrentId();
+    record(journal, 40);
+    TEST_ASSERT_TRUE(journal.finishRoast());
+
+    const RoastJournal::Entry* entry = journal.findRoast(id);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(RoastJournal::ENTRY_CLOSED, entry->state);
+    TEST_ASSERT_EQUAL(40, entry->samples);
+    // ヘッダー + 満杯1ページ + 最終ページ
+    TEST_ASSERT_EQUAL(3 * RoastJournal::PAGE_SIZE, fileSize(id));
+    uint32_t last = 0;
+    TEST_ASSERT_EQUAL(40, countRecords(id, &last));
+    TEST_ASSERT_EQUAL(39, last);
+}
+
+void test_recovers_after_truncated_page() {
+    uint32_t id;
+    {
+        RoastJournal journal;
+        TEST_ASSERT_TRUE(journal.begin(PERIOD_MS));
+        TEST_ASSERT_TRUE(journal.startRoast());
+        id = journal.getCurrentId();
+        // データ3ページを書き、4ページ目をバッファに溜めたまま電源断（finishRoast なし）
+        record(journal, 3 * RoastJournal::RECORDS_PER_PAGE + 5);
+        TEST_ASSERT_EQUAL(3, journal.getPagesWritten());
+        journal.addEvent(RoastJournal::REC_FIRST_CRACK, 0);    // 書かれずに失われる
+    }
+    // 3ページ目のデータの書き込み途中で切れた（ヘッダー + 2ページ + 端数）
+    char path[64];
+    RoastJournal::makeRoastPath(path, sizeof(path), id);
+    TEST_ASSERT_EQUAL(0, truncate(path, 3 * RoastJournal::PAGE_SIZE + 100));
+
+    // 再起動：記録中のまま残ったエントリをファイルから集計し直す
+    RoastJournal rebooted;
+    TEST_ASSERT_TRUE(rebooted.begin(PERIOD_MS));
+    const RoastJournal::Entry* entry = rebooted.findRoast(id);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(RoastJournal::ENTRY_RECOVERED, entry->state);
+    TEST_ASSERT_EQUAL(2 * RoastJournal::RECORDS_PER_PAGE, entry->samples);
+    TEST_ASSERT_EQUAL(RoastJournal::NO_FIRST_CRACK, entry->first_crack_s);
+    TEST_ASSERT_EQUAL(1561, entry->drop_temp_deci);   // 完全に残った最後のサンプル（61番）
+
+    uint32_t last = 0;
+    TEST_ASSERT_EQUAL(2 * RoastJournal::RECORDS_PER_PAGE, countRecords(id, &last));
+    TEST_ASSERT_EQUAL(2 * RoastJournal::RECORDS_PER_PAGE - 1, last);
+
+    // 次の焙煎は別のIDで記録できる
+    TEST_ASSERT_TRUE(rebooted.startRoast());
+    TEST_ASSERT_TRUE(rebooted.getCurrentId() > id);
+    TEST_ASSERT_TRUE(rebooted.finishRoast());
+}
+
+void test_first_crack_uses_event_sample_index() {
+    RoastJournal journal;
+    TEST_ASSERT_TRUE(journal.begin(PERIOD_MS));
+    TEST_ASSERT_TRUE(journal.startRoast());
+    uint32_t id = journal.getCurrentId();
+    record(journal, 600);
+    // 500番で検出、599番で受け付けた自動検出：検出位置を1ハゼ時刻とする
+    journal.addEvent(RoastJournal::REC_FIRST_CRACK, 80, 500);
+    journal.addEvent(RoastJournal::REC_STAGE, RoastGuide::STAGE_FIRST_CRACK);
+    TEST_ASSERT_TRUE(journal.finishRoast());
+
+    const RoastJournal::Entry* entry = journal.findRoast(id);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(500, entry->first_crack_s);
+}
+
+void test_reader_stops_at_corrupted_page() {
+    RoastJournal journal;
+    TEST_ASSERT_TRUE(journal.begin(PERIOD_MS));
+    TEST_ASSERT_TRUE(journal.startRoast());
+    uint32_t id = journal.getCurrentId();
+    record(journal, 3 * RoastJournal::RECORDS_PER_PAGE);
+    TEST_ASSERT_TRUE(journal.finishRoast());
+
+    // 2ページ目（ファイル先頭からヘッダーの次の次）の1バイトを壊す
+    char path[64];
+    RoastJournal::makeRoastPath(path, sizeof(path), id);
+    FILE* f = fopen(path, "r+b");
+    TEST_ASSERT_NOT_NULL(f);
+    fseek(f, 2 * RoastJournal::PAGE_SIZE + 10, SEEK_SET);
+    int c = fgetc(f);
+    fseek(f, 2 * RoastJournal::PAGE_SIZE + 10, SEEK_SET);
+    fputc(c ^ 0xFF, f);
+    fclose(f);
+
+    TEST_ASSERT_EQUAL(RoastJournal::RECORDS_PER_PAGE, countRecords(id, nullptr));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_finished_roast_reads_back);
+    RUN_TEST(test_recovers_after_truncated_page);
+    RUN_TEST(test_first_crack_uses_event_sample_index);
+    RUN_TEST(test_reader_stops_at_corrupted_page);
+    return UNITY_END();
+}
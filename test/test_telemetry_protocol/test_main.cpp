@@ -0,0 +1,216 @@
+// TelemetryProtocol：エンコード → デコードの往復、CRC不一致・種別違いの拒否、バックフィルの差分符号化
+#include <unity.h>
+#include "../../src/BLE/TelemetryProtocol.h"
+#include <math.h>
+
+namespace {
+
+TelemetryProtocol::Snapshot snapshot() {
+    TelemetryProtocol::Snapshot snap = {};
+    snap.sample_index = 123456;
+    snap.timestamp_ms = 987654321;
+    snap.temp = 196.37f;
+    snap.ror = -3.21f;
+    snap.ror_smooth = 8.5f;
+    snap.temp_min = 88.8f;
+    snap.temp_max = 201.02f;
+    snap.temp_avg = 160.5f;
+    snap.elapsed_s = 70000;     // uint16 に飽和
+    snap.missed = 7;
+    snap.flags = TelemetryProtocol::FLAG_RUNNING | TelemetryProtocol::FLAG_GUIDE_ACTIVE;
+    snap.stage = 4;
+    snap.fire = 2;
+    snap.level = 3;
+    snap.smoothing = 5;
+    snap.phase = PhaseMetrics::PHASE_DEVELOPMENT;
+    snap.phase_s[0] = 241.4f;
+    snap.phase_s[1] = 180.6f;
+    snap.phase_s[2] = 65.0f;
+    snap.since_tp_s = 400.2f;
+    snap.auc[0] = 120.0f;
+    snap.auc[1] = 250.4f;
+    snap.auc[2] = 99.5f;
+    return snap;
+}
+
+// ヘッダー + 先頭値 + 差分の varint + CRC（HistoryBackfill と同じ並び）
+size_t buildBackfill(const int16_t* values, uint8_t count, uint8_t* out) {
+    TelemetryProtocol::BackfillHeader header;
+    header.header = { TelemetryProtocol::VERSION, TelemetryProtocol::FRAME_BACKFILL, 0, 9 };
+    header.first_index = 300;
+    header.span = 5;
+    header.count = count;
+    header.first_value = count ? values[0] : 0;
+    memcpy(out, &header, sizeof(header));
+    size_t len = sizeof(header);
+    for (uint8_t i = 1; i < count; i++) {
+        len += TelemetryProtocol::putVarint((int32_t)values[i] - values[i - 1], out + len,
+                                            TelemetryProtocol::MAX_FRAME_SIZE - 2 - len);
+    }
+    return TelemetryProtocol::appendCrc(out, len);
+}
+
+}  // namespace
+
+void setUp() {}
+void tearDown() {}
+
+void test_live_round_trip() {
+    TelemetryProtocol::Snapshot snap = snapshot();
+    uint8_t frame[TelemetryProtocol::FRAME_SIZE];
+    size_t len = TelemetryProtocol::encodeLive(snap, 42, frame);
+
+    TelemetryProtocol::LiveFrame live;
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodeLive(frame, len, live));
+    TEST_ASSERT_EQUAL(TelemetryProtocol::VERSION, live.header.version);
+    TEST_ASSERT_EQUAL(snap.flags, live.header.flags);
+    TEST_ASSERT_EQUAL(42, live.header.seq);
+    TEST_ASSERT_EQUAL(snap.sample_index, live.sample_index);
+    TEST_ASSERT_EQUAL(snap.timestamp_ms, live.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, snap.temp, TelemetryProtocol::fromCenti(live.temp_centi));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, snap.ror, TelemetryProtocol::fromCenti(live.ror_centi));
+    TEST_ASSERT_EQUAL(snap.stage, live.stage);
+    TEST_ASSERT_EQUAL(snap.fire, live.fire);
+}
+
+void test_status_phase_and_ack_round_trip() {
+    TelemetryProtocol::Snapshot snap = snapshot();
+    uint8_t frame[TelemetryProtocol::FRAME_SIZE];
+
+    TelemetryProtocol::StatusFrame status;
+    size_t len = TelemetryProtocol::encodeStatus(snap, 1, frame);
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodeStatus(frame, len, status));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, snap.temp_max, TelemetryProtocol::fromCenti(status.max_centi));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, snap.temp_avg, TelemetryProtocol::fromCenti(status.avg_centi));
+    TEST_ASSERT_EQUAL(UINT16_MAX, status.elapsed_s);
+    TEST_ASSERT_EQUAL(snap.missed, status.missed);
+    TEST_ASSERT_EQUAL(snap.smoothing, status.smoothing);
+
+    TelemetryProtocol::PhaseFrame phase;
+    len = TelemetryProtocol::encodePhase(snap, 2, frame);
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodePhase(frame, len, phase));
+    TEST_ASSERT_EQUAL(241, phase.phase_s[0]);
+    TEST_ASSERT_EQUAL(181, phase.phase_s[1]);
+    TEST_ASSERT_EQUAL(400, phase.since_tp_s);
+    TEST_ASSERT_EQUAL(250, phase.auc[1]);
+
+    TelemetryProtocol::AckFrame ack;
+    len = TelemetryProtocol::encodeAck(0x18, 77, TelemetryProtocol::ACK_REJECTED, snap, 3, frame);
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodeAck(frame, len, ack));
+    TEST_ASSERT_EQUAL(0x18, ack.opcode);
+    TEST_ASSERT_EQUAL(77, ack.command_seq);
+    TEST_ASSERT_EQUAL(TelemetryProtocol::ACK_REJECTED, ack.status);
+    TEST_ASSERT_EQUAL(snap.sample_index, ack.sample_index);
+}
+
+void test_invalid_values_survive_round_trip() {
+    TelemetryProtocol::Snapshot snap = snapshot();
+    snap.temp = NAN;
+    snap.ror = 1000.0f;     // 0.01°C/min で int16 を超える
+    uint8_t frame[TelemetryProtocol::FRAME_SIZE];
+    TelemetryProtocol::LiveFrame live;
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodeLive(frame, TelemetryProtocol::encodeLive(snap, 0, frame), live));
+    TEST_ASSERT_TRUE(isnan(TelemetryProtocol::fromCenti(live.temp_centi)));
+    TEST_ASSERT_EQUAL(INT16_MAX, live.ror_centi);
+}
+
+void test_rejects_crc_mismatch_and_wrong_type() {
+    TelemetryProtocol::Snapshot snap = snapshot();
+    uint8_t frame[TelemetryProtocol::FRAME_SIZE];
+    size_t len = TelemetryProtocol::encodeLive(snap, 5, frame);
+    TelemetryProtocol::LiveFrame live = {};
+    TelemetryProtocol::StatusFrame status;
+
+    // 種別違い・長さ違い
+    TEST_ASSERT_TRUE(TelemetryProtocol::verify(frame, len));
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeStatus(frame, len, status));
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeLive(frame, len - 1, live));
+
+    // 本体の1ビット反転
+    frame[8] ^= 0x01;
+    TEST_ASSERT_FALSE(TelemetryProtocol::verify(frame, len));
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeLive(frame, len, live));
+    TEST_ASSERT_EQUAL(0, live.sample_index);     // 失敗時は書き換えない
+    frame[8] ^= 0x01;
+
+    // CRC自体の破損
+    frame[len - 1] ^= 0x80;
+    TEST_ASSERT_FALSE(TelemetryProtocol::verify(frame, len));
+    frame[len - 1] ^= 0x80;
+
+    // 未知のバージョン（CRCは合わせ直す）
+    frame[0] = TelemetryProtocol::VERSION + 1;
+    TelemetryProtocol::appendCrc(frame, len - 2);
+    TEST_ASSERT_FALSE(TelemetryProtocol::verify(frame, len));
+}
+
+void test_varint_round_trip() {
+    const int32_t samples[] = { 0, 1, -1, 63, -64, 64, -65, 8191, -8192, INT16_MAX, INT16_MIN, INT32_MAX, INT32_MIN };
+    uint8_t buf[8];
+    for (int32_t v : samples) {
+        size_t n = TelemetryProtocol::putVarint(v, buf, sizeof(buf));
+        TEST_ASSERT_TRUE(n > 0);
+        int32_t decoded = 0;
+        TEST_ASSERT_EQUAL(n, TelemetryProtocol::getVarint(buf, n, &decoded));
+        TEST_ASSERT_EQUAL(v, decoded);
+        // 途中で切れた varint は読まない
+        TEST_ASSERT_EQUAL(0, TelemetryProtocol::getVarint(buf, n - 1, &decoded));
+    }
+    // 小さな差分は1バイト
+    TEST_ASSERT_EQUAL(1, TelemetryProtocol::putVarint(-64, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(2, TelemetryProtocol::putVarint(64, buf, sizeof(buf)));
+}
+
+void test_backfill_round_trip() {
+    const int16_t values[] = { 1502, 1510, 1509, 1531, 1700, 1450, 1450, 1451 };
+    const uint8_t count = sizeof(values) / sizeof(values[0]);
+    uint8_t frame[TelemetryProtocol::MAX_FRAME_SIZE];
+    size_t len = buildBackfill(values, count, frame);
+
+    TelemetryProtocol::BackfillHeader header;
+    int16_t decoded[16];
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodeBackfill(frame, len, header, decoded, 16));
+    TEST_ASSERT_EQUAL(300, header.first_index);
+    TEST_ASSERT_EQUAL(5, header.span);
+    TEST_ASSERT_EQUAL(count, header.count);
+    TEST_ASSERT_EQUAL_MEMORY(values, decoded, sizeof(values));
+
+    // 容量不足・CRC不一致
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeBackfill(frame, len, header, decoded, count - 1));
+    frame[sizeof(TelemetryProtocol::BackfillHeader) + 1] ^= 0x04;
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeBackfill(frame, len, header, decoded, 16));
+
+    // 終端チャンク（count = 0）
+    len = buildBackfill(values, 0, frame);
+    TEST_ASSERT_TRUE(TelemetryProtocol::decodeBackfill(frame, len, header, decoded, 16));
+    TEST_ASSERT_EQUAL(0, header.count);
+}
+
+void test_backfill_rejects_count_mismatch() {
+    const int16_t values[] = { 1500, 1501, 1502 };
+    uint8_t frame[TelemetryProtocol::MAX_FRAME_SIZE];
+    TelemetryProtocol::BackfillHeader header;
+    int16_t decoded[8];
+
+    // count が差分の数より多い／少ない（CRCは正しい）
+    size_t len = buildBackfill(values, 3, frame);
+    frame[offsetof(TelemetryProtocol::BackfillHeader, count)] = 4;
+    TelemetryProtocol::appendCrc(frame, len - 2);
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeBackfill(frame, len, header, decoded, 8));
+
+    frame[offsetof(TelemetryProtocol::BackfillHeader, count)] = 2;
+    TelemetryProtocol::appendCrc(frame, len - 2);
+    TEST_ASSERT_FALSE(TelemetryProtocol::decodeBackfill(frame, len, header, decoded, 8));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_live_round_trip);
+    RUN_TEST(test_status_phase_and_ack_round_trip);
+    RUN_TEST(test_invalid_values_survive_round_trip);
+    RUN_TEST(test_rejects_crc_mismatch_and_wrong_type);
+    RUN_TEST(test_varint_round_trip);
+    RUN_TEST(test_backfill_round_trip);
+    RUN_TEST(test_backfill_rejects_count_mismatch);
+    return UNITY_END();
+}